@@ -1,5 +1,19 @@
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define DOBFS_ALPHA 15 ///< Переход к bottom-up, когда рёбер фронта больше, чем непросмотренных рёбер / ALPHA
+#define DOBFS_BETA 18  ///< Возврат к top-down, когда фронт меньше num_nodes / BETA и сокращается
+#define PARALLEL_CHUNK 256        ///< Вершин, которые поток берёт из общей очереди за раз
+#define PARALLEL_LOCAL_QUEUE 4096 ///< Размер локальной очереди потока параллельного BFS
+#define AFFOREST_ROUNDS 2         ///< Сколько первых соседей каждой вершины связать до выборки
+#define AFFOREST_SAMPLES 1024     ///< Размер выборки для поиска самой большой компоненты
+#define GRAPH_HUB_DEGREE 16       ///< Степень, начиная с которой вершина получает хеш-множество соседей
+#define NEIGHBOR_SET_MIN 32       ///< Начальная ёмкость хеш-множества соседей
 
 /** @enum GraphError
  *  @brief Ошибки при работе с графом.
@@ -20,10 +34,15 @@ typedef enum {
  *  
  *  @var Graph::adj_list
  *  Массив указателей на список смежности для каждой вершины.
+ *
+ *  @var Graph::hubs
+ *  Хеш-множества соседей вершин со степенью от GRAPH_HUB_DEGREE, NULL у остальных вершин.
+ *  Список смежности хаба остаётся основным, множество лишь находит в нём узел за O(1).
  */
 typedef struct Graph {
-    int num_nodes;          /**< Количество вершин в графе */
-    struct Node** adj_list; /**< Массив указателей на список смежности */
+    int num_nodes;             /**< Количество вершин в графе */
+    struct Node** adj_list;    /**< Массив указателей на список смежности */
+    struct NeighborSet** hubs; /**< Хеш-множества соседей вершин-хабов */
 } Graph;
 
 /** @struct Node
@@ -40,8 +59,142 @@ typedef struct Node {
     struct Node* next;  /**< Указатель на следующий узел */
 } Node;
 
-static void dfs_helper(Graph* graph, int start, int* visited);
+/** @struct NeighborSlot
+ *  @brief Ячейка хеш-множества соседей.
+ */
+typedef struct NeighborSlot {
+    int node;   /**< Индекс соседа */
+    Node* link; /**< Узел списка смежности с этим соседом, NULL - ячейка пуста */
+} NeighborSlot;
+
+/** @struct NeighborSet
+ *  @brief Множество соседей вершины с открытой адресацией и линейным пробированием.
+ */
+typedef struct NeighborSet {
+    NeighborSlot* slots; /**< Ячейки, ёмкость - степень двойки */
+    size_t capacity;     /**< Количество ячеек */
+    size_t count;        /**< Количество соседей */
+    int shift;           /**< Сдвиг мультипликативного хеша: 32 - log2(capacity) */
+} NeighborSet;
+
+/** @struct CsrGraph
+ *  @brief Неизменяемое представление графа в формате CSR (compressed sparse row).
+ *
+ *  Соседи вершины v лежат подряд: targets[offsets[v]] .. targets[offsets[v + 1] - 1],
+ *  поэтому обход читает память последовательно, без перехода по указателям.
+ *
+ *  @var CsrGraph::num_nodes
+ *  Количество вершин в графе.
+ *
+ *  @var CsrGraph::num_edges
+ *  Количество рёбер в графе.
+ *
+ *  @var CsrGraph::offsets
+ *  Начало списка соседей каждой вершины, num_nodes + 1 элементов.
+ *
+ *  @var CsrGraph::targets
+ *  Соседи всех вершин подряд, num_edges элементов.
+ */
+typedef struct CsrGraph {
+    int num_nodes;    /**< Количество вершин в графе */
+    size_t num_edges; /**< Количество рёбер в графе */
+    size_t* offsets;  /**< Начало списка соседей каждой вершины */
+    int* targets;     /**< Соседи всех вершин подряд */
+} CsrGraph;
+
+/** @struct GraphEdge
+ *  @brief Ребро графа для построения CSR из массива рёбер.
+ */
+typedef struct GraphEdge {
+    int src;  /**< Индекс исходной вершины */
+    int dest; /**< Индекс целевой вершины */
+} GraphEdge;
+
+/** @struct GraphVisitor
+ *  @brief Обработчики событий обхода dfs_visit / bfs_visit. Любой указатель на функцию может быть NULL.
+ */
+typedef struct GraphVisitor {
+    void (*on_discover)(int vertex, int parent, void* context);      /**< Вершина открыта (parent = start для start) */
+    void (*on_finish)(int vertex, void* context);                    /**< Все рёбра вершины просмотрены */
+    void (*on_edge)(int src, int dest, int tree_edge, void* context); /**< Просмотр ребра; tree_edge - ребро дерева */
+    void* context;                                                    /**< Передаётся в обработчики */
+} GraphVisitor;
+
+/** @struct GraphTraversal
+ *  @brief Выходные массивы dfs_visit / bfs_visit. Любой массив может быть NULL.
+ *
+ *  Массивы parent, depth, discovery и finish индексируются вершинами (num_nodes элементов),
+ *  для недостижимых вершин в них -1. Время - общий счётчик открытий и закрытий вершин.
+ */
+typedef struct GraphTraversal {
+    int* order;     /**< Вершины в порядке открытия */
+    int* parent;    /**< Родитель в дереве обхода, start для start */
+    int* depth;     /**< Глубина в дереве обхода */
+    int* discovery; /**< Время открытия */
+    int* finish;    /**< Время закрытия */
+} GraphTraversal;
+
+/** @struct GraphBarrier
+ *  @brief Барьер потоков параллельных обходов. Число участников задаётся после запуска потоков.
+ */
+typedef struct GraphBarrier {
+    pthread_mutex_t lock;   /**< Защищает поля барьера */
+    pthread_cond_t changed; /**< Сигнал о завершении поколения */
+    int parties;            /**< Количество участников (0 - ещё не известно) */
+    int waiting;            /**< Сколько участников уже ждут */
+    unsigned generation;    /**< Номер поколения барьера */
+} GraphBarrier;
+
+/** @struct ParallelBfs
+ *  @brief Общее состояние параллельного BFS.
+ */
+typedef struct ParallelBfs {
+    const CsrGraph* csr;  /**< Граф */
+    int* parent;          /**< Родители вершин */
+    int* depth;           /**< Глубины вершин или NULL */
+    uint64_t* visited;    /**< Битовая карта посещённых вершин, биты ставятся атомарно */
+    int* frontier;        /**< Текущий фронт */
+    int* next;            /**< Следующий фронт */
+    int frontier_size;    /**< Размер текущего фронта */
+    int next_size;        /**< Размер следующего фронта, атомарный */
+    size_t cursor;        /**< Следующая необработанная вершина фронта, атомарный */
+    int level;            /**< Глубина текущего фронта */
+    GraphBarrier barrier; /**< Барьер между уровнями */
+} ParallelBfs;
+
+/** @struct ParallelComponents
+ *  @brief Общее состояние параллельного поиска компонент связности.
+ */
+typedef struct ParallelComponents {
+    const CsrGraph* out;  /**< Граф */
+    const CsrGraph* in;   /**< Транспонированный граф, сам граф для неориентированного или NULL */
+    int* component;       /**< Метки компонент */
+    size_t cursor;        /**< Следующая необработанная вершина, атомарный */
+    int frequent;         /**< Самая частая метка в выборке (-1 - не пропускать вершины) */
+    GraphBarrier barrier; /**< Барьер между фазами */
+} ParallelComponents;
+
+static void traversal_init(const Graph* graph, GraphTraversal* result);
+static void traversal_discover(const GraphVisitor* visitor, GraphTraversal* result, int vertex, int parent, int depth,
+                               int index, int time);
+static void traversal_finish(const GraphVisitor* visitor, GraphTraversal* result, int vertex, int time);
+static void print_vertex(int vertex, int parent, void* context);
+static CsrGraph* csr_alloc(int num_nodes, size_t num_edges);
+static size_t top_down_step(const CsrGraph* out, int* parent, int* depth, const int* queue, int queue_size,
+                            int* next_queue, int* next_size, int level);
+static int bottom_up_step(const CsrGraph* in, int* parent, int* depth, const uint64_t* front, uint64_t* next,
+                          int level);
+static int barrier_wait(GraphBarrier* barrier);
+static void parallel_run(int threads, void* (*worker)(void*), void* job, GraphBarrier* barrier);
+static void* bfs_worker(void* argument);
+static void* components_worker(void* argument);
 static Node* create_node(int node);
+static NeighborSet* neighbor_set_create(const Node* head, size_t count);
+static void neighbor_set_destroy(NeighborSet* set);
+static NeighborSlot* neighbor_set_find(const NeighborSet* set, int node);
+static int neighbor_set_reserve(NeighborSet* set);
+static void neighbor_set_put(NeighborSet* set, Node* link);
+static void neighbor_set_remove(NeighborSet* set, NeighborSlot* slot);
 static void free_list(Node* head);
 
 /**
@@ -57,7 +210,10 @@ Graph* create_graph(int num_nodes) {
 
     graph->num_nodes = num_nodes;
     graph->adj_list = (Node**)malloc(num_nodes * sizeof(Node*));
-    if (!graph->adj_list) {
+    graph->hubs = (NeighborSet**)calloc(num_nodes, sizeof(NeighborSet*));
+    if (!graph->adj_list || !graph->hubs) {
+        free(graph->adj_list);
+        free(graph->hubs);
         free(graph);
         return NULL;
     }
@@ -73,23 +229,41 @@ Graph* create_graph(int num_nodes) {
  */
 void destroy_graph(Graph* graph) {
     if (graph) {
-        for (int i = 0; i < graph->num_nodes; i++) free_list(graph->adj_list[i]);
+        for (int i = 0; i < graph->num_nodes; i++) {
+            free_list(graph->adj_list[i]);
+            neighbor_set_destroy(graph->hubs[i]);
+        }
         
         free(graph->adj_list);
+        free(graph->hubs);
         free(graph);
     }
 }
 
 /**
  * @brief Добавляет ребро в граф.
+ * @details У вершины со степенью меньше GRAPH_HUB_DEGREE повтор ищется в коротком списке,
+ * у хаба - в хеш-множестве, поэтому добавление занимает O(1) в среднем. Когда степень
+ * достигает GRAPH_HUB_DEGREE, для вершины строится хеш-множество соседей.
  * @param graph Указатель на граф.
  * @param src Индекс исходной вершины.
  * @param dest Индекс целевой вершины.
- * @return Код ошибки выполнения.
+ * @return Код ошибки выполнения (GRAPH_ERR_EDGE_EXISTS - ребро уже было, граф не изменён).
  */
 GraphError add_edge(Graph* graph, int src, int dest) {
-    if (src >= graph->num_nodes || dest >= graph->num_nodes) return GRAPH_ERR_INVALID_NODE;
-    
+    if (src < 0 || dest < 0 || src >= graph->num_nodes || dest >= graph->num_nodes) return GRAPH_ERR_INVALID_NODE;
+
+    NeighborSet* hub = graph->hubs[src];
+    size_t degree = 0;
+
+    if (hub) {
+        if (neighbor_set_find(hub, dest)) return GRAPH_ERR_EDGE_EXISTS;
+        if (!neighbor_set_reserve(hub)) return GRAPH_ERR_MEMORY;
+    } else {
+        for (Node* temp = graph->adj_list[src]; temp; temp = temp->next, degree++)
+            if (temp->node == dest) return GRAPH_ERR_EDGE_EXISTS;
+    }
+
     Node* new_node = create_node(dest);
 
     if (!new_node) return GRAPH_ERR_MEMORY;
@@ -97,27 +271,55 @@ GraphError add_edge(Graph* graph, int src, int dest) {
     new_node->next = graph->adj_list[src];
     graph->adj_list[src] = new_node;
 
-    // Проверяем, не существует ли уже такое ребро в обратном направлении
-    Node* temp = graph->adj_list[src];
-    while (temp) {
-        if (temp->node == dest) return GRAPH_ERR_EDGE_EXISTS;
-        
-        temp = temp->next;
-    }
+    // Если множество не удалось выделить, вершина остаётся списком: медленнее, но верно
+    if (hub) neighbor_set_put(hub, new_node);
+    else if (degree + 1 >= GRAPH_HUB_DEGREE) graph->hubs[src] = neighbor_set_create(new_node, degree + 1);
 
     return GRAPH_SUCCESS;
 }
 
 /**
  * @brief Удаляет ребро из графа.
+ * @details У хаба узел находится через хеш-множество. Чтобы не искать предыдущий узел
+ * односвязного списка, в найденный узел переносится сосед из головы списка, а удаляется
+ * голова, поэтому порядок соседей хаба после удаления меняется. Когда степень хаба падает
+ * ниже GRAPH_HUB_DEGREE / 2, множество освобождается.
  * @param graph Указатель на граф.
  * @param src Индекс исходной вершины.
  * @param dest Индекс целевой вершины.
  * @return Код ошибки выполнения.
  */
 GraphError remove_edge(Graph* graph, int src, int dest) {
-    if (src >= graph->num_nodes || dest >= graph->num_nodes) return GRAPH_ERR_INVALID_NODE;
-    
+    if (src < 0 || dest < 0 || src >= graph->num_nodes || dest >= graph->num_nodes) return GRAPH_ERR_INVALID_NODE;
+
+    NeighborSet* hub = graph->hubs[src];
+
+    if (hub) {
+        NeighborSlot* slot = neighbor_set_find(hub, dest);
+
+        if (!slot) return GRAPH_ERR_EDGE_NOT_FOUND;
+
+        Node* head = graph->adj_list[src];
+        Node* temp = slot->link;
+
+        neighbor_set_remove(hub, slot);
+
+        if (temp != head) {
+            temp->node = head->node;
+            neighbor_set_find(hub, head->node)->link = temp;
+        }
+
+        graph->adj_list[src] = head->next;
+        free(head);
+
+        if (hub->count < GRAPH_HUB_DEGREE / 2) {
+            neighbor_set_destroy(hub);
+            graph->hubs[src] = NULL;
+        }
+
+        return GRAPH_SUCCESS;
+    }
+
     Node* temp = graph->adj_list[src];
     Node* prev = NULL;
 
@@ -138,78 +340,574 @@ GraphError remove_edge(Graph* graph, int src, int dest) {
 }
 
 /**
- * @brief Выполняет поиск в глубину (DFS) для графа.
+ * @brief Проверяет, есть ли в графе ребро, за O(1) в среднем.
+ * @param graph Указатель на граф.
+ * @param src Индекс исходной вершины.
+ * @param dest Индекс целевой вершины.
+ * @return 1, если ребро есть, иначе 0 (в том числе для неверных вершин).
+ */
+int has_edge(const Graph* graph, int src, int dest) {
+    if (src < 0 || dest < 0 || src >= graph->num_nodes || dest >= graph->num_nodes) return 0;
+
+    if (graph->hubs[src]) return neighbor_set_find(graph->hubs[src], dest) != NULL;
+
+    for (Node* temp = graph->adj_list[src]; temp; temp = temp->next)
+        if (temp->node == dest) return 1;
+
+    return 0;
+}
+
+/**
+ * @brief Поиск в глубину (DFS) без рекурсии с обработчиками событий и выходными массивами.
+ * @details Стек на num_nodes вершин выделяется заранее: для каждой вершины пути на нём лежит
+ * следующий непросмотренный узел её списка смежности, поэтому глубина обхода ограничена только
+ * числом вершин, а не стеком вызовов. Порядок посещения тот же, что у рекурсивного обхода.
  * @param graph Указатель на граф.
  * @param start Индекс начальной вершины.
+ * @param visitor Обработчики событий или NULL.
+ * @param result Выходные массивы или NULL.
+ * @return Количество посещённых вершин (0 при неверной вершине или ошибке выделения памяти).
  */
-void dfs(Graph* graph, int start) {
-    int* visited = (int*)malloc(graph->num_nodes * sizeof(int));
+int dfs_visit(const Graph* graph, int start, const GraphVisitor* visitor, GraphTraversal* result) {
+    if (start < 0 || start >= graph->num_nodes) return 0;
+
+    unsigned char* visited = (unsigned char*)calloc(graph->num_nodes, 1);
+    int* stack = (int*)malloc(graph->num_nodes * sizeof(int));
+    Node** next = (Node**)malloc(graph->num_nodes * sizeof(Node*));
+    int count = 0, time = 0, top = 0;
+
+    if (visited && stack && next) {
+        traversal_init(graph, result);
+        visited[start] = 1;
+        traversal_discover(visitor, result, start, start, 0, count++, time++);
+        stack[0] = start;
+        next[0] = graph->adj_list[start];
+
+        while (top >= 0) {
+            int current = stack[top];
+            Node* temp = next[top];
+
+            if (!temp) {
+                traversal_finish(visitor, result, current, time++);
+                top--;
+                continue;
+            }
+
+            next[top] = temp->next;
+
+            int tree_edge = !visited[temp->node];
+
+            if (visitor && visitor->on_edge) visitor->on_edge(current, temp->node, tree_edge, visitor->context);
+
+            if (tree_edge) {
+                visited[temp->node] = 1;
+                traversal_discover(visitor, result, temp->node, current, top + 1, count++, time++);
+                stack[++top] = temp->node;
+                next[top] = graph->adj_list[temp->node];
+            }
+        }
+    }
 
-    if (!visited) return;
-    
-    for (int i = 0; i < graph->num_nodes; i++) visited[i] = 0;
-    
-    dfs_helper(graph, start, visited);
     free(visited);
+    free(stack);
+    free(next);
+
+    return count;
 }
 
 /**
- * @brief Рекурсивная вспомогательная функция для DFS.
+ * @brief Поиск в ширину (BFS) с обработчиками событий и выходными массивами.
+ * @details Очередь - массив на num_nodes вершин, выделенный заранее (или result->order, если он задан).
+ * Вершина закрывается, когда просмотрены все её рёбра.
  * @param graph Указатель на граф.
- * @param start Индекс текущей вершины.
- * @param visited Массив посещённых вершин.
+ * @param start Индекс начальной вершины.
+ * @param visitor Обработчики событий или NULL.
+ * @param result Выходные массивы или NULL.
+ * @return Количество посещённых вершин (0 при неверной вершине или ошибке выделения памяти).
  */
-static void dfs_helper(Graph* graph, int start, int* visited) {
-    visited[start] = 1;
-    printf("%d ", start);
+int bfs_visit(const Graph* graph, int start, const GraphVisitor* visitor, GraphTraversal* result) {
+    if (start < 0 || start >= graph->num_nodes) return 0;
+
+    unsigned char* visited = (unsigned char*)calloc(graph->num_nodes, 1);
+    int* queue = result && result->order ? result->order : (int*)malloc(graph->num_nodes * sizeof(int));
+    int count = 0, time = 0;
+
+    if (visited && queue) {
+        traversal_init(graph, result);
+        visited[start] = 1;
+        traversal_discover(visitor, result, start, start, 0, count, time++);
+        queue[count++] = start;
+
+        for (int head = 0; head < count; head++) {
+            int current = queue[head];
+            int depth = result && result->depth ? result->depth[current] + 1 : 0;
+
+            for (Node* temp = graph->adj_list[current]; temp; temp = temp->next) {
+                int tree_edge = !visited[temp->node];
+
+                if (visitor && visitor->on_edge) visitor->on_edge(current, temp->node, tree_edge, visitor->context);
 
-    Node* adj_list = graph->adj_list[start];
-    while (adj_list) {
-        if (!visited[adj_list->node]) {
-            dfs_helper(graph, adj_list->node, visited);
+                if (tree_edge) {
+                    visited[temp->node] = 1;
+                    traversal_discover(visitor, result, temp->node, current, depth, count, time++);
+                    queue[count++] = temp->node;
+                }
+            }
+
+            traversal_finish(visitor, result, current, time++);
         }
-        adj_list = adj_list->next;
     }
+
+    free(visited);
+    if (!result || queue != result->order) free(queue);
+
+    return count;
+}
+
+/**
+ * @brief Выполняет поиск в глубину (DFS) для графа и печатает вершины в порядке посещения.
+ * @param graph Указатель на граф.
+ * @param start Индекс начальной вершины.
+ */
+void dfs(Graph* graph, int start) {
+    GraphVisitor visitor = {print_vertex, NULL, NULL, NULL};
+
+    dfs_visit(graph, start, &visitor, NULL);
 }
 
 /**
- * @brief Выполняет поиск в ширину (BFS) для графа.
+ * @brief Выполняет поиск в ширину (BFS) для графа и печатает вершины в порядке посещения.
  * @param graph Указатель на граф.
  * @param start Индекс начальной вершины.
  */
 void bfs(Graph* graph, int start) {
-    int* visited = (int*)malloc(graph->num_nodes * sizeof(int));
+    GraphVisitor visitor = {print_vertex, NULL, NULL, NULL};
 
-    if (!visited) return;
-    
-    for (int i = 0; i < graph->num_nodes; i++) visited[i] = 0;
+    printf("BFS: ");
+    bfs_visit(graph, start, &visitor, NULL);
+}
 
-    visited[start] = 1;
-    printf("BFS: %d ", start);
+/**
+ * @brief Освобождает память, выделенную для CSR-графа.
+ * @param csr Указатель на CSR-граф.
+ */
+void csr_destroy(CsrGraph* csr) {
+    if (csr) {
+        free(csr->offsets);
+        free(csr->targets);
+        free(csr);
+    }
+}
+
+/**
+ * @brief Строит CSR-представление графа за O(V + E).
+ * @details Соседи каждой вершины идут в том же порядке, что и в списке смежности,
+ * поэтому обходы CSR посещают вершины в том же порядке, что dfs и bfs. Списки
+ * просматриваются один раз: targets растёт удвоением, а не размечается заранее подсчётом.
+ * @param graph Указатель на граф.
+ * @return Указатель на CSR-граф или NULL при ошибке выделения памяти.
+ */
+CsrGraph* csr_from_graph(const Graph* graph) {
+    CsrGraph* csr = csr_alloc(graph->num_nodes, 0);
+    size_t capacity = 1, position = 0;
 
-    Node* queue = create_node(start);
-    Node* tail = queue;
+    if (!csr) return NULL;
 
-    while (queue) {
-        int current = queue->node;
-        Node* adj_list = graph->adj_list[current];
+    for (int i = 0; i < graph->num_nodes; i++) {
+        csr->offsets[i] = position;
 
-        while (adj_list) {
-            if (!visited[adj_list->node]) {
-                visited[adj_list->node] = 1;
-                tail->next = create_node(adj_list->node);
-                tail = tail->next;
-                printf("%d ", adj_list->node);
+        for (Node* temp = graph->adj_list[i]; temp; temp = temp->next) {
+            if (position == capacity) {
+                int* targets = (int*)realloc(csr->targets, capacity * 2 * sizeof(int));
+
+                if (!targets) {
+                    csr_destroy(csr);
+                    return NULL;
+                }
+
+                csr->targets = targets;
+                capacity *= 2;
             }
-            adj_list = adj_list->next;
+
+            csr->targets[position++] = temp->node;
         }
+    }
 
-        Node* temp = queue;
-        queue = queue->next;
-        free(temp);
+    csr->offsets[graph->num_nodes] = position;
+    csr->num_edges = position;
+
+    int* targets = (int*)realloc(csr->targets, (position ? position : 1) * sizeof(int));
+
+    if (targets) csr->targets = targets;
+
+    return csr;
+}
+
+/**
+ * @brief Строит CSR-граф из массива рёбер сортировкой подсчётом за O(V + E).
+ * @details Соседи каждой вершины идут в порядке рёбер в массиве.
+ * @param num_nodes Количество вершин в графе.
+ * @param edges Массив рёбер.
+ * @param num_edges Количество рёбер.
+ * @return Указатель на CSR-граф или NULL при ошибке выделения памяти или неверной вершине.
+ */
+CsrGraph* csr_from_edges(int num_nodes, const GraphEdge* edges, size_t num_edges) {
+    for (size_t i = 0; i < num_edges; i++)
+        if (edges[i].src < 0 || edges[i].src >= num_nodes || edges[i].dest < 0 || edges[i].dest >= num_nodes)
+            return NULL;
+
+    CsrGraph* csr = csr_alloc(num_nodes, num_edges);
+    size_t* position = (size_t*)malloc(((size_t)num_nodes + 1) * sizeof(size_t));
+
+    if (!csr || !position) {
+        csr_destroy(csr);
+        free(position);
+        return NULL;
+    }
+
+    memset(csr->offsets, 0, ((size_t)num_nodes + 1) * sizeof(size_t));
+
+    for (size_t i = 0; i < num_edges; i++) csr->offsets[edges[i].src + 1]++;
+
+    for (int i = 0; i < num_nodes; i++) csr->offsets[i + 1] += csr->offsets[i];
+
+    memcpy(position, csr->offsets, ((size_t)num_nodes + 1) * sizeof(size_t));
+
+    for (size_t i = 0; i < num_edges; i++) csr->targets[position[edges[i].src]++] = edges[i].dest;
+
+    free(position);
+
+    return csr;
+}
+
+/**
+ * @brief Выполняет поиск в глубину (DFS) для CSR-графа без рекурсии.
+ * @details Порядок посещения тот же, что у рекурсивного dfs: на явном стеке хранится
+ * вершина и позиция следующего непросмотренного соседа.
+ * @param csr Указатель на CSR-граф.
+ * @param start Индекс начальной вершины.
+ * @param order Массив из num_nodes элементов для порядка посещения.
+ * @return Количество посещённых вершин (0 при неверной вершине или ошибке выделения памяти).
+ */
+int csr_dfs(const CsrGraph* csr, int start, int* order) {
+    if (start < 0 || start >= csr->num_nodes) return 0;
+
+    unsigned char* visited = (unsigned char*)calloc(csr->num_nodes, 1);
+    int* stack = (int*)malloc(csr->num_nodes * sizeof(int));
+    size_t* next = (size_t*)malloc(csr->num_nodes * sizeof(size_t));
+    int count = 0;
+
+    if (visited && stack && next) {
+        int depth = 0;
+
+        visited[start] = 1;
+        order[count++] = start;
+        stack[0] = start;
+        next[0] = csr->offsets[start];
+
+        while (depth >= 0) {
+            int current = stack[depth];
+
+            if (next[depth] == csr->offsets[current + 1]) {
+                depth--;
+                continue;
+            }
+
+            int neighbor = csr->targets[next[depth]++];
+
+            if (!visited[neighbor]) {
+                visited[neighbor] = 1;
+                order[count++] = neighbor;
+                stack[++depth] = neighbor;
+                next[depth] = csr->offsets[neighbor];
+            }
+        }
+    }
+
+    free(visited);
+    free(stack);
+    free(next);
+
+    return count;
+}
+
+/**
+ * @brief Выполняет поиск в ширину (BFS) для CSR-графа.
+ * @details Очередью служит сам массив order: вершины дописываются в его конец.
+ * @param csr Указатель на CSR-граф.
+ * @param start Индекс начальной вершины.
+ * @param order Массив из num_nodes элементов для порядка посещения.
+ * @return Количество посещённых вершин (0 при неверной вершине или ошибке выделения памяти).
+ */
+int csr_bfs(const CsrGraph* csr, int start, int* order) {
+    if (start < 0 || start >= csr->num_nodes) return 0;
+
+    unsigned char* visited = (unsigned char*)calloc(csr->num_nodes, 1);
+    int count = 0;
+
+    if (!visited) return 0;
+
+    visited[start] = 1;
+    order[count++] = start;
+
+    for (int head = 0; head < count; head++) {
+        int current = order[head];
+
+        for (size_t i = csr->offsets[current]; i < csr->offsets[current + 1]; i++) {
+            int neighbor = csr->targets[i];
+
+            if (!visited[neighbor]) {
+                visited[neighbor] = 1;
+                order[count++] = neighbor;
+            }
+        }
     }
 
     free(visited);
+
+    return count;
+}
+
+/**
+ * @brief Строит транспонированный CSR-граф (все рёбра развёрнуты) за O(V + E).
+ * @details Нужен обходу снизу вверх на ориентированном графе: там просматриваются входящие рёбра.
+ * @param csr Указатель на CSR-граф.
+ * @return Указатель на транспонированный граф или NULL при ошибке выделения памяти.
+ */
+CsrGraph* csr_transpose(const CsrGraph* csr) {
+    CsrGraph* transposed = csr_alloc(csr->num_nodes, csr->num_edges);
+    size_t* position = (size_t*)malloc(((size_t)csr->num_nodes + 1) * sizeof(size_t));
+
+    if (!transposed || !position) {
+        csr_destroy(transposed);
+        free(position);
+        return NULL;
+    }
+
+    memset(transposed->offsets, 0, ((size_t)csr->num_nodes + 1) * sizeof(size_t));
+
+    for (size_t i = 0; i < csr->num_edges; i++) transposed->offsets[csr->targets[i] + 1]++;
+
+    for (int i = 0; i < csr->num_nodes; i++) transposed->offsets[i + 1] += transposed->offsets[i];
+
+    memcpy(position, transposed->offsets, ((size_t)csr->num_nodes + 1) * sizeof(size_t));
+
+    for (int i = 0; i < csr->num_nodes; i++)
+        for (size_t j = csr->offsets[i]; j < csr->offsets[i + 1]; j++)
+            transposed->targets[position[csr->targets[j]]++] = i;
+
+    free(position);
+
+    return transposed;
+}
+
+/**
+ * @brief Поиск в ширину с выбором направления (direction-optimizing BFS, Beamer и др.).
+ * @details Пока фронт мал, уровень обходится сверху вниз: из вершин очереди по исходящим
+ * рёбрам. Когда рёбер у фронта становится больше, чем непросмотренных рёбер / DOBFS_ALPHA,
+ * обход переключается снизу вверх: каждая непосещённая вершина ищет среди входящих рёбер
+ * вершину фронта (битовая карта) и останавливается на первой найденной. Обратно сверху
+ * вниз - когда фронт сокращается и становится меньше num_nodes / DOBFS_BETA.
+ * Родитель вершины - любая вершина предыдущего уровня, поэтому дерево может отличаться
+ * от дерева bfs, а глубины совпадают.
+ * @param out CSR-граф.
+ * @param in Транспонированный граф (csr_transpose) или сам out, если граф неориентированный.
+ * @param start Индекс начальной вершины.
+ * @param parent Массив из num_nodes элементов: родитель в дереве обхода, start для start, -1 для недостижимых.
+ * @param depth Массив из num_nodes элементов для расстояний от start (-1 для недостижимых) или NULL.
+ * @return Количество достижимых вершин (0 при неверной вершине или ошибке выделения памяти).
+ */
+int csr_bfs_direction_optimizing(const CsrGraph* out, const CsrGraph* in, int start, int* parent, int* depth) {
+    int num_nodes = out->num_nodes;
+
+    if (start < 0 || start >= num_nodes || in->num_nodes != num_nodes) return 0;
+
+    size_t words = ((size_t)num_nodes + 63) / 64;
+    int* queue = (int*)malloc(num_nodes * sizeof(int));
+    int* next_queue = (int*)malloc(num_nodes * sizeof(int));
+    uint64_t* front = (uint64_t*)calloc(words, sizeof(uint64_t));
+    uint64_t* next = (uint64_t*)calloc(words, sizeof(uint64_t));
+    int reached = 0;
+
+    if (!queue || !next_queue || !front || !next) goto done;
+
+    for (int i = 0; i < num_nodes; i++) parent[i] = -1;
+
+    if (depth)
+        for (int i = 0; i < num_nodes; i++) depth[i] = -1;
+
+    parent[start] = start;
+    if (depth) depth[start] = 0;
+
+    queue[0] = start;
+
+    int queue_size = 1, level = 0;
+    size_t scout = out->offsets[start + 1] - out->offsets[start];
+    size_t edges_to_check = out->num_edges;
+
+    reached = 1;
+
+    while (queue_size > 0) {
+        if (scout > edges_to_check / DOBFS_ALPHA) {
+            // Снизу вверх: очередь в битовую карту, уровни до тех пор, пока фронт велик или растёт
+            int awake = queue_size, old_awake;
+
+            for (int i = 0; i < queue_size; i++) front[queue[i] >> 6] |= 1ULL << (queue[i] & 63);
+
+            do {
+                old_awake = awake;
+                awake = bottom_up_step(in, parent, depth, front, next, ++level);
+                reached += awake;
+
+                uint64_t* temp = front;
+                front = next;
+                next = temp;
+                memset(next, 0, words * sizeof(uint64_t));
+            } while (awake >= old_awake || awake > num_nodes / DOBFS_BETA);
+
+            queue_size = 0;
+            scout = 0;
+
+            for (size_t w = 0; w < words; w++) {
+                for (uint64_t bits = front[w]; bits; bits &= bits - 1) {
+                    int v = (int)(w * 64 + __builtin_ctzll(bits));
+
+                    queue[queue_size++] = v;
+                    scout += out->offsets[v + 1] - out->offsets[v];
+                }
+
+                front[w] = 0;
+            }
+        } else {
+            int next_size = 0;
+
+            edges_to_check -= scout < edges_to_check ? scout : edges_to_check;
+            scout = top_down_step(out, parent, depth, queue, queue_size, next_queue, &next_size, ++level);
+            reached += next_size;
+
+            int* temp = queue;
+            queue = next_queue;
+            next_queue = temp;
+            queue_size = next_size;
+        }
+    }
+
+done:
+    free(queue);
+    free(next_queue);
+    free(front);
+    free(next);
+
+    return reached;
+}
+
+/**
+ * @brief Параллельный поиск в ширину по уровням (сверху вниз).
+ * @details Потоки берут вершины фронта порциями по PARALLEL_CHUNK, посещённые вершины
+ * отмечаются атомарной установкой бита, поэтому родителя каждой вершине записывает ровно
+ * один поток. Новые вершины копятся в локальной очереди потока и переносятся в следующий
+ * фронт целиком, одной атомарной операцией. Между уровнями - барьер.
+ * @param csr Указатель на CSR-граф.
+ * @param start Индекс начальной вершины.
+ * @param parent Массив из num_nodes элементов: родитель в дереве обхода, start для start, -1 для недостижимых.
+ * @param depth Массив из num_nodes элементов для расстояний от start (-1 для недостижимых) или NULL.
+ * @param threads Количество потоков (0 - по числу процессоров).
+ * @return Количество достижимых вершин (0 при неверной вершине или ошибке выделения памяти).
+ */
+int csr_bfs_parallel(const CsrGraph* csr, int start, int* parent, int* depth, int threads) {
+    if (start < 0 || start >= csr->num_nodes) return 0;
+
+    ParallelBfs job = {csr, parent, depth, (uint64_t*)calloc(((size_t)csr->num_nodes + 63) / 64, sizeof(uint64_t)),
+                       (int*)malloc(csr->num_nodes * sizeof(int)), (int*)malloc(csr->num_nodes * sizeof(int)),
+                       1, 0, 0, 0, {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0, 0}};
+    int reached = 0;
+
+    if (job.visited && job.frontier && job.next) {
+        for (int i = 0; i < csr->num_nodes; i++) parent[i] = -1;
+
+        if (depth)
+            for (int i = 0; i < csr->num_nodes; i++) depth[i] = -1;
+
+        parent[start] = start;
+        if (depth) depth[start] = 0;
+
+        job.visited[start >> 6] |= 1ULL << (start & 63);
+        job.frontier[0] = start;
+
+        parallel_run(threads, bfs_worker, &job, &job.barrier);
+
+        for (int i = 0; i < csr->num_nodes; i++) reached += parent[i] >= 0;
+    }
+
+    free(job.visited);
+    free(job.frontier);
+    free(job.next);
+
+    return reached;
+}
+
+/**
+ * @brief Параллельный поиск компонент связности (Afforest: union-find со связыванием без блокировок).
+ * @details Сначала связываются первые AFFOREST_ROUNDS соседей каждой вершины, затем по
+ * выборке находится самая большая компонента, и рёбра её вершин больше не просматриваются:
+ * для них достаточно рёбер с другой стороны. Поэтому пропуск возможен, только если
+ * известны входящие рёбра (in); без них просматриваются все рёбра. Связывание подвешивает
+ * корень с большим номером к меньшему сравнением с обменом, в конце пути сжимаются.
+ * Для ориентированного графа ищутся слабые компоненты.
+ * @param out Указатель на CSR-граф.
+ * @param in Транспонированный граф (csr_transpose), сам out для неориентированного графа или NULL.
+ * @param component Массив из num_nodes элементов: наименьший номер вершины в компоненте.
+ * @param threads Количество потоков (0 - по числу процессоров).
+ * @return Количество компонент.
+ */
+int csr_connected_components(const CsrGraph* out, const CsrGraph* in, int* component, int threads) {
+    ParallelComponents job = {out, in, component, 0, -1,
+                              {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0, 0}};
+    int count = 0;
+
+    for (int i = 0; i < out->num_nodes; i++) component[i] = i;
+
+    parallel_run(threads, components_worker, &job, &job.barrier);
+
+    for (int i = 0; i < out->num_nodes; i++) count += component[i] == i;
+
+    return count;
+}
+
+/**
+ * @brief Параллельный BFS для графа со списками смежности через его CSR-представление.
+ * @param graph Указатель на граф.
+ * @param start Индекс начальной вершины.
+ * @param parent Массив из num_nodes элементов для родителей.
+ * @param depth Массив из num_nodes элементов для расстояний или NULL.
+ * @param threads Количество потоков (0 - по числу процессоров).
+ * @return Количество достижимых вершин (0 при неверной вершине или ошибке выделения памяти).
+ */
+int bfs_parallel(Graph* graph, int start, int* parent, int* depth, int threads) {
+    CsrGraph* csr = csr_from_graph(graph);
+    int reached = csr ? csr_bfs_parallel(csr, start, parent, depth, threads) : 0;
+
+    csr_destroy(csr);
+
+    return reached;
+}
+
+/**
+ * @brief Параллельный поиск (слабых) компонент связности графа со списками смежности.
+ * @param graph Указатель на граф.
+ * @param component Массив из num_nodes элементов: наименьший номер вершины в компоненте.
+ * @param threads Количество потоков (0 - по числу процессоров).
+ * @return Количество компонент или -1 при ошибке выделения памяти.
+ */
+int connected_components(Graph* graph, int* component, int threads) {
+    CsrGraph* csr = csr_from_graph(graph);
+    CsrGraph* transposed = csr ? csr_transpose(csr) : NULL;
+    int count = transposed ? csr_connected_components(csr, transposed, component, threads) : -1;
+
+    csr_destroy(csr);
+    csr_destroy(transposed);
+
+    return count;
 }
 
 /**
@@ -239,3 +937,1430 @@ static void free_list(Node* head) {
     }
 }
 
+/**
+ * @brief Домашняя ячейка соседа: старшие биты мультипликативного хеша.
+ */
+static inline size_t neighbor_set_home(const NeighborSet* set, int node) {
+    return (size_t)(((uint32_t)node * 2654435769u) >> set->shift);
+}
+
+/**
+ * @brief Выделяет пустые ячейки хеш-множества.
+ * @param set Хеш-множество.
+ * @param capacity Ёмкость, степень двойки.
+ * @return 1 при успехе, 0 при ошибке выделения памяти (множество не изменено).
+ */
+static int neighbor_set_allocate(NeighborSet* set, size_t capacity) {
+    NeighborSlot* slots = (NeighborSlot*)calloc(capacity, sizeof(NeighborSlot));
+    int bits = 0;
+
+    if (!slots) return 0;
+
+    while (((size_t)1 << bits) < capacity) bits++;
+
+    set->slots = slots;
+    set->capacity = capacity;
+    set->count = 0;
+    set->shift = 32 - bits;
+
+    return 1;
+}
+
+/**
+ * @brief Строит хеш-множество по списку смежности вершины.
+ * @param head Голова списка смежности.
+ * @param count Длина списка.
+ * @return Указатель на множество или NULL при ошибке выделения памяти.
+ */
+static NeighborSet* neighbor_set_create(const Node* head, size_t count) {
+    NeighborSet* set = (NeighborSet*)malloc(sizeof(NeighborSet));
+    size_t capacity = NEIGHBOR_SET_MIN;
+
+    while (capacity < 2 * count) capacity *= 2;
+
+    if (!set || !neighbor_set_allocate(set, capacity)) {
+        free(set);
+        return NULL;
+    }
+
+    for (const Node* temp = head; temp; temp = temp->next) neighbor_set_put(set, (Node*)temp);
+
+    return set;
+}
+
+/**
+ * @brief Освобождает хеш-множество (узлы списка смежности не трогает).
+ * @param set Хеш-множество или NULL.
+ */
+static void neighbor_set_destroy(NeighborSet* set) {
+    if (!set) return;
+
+    free(set->slots);
+    free(set);
+}
+
+/**
+ * @brief Ищет соседа в хеш-множестве.
+ * @param set Хеш-множество.
+ * @param node Индекс соседа.
+ * @return Ячейка соседа или NULL, если его нет.
+ */
+static NeighborSlot* neighbor_set_find(const NeighborSet* set, int node) {
+    size_t mask = set->capacity - 1;
+
+    for (size_t i = neighbor_set_home(set, node);; i = (i + 1) & mask) {
+        NeighborSlot* slot = &set->slots[i];
+
+        if (!slot->link) return NULL;
+        if (slot->node == node) return slot;
+    }
+}
+
+/**
+ * @brief Гарантирует место для ещё одного соседа, удваивая ёмкость при заполнении больше чем наполовину.
+ * @param set Хеш-множество.
+ * @return 1 при успехе, 0 при ошибке выделения памяти (множество не изменено).
+ */
+static int neighbor_set_reserve(NeighborSet* set) {
+    if (2 * (set->count + 1) <= set->capacity) return 1;
+
+    NeighborSet old = *set;
+
+    if (!neighbor_set_allocate(set, old.capacity * 2)) return 0;
+
+    for (size_t i = 0; i < old.capacity; i++)
+        if (old.slots[i].link) neighbor_set_put(set, old.slots[i].link);
+
+    free(old.slots);
+
+    return 1;
+}
+
+/**
+ * @brief Добавляет узел списка смежности в хеш-множество. Соседа в нём ещё нет, место есть.
+ * @param set Хеш-множество.
+ * @param link Узел списка смежности.
+ */
+static void neighbor_set_put(NeighborSet* set, Node* link) {
+    size_t mask = set->capacity - 1;
+    size_t i = neighbor_set_home(set, link->node);
+
+    while (set->slots[i].link) i = (i + 1) & mask;
+
+    set->slots[i].node = link->node;
+    set->slots[i].link = link;
+    set->count++;
+}
+
+/**
+ * @brief Удаляет ячейку из хеш-множества сдвигом следующих ячеек назад, без меток удаления.
+ * @param set Хеш-множество.
+ * @param slot Удаляемая ячейка.
+ */
+static void neighbor_set_remove(NeighborSet* set, NeighborSlot* slot) {
+    size_t mask = set->capacity - 1;
+    size_t hole = (size_t)(slot - set->slots);
+
+    for (size_t i = (hole + 1) & mask; set->slots[i].link; i = (i + 1) & mask) {
+        size_t home = neighbor_set_home(set, set->slots[i].node);
+
+        // Ячейку можно перенести в дыру, если её домашняя ячейка не лежит между дырой и ней
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            set->slots[hole] = set->slots[i];
+            hole = i;
+        }
+    }
+
+    set->slots[hole].link = NULL;
+    set->count--;
+}
+
+/**
+ * @brief Заполняет выходные массивы обхода значением -1 (вершина не достигнута).
+ * @param graph Указатель на граф.
+ * @param result Выходные массивы или NULL.
+ */
+static void traversal_init(const Graph* graph, GraphTraversal* result) {
+    if (!result) return;
+
+    int* arrays[] = {result->parent, result->depth, result->discovery, result->finish};
+
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++)
+        if (arrays[i]) memset(arrays[i], -1, graph->num_nodes * sizeof(int));
+}
+
+/**
+ * @brief Открывает вершину: записывает выходные массивы и вызывает on_discover.
+ * @param visitor Обработчики событий или NULL.
+ * @param result Выходные массивы или NULL.
+ * @param vertex Открытая вершина.
+ * @param parent Вершина, из которой она открыта.
+ * @param depth Глубина в дереве обхода.
+ * @param index Позиция в порядке открытия.
+ * @param time Время открытия.
+ */
+static void traversal_discover(const GraphVisitor* visitor, GraphTraversal* result, int vertex, int parent, int depth,
+                               int index, int time) {
+    if (result) {
+        if (result->order) result->order[index] = vertex;
+        if (result->parent) result->parent[vertex] = parent;
+        if (result->depth) result->depth[vertex] = depth;
+        if (result->discovery) result->discovery[vertex] = time;
+    }
+
+    if (visitor && visitor->on_discover) visitor->on_discover(vertex, parent, visitor->context);
+}
+
+/**
+ * @brief Закрывает вершину: записывает время закрытия и вызывает on_finish.
+ * @param visitor Обработчики событий или NULL.
+ * @param result Выходные массивы или NULL.
+ * @param vertex Закрытая вершина.
+ * @param time Время закрытия.
+ */
+static void traversal_finish(const GraphVisitor* visitor, GraphTraversal* result, int vertex, int time) {
+    if (result && result->finish) result->finish[vertex] = time;
+
+    if (visitor && visitor->on_finish) visitor->on_finish(vertex, visitor->context);
+}
+
+/**
+ * @brief Обработчик on_discover для dfs и bfs: печатает вершину.
+ */
+static void print_vertex(int vertex, int parent, void* context) {
+    (void)parent;
+    (void)context;
+    printf("%d ", vertex);
+}
+
+/**
+ * @brief Выделяет память под CSR-граф.
+ * @param num_nodes Количество вершин.
+ * @param num_edges Количество рёбер.
+ * @return Указатель на CSR-граф с невыставленными offsets и targets или NULL.
+ */
+static CsrGraph* csr_alloc(int num_nodes, size_t num_edges) {
+    CsrGraph* csr = (CsrGraph*)malloc(sizeof(CsrGraph));
+
+    if (!csr) return NULL;
+
+    csr->num_nodes = num_nodes;
+    csr->num_edges = num_edges;
+    csr->offsets = (size_t*)malloc(((size_t)num_nodes + 1) * sizeof(size_t));
+    csr->targets = (int*)malloc((num_edges ? num_edges : 1) * sizeof(int));
+
+    if (!csr->offsets || !csr->targets) {
+        csr_destroy(csr);
+        return NULL;
+    }
+
+    return csr;
+}
+
+/**
+ * @brief Уровень BFS сверху вниз: из вершин очереди по исходящим рёбрам.
+ * @param out CSR-граф.
+ * @param parent Массив родителей.
+ * @param depth Массив глубин или NULL.
+ * @param queue Фронт.
+ * @param queue_size Размер фронта.
+ * @param next_queue Массив для следующего фронта.
+ * @param next_size Размер следующего фронта.
+ * @param level Глубина вершин следующего фронта.
+ * @return Сумма исходящих степеней вершин следующего фронта.
+ */
+static size_t top_down_step(const CsrGraph* out, int* parent, int* depth, const int* queue, int queue_size,
+                            int* next_queue, int* next_size, int level) {
+    size_t scout = 0;
+
+    for (int i = 0; i < queue_size; i++) {
+        int current = queue[i];
+
+        for (size_t j = out->offsets[current]; j < out->offsets[current + 1]; j++) {
+            int neighbor = out->targets[j];
+
+            if (parent[neighbor] < 0) {
+                parent[neighbor] = current;
+                if (depth) depth[neighbor] = level;
+                next_queue[(*next_size)++] = neighbor;
+                scout += out->offsets[neighbor + 1] - out->offsets[neighbor];
+            }
+        }
+    }
+
+    return scout;
+}
+
+/**
+ * @brief Уровень BFS снизу вверх: каждая непосещённая вершина ищет родителя во фронте.
+ * @param in Транспонированный CSR-граф (входящие рёбра).
+ * @param parent Массив родителей.
+ * @param depth Массив глубин или NULL.
+ * @param front Битовая карта фронта.
+ * @param next Битовая карта следующего фронта (обнулена).
+ * @param level Глубина вершин следующего фронта.
+ * @return Размер следующего фронта.
+ */
+static int bottom_up_step(const CsrGraph* in, int* parent, int* depth, const uint64_t* front, uint64_t* next,
+                          int level) {
+    int awake = 0;
+
+    for (int v = 0; v < in->num_nodes; v++) {
+        if (parent[v] >= 0) continue;
+
+        for (size_t j = in->offsets[v]; j < in->offsets[v + 1]; j++) {
+            int u = in->targets[j];
+
+            if (front[u >> 6] & (1ULL << (u & 63))) {
+                parent[v] = u;
+                if (depth) depth[v] = level;
+                next[v >> 6] |= 1ULL << (v & 63);
+                awake++;
+                break;
+            }
+        }
+    }
+
+    return awake;
+}
+
+/**
+ * @brief Ожидает на барьере всех участников.
+ * @param barrier Указатель на барьер.
+ * @return 1 для последнего пришедшего потока (он может выполнить общую работу между фазами), иначе 0.
+ */
+static int barrier_wait(GraphBarrier* barrier) {
+    pthread_mutex_lock(&barrier->lock);
+
+    unsigned generation = barrier->generation;
+
+    if (++barrier->waiting == barrier->parties) {
+        barrier->waiting = 0;
+        barrier->generation++;
+        pthread_cond_broadcast(&barrier->changed);
+        pthread_mutex_unlock(&barrier->lock);
+        return 1;
+    }
+
+    while (generation == barrier->generation) pthread_cond_wait(&barrier->changed, &barrier->lock);
+
+    pthread_mutex_unlock(&barrier->lock);
+
+    return 0;
+}
+
+/**
+ * @brief Запускает worker в threads потоках, включая вызывающий, и ждёт их завершения.
+ * @details Первым делом worker должен пройти барьер: число участников известно только
+ * после запуска потоков, и если какой-то поток не создался, работают оставшиеся.
+ * @param threads Количество потоков (0 - по числу процессоров).
+ * @param worker Функция потока.
+ * @param job Общее состояние.
+ * @param barrier Барьер из состояния job.
+ */
+static void parallel_run(int threads, void* (*worker)(void*), void* job, GraphBarrier* barrier) {
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 0) threads = 1;
+
+    pthread_t* workers = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    int started = 0;
+
+    while (workers && started < threads - 1 && pthread_create(&workers[started], NULL, worker, job) == 0) started++;
+
+    pthread_mutex_lock(&barrier->lock);
+    barrier->parties = started + 1;
+    pthread_mutex_unlock(&barrier->lock);
+
+    worker(job);
+
+    for (int i = 0; i < started; i++) pthread_join(workers[i], NULL);
+
+    free(workers);
+}
+
+/**
+ * @brief Поток параллельного BFS: обрабатывает уровни, пока фронт не опустеет.
+ * @param argument Указатель на ParallelBfs.
+ * @return NULL.
+ */
+static void* bfs_worker(void* argument) {
+    ParallelBfs* job = (ParallelBfs*)argument;
+    const CsrGraph* csr = job->csr;
+    int local[PARALLEL_LOCAL_QUEUE];
+    int local_size = 0;
+
+    barrier_wait(&job->barrier);
+
+    while (job->frontier_size > 0) {
+        size_t size = (size_t)job->frontier_size, begin;
+
+        while ((begin = __atomic_fetch_add(&job->cursor, PARALLEL_CHUNK, __ATOMIC_RELAXED)) < size) {
+            size_t end = begin + PARALLEL_CHUNK < size ? begin + PARALLEL_CHUNK : size;
+
+            for (size_t i = begin; i < end; i++) {
+                int current = job->frontier[i];
+
+                for (size_t j = csr->offsets[current]; j < csr->offsets[current + 1]; j++) {
+                    int neighbor = csr->targets[j];
+                    uint64_t* word = &job->visited[neighbor >> 6];
+                    uint64_t bit = 1ULL << (neighbor & 63);
+
+                    // Обычное чтение отсеивает посещённые без дорогой атомарной записи
+                    if (__atomic_load_n(word, __ATOMIC_RELAXED) & bit) continue;
+                    if (__atomic_fetch_or(word, bit, __ATOMIC_RELAXED) & bit) continue;
+
+                    job->parent[neighbor] = current;
+                    if (job->depth) job->depth[neighbor] = job->level + 1;
+
+                    if (local_size == PARALLEL_LOCAL_QUEUE) {
+                        int at = __atomic_fetch_add(&job->next_size, local_size, __ATOMIC_RELAXED);
+
+                        memcpy(job->next + at, local, local_size * sizeof(int));
+                        local_size = 0;
+                    }
+
+                    local[local_size++] = neighbor;
+                }
+            }
+        }
+
+        int at = __atomic_fetch_add(&job->next_size, local_size, __ATOMIC_RELAXED);
+
+        memcpy(job->next + at, local, local_size * sizeof(int));
+        local_size = 0;
+
+        // Последний пришедший поток меняет фронты местами
+        if (barrier_wait(&job->barrier)) {
+            int* temp = job->frontier;
+
+            job->frontier = job->next;
+            job->next = temp;
+            job->frontier_size = job->next_size;
+            job->next_size = 0;
+            job->cursor = 0;
+            job->level++;
+        }
+
+        barrier_wait(&job->barrier);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Связывает компоненты вершин u и v: корень с большим номером подвешивается к меньшему.
+ * @param component Массив меток, изменяется атомарно.
+ */
+static void components_link(int* component, int u, int v) {
+    int p1 = __atomic_load_n(&component[u], __ATOMIC_RELAXED);
+    int p2 = __atomic_load_n(&component[v], __ATOMIC_RELAXED);
+
+    while (p1 != p2) {
+        int high = p1 > p2 ? p1 : p2;
+        int low = p1 + p2 - high;
+        int p_high = __atomic_load_n(&component[high], __ATOMIC_RELAXED);
+
+        if (p_high == low) break;
+
+        if (p_high == high && __atomic_compare_exchange_n(&component[high], &p_high, low, 0, __ATOMIC_RELAXED,
+                                                          __ATOMIC_RELAXED))
+            break;
+
+        p1 = __atomic_load_n(&component[__atomic_load_n(&component[high], __ATOMIC_RELAXED)], __ATOMIC_RELAXED);
+        p2 = __atomic_load_n(&component[low], __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief Берёт следующую порцию вершин фазы.
+ * @return Начало порции; конец - не дальше begin + PARALLEL_CHUNK и num_nodes.
+ */
+static size_t components_next(ParallelComponents* job) {
+    return __atomic_fetch_add(&job->cursor, PARALLEL_CHUNK, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Завершает фазу: все потоки дошли до барьера, счётчик порций сброшен.
+ * @return 1 для потока, который выполняет общую работу перед следующей фазой.
+ */
+static int components_phase_end(ParallelComponents* job) {
+    int last = barrier_wait(&job->barrier);
+
+    if (last) job->cursor = 0;
+
+    return last;
+}
+
+/**
+ * @brief Сжатие путей: каждая метка заменяется корнем своего дерева.
+ */
+static void components_compress(ParallelComponents* job) {
+    size_t n = (size_t)job->out->num_nodes, begin;
+
+    while ((begin = components_next(job)) < n) {
+        for (size_t v = begin; v < n && v < begin + PARALLEL_CHUNK; v++) {
+            int label = __atomic_load_n(&job->component[v], __ATOMIC_RELAXED);
+            int root = __atomic_load_n(&job->component[label], __ATOMIC_RELAXED);
+
+            while (label != root) {
+                label = root;
+                root = __atomic_load_n(&job->component[label], __ATOMIC_RELAXED);
+            }
+
+            __atomic_store_n(&job->component[v], label, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * @brief Сравнение целых чисел для qsort.
+ */
+static int compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Поток поиска компонент: фазы связывания и сжатия, разделённые барьером.
+ * @param argument Указатель на ParallelComponents.
+ * @return NULL.
+ */
+static void* components_worker(void* argument) {
+    ParallelComponents* job = (ParallelComponents*)argument;
+    const CsrGraph* out = job->out;
+    size_t n = (size_t)out->num_nodes, begin;
+
+    barrier_wait(&job->barrier);
+
+    // Первые соседи каждой вершины: почти все вершины попадают в большие деревья
+    for (int round = 0; round < AFFOREST_ROUNDS; round++) {
+        while ((begin = components_next(job)) < n) {
+            for (size_t u = begin; u < n && u < begin + PARALLEL_CHUNK; u++)
+                if (out->offsets[u] + round < out->offsets[u + 1])
+                    components_link(job->component, (int)u, out->targets[out->offsets[u] + round]);
+        }
+
+        components_phase_end(job);
+        barrier_wait(&job->barrier);
+        components_compress(job);
+        components_phase_end(job);
+        barrier_wait(&job->barrier);
+    }
+
+    // Самая частая метка в выборке - почти наверняка самая большая компонента
+    if (job->in && n > 0 && barrier_wait(&job->barrier)) {
+        int* labels = (int*)malloc(AFFOREST_SAMPLES * sizeof(int));
+        unsigned long long state = 88172645463325252ULL;
+        int best = 0;
+
+        for (int i = 0; labels && i < AFFOREST_SAMPLES; i++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            labels[i] = job->component[state % n];
+        }
+
+        if (labels) qsort(labels, AFFOREST_SAMPLES, sizeof(int), compare_ints);
+
+        for (int i = 0, run = 0; labels && i < AFFOREST_SAMPLES; i++) {
+            run++;
+
+            if (i + 1 < AFFOREST_SAMPLES && labels[i + 1] == labels[i]) continue;
+
+            if (run > best) {
+                best = run;
+                job->frequent = labels[i];
+            }
+
+            run = 0;
+        }
+
+        free(labels);
+    }
+
+    if (job->in && n > 0) barrier_wait(&job->barrier);
+
+    // Остальные рёбра; вершины самой большой компоненты пропускаются, их рёбра видны с другой стороны
+    while ((begin = components_next(job)) < n) {
+        for (size_t u = begin; u < n && u < begin + PARALLEL_CHUNK; u++) {
+            if (__atomic_load_n(&job->component[u], __ATOMIC_RELAXED) == job->frequent) continue;
+
+            for (size_t j = out->offsets[u] + AFFOREST_ROUNDS; j < out->offsets[u + 1]; j++)
+                components_link(job->component, (int)u, out->targets[j]);
+
+            if (job->in && job->in != out)
+                for (size_t j = job->in->offsets[u]; j < job->in->offsets[u + 1]; j++)
+                    components_link(job->component, (int)u, job->in->targets[j]);
+        }
+    }
+
+    components_phase_end(job);
+    barrier_wait(&job->barrier);
+    components_compress(job);
+
+    return NULL;
+}
+
+#ifdef GRAPH_BENCHMARK
+/*
+ * Бенчмарки. Сборка: gcc -O2 -DGRAPH_BENCHMARK graph.c -o graph,
+ * запуск: ./graph --bench <имя> [параметры].
+ */
+
+/**
+ * @brief Текущее время монотонных часов в секундах.
+ */
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Генератор псевдослучайных чисел xorshift64.
+ */
+static unsigned long long bench_random(unsigned long long* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+
+    return *state;
+}
+
+/**
+ * @brief Случайный ориентированный граф с равномерно выбранными концами рёбер.
+ * @param num_nodes Количество вершин.
+ * @param num_edges Количество рёбер.
+ * @return Массив рёбер или NULL при ошибке выделения памяти.
+ */
+static GraphEdge* bench_uniform_edges(int num_nodes, size_t num_edges) {
+    GraphEdge* edges = (GraphEdge*)malloc(num_edges * sizeof(GraphEdge));
+    unsigned long long state = 88172645463325252ULL;
+
+    for (size_t i = 0; edges && i < num_edges; i++) {
+        edges[i].src = (int)(bench_random(&state) % num_nodes);
+        edges[i].dest = (int)(bench_random(&state) % num_nodes);
+    }
+
+    return edges;
+}
+
+/**
+ * @brief Количество рёбер, просмотренных обходом: сумма степеней посещённых вершин.
+ */
+static size_t bench_scanned_edges(const CsrGraph* csr, const int* order, int count) {
+    size_t scanned = 0;
+
+    for (int i = 0; i < count; i++) scanned += csr->offsets[order[i] + 1] - csr->offsets[order[i]];
+
+    return scanned;
+}
+
+/**
+ * @brief Счётчики событий для проверки обработчиков GraphVisitor.
+ */
+typedef struct BenchCounts {
+    long discovered; /**< Вызовов on_discover */
+    long finished;   /**< Вызовов on_finish */
+    long edges;      /**< Вызовов on_edge */
+    long tree_edges; /**< Из них рёбер дерева */
+} BenchCounts;
+
+static void bench_count_discover(int vertex, int parent, void* context) {
+    (void)vertex;
+    (void)parent;
+    ((BenchCounts*)context)->discovered++;
+}
+
+static void bench_count_finish(int vertex, void* context) {
+    (void)vertex;
+    ((BenchCounts*)context)->finished++;
+}
+
+static void bench_count_edge(int src, int dest, int tree_edge, void* context) {
+    (void)src;
+    (void)dest;
+    ((BenchCounts*)context)->edges++;
+    ((BenchCounts*)context)->tree_edges += tree_edge;
+}
+
+/**
+ * @brief Обработчик on_discover, печатающий вершину в файл, как прежние dfs и bfs печатали в stdout.
+ */
+static void bench_print_discover(int vertex, int parent, void* context) {
+    (void)parent;
+    fprintf((FILE*)context, "%d ", vertex);
+}
+
+/**
+ * @brief Проверяет массивы обхода пути 0 -> 1 -> ... -> n - 1 из вершины 0.
+ * @return 1, если массивы верны.
+ */
+static int bench_check_path(int num_nodes, const GraphTraversal* traversal, int count, int is_dfs) {
+    if (count != num_nodes) return 0;
+
+    for (int i = 0; i < num_nodes; i++) {
+        // DFS открывает весь путь и закрывает его с конца; BFS открывает i + 1 перед закрытием i
+        int discovery = is_dfs ? i : (i ? 2 * i - 1 : 0);
+        int finish = is_dfs ? 2 * num_nodes - 1 - i : (2 * i + 2 < 2 * num_nodes - 1 ? 2 * i + 2 : 2 * num_nodes - 1);
+
+        if (traversal->order[i] != i || traversal->parent[i] != (i ? i - 1 : 0) || traversal->depth[i] != i ||
+            traversal->discovery[i] != discovery || traversal->finish[i] != finish)
+            return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief dfs_visit и bfs_visit на пути и на случайном графе.
+ * @details ./graph --bench traversal [вершины], по умолчанию 1000000. Путь 0 -> 1 -> ... проверяет,
+ * что глубина DFS не ограничена стеком вызовов (рекурсивный dfs на нём переполнял стек), и
+ * сверяет все выходные массивы. На случайном графе со средней степенью 8 сравниваются
+ * только массивы, подсчитывающие обработчики и печать каждой вершины в /dev/null.
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void bench_traversal(int argc, char** argv) {
+    int num_nodes = argc > 0 ? atoi(argv[0]) : 1000000;
+    size_t num_edges = (size_t)num_nodes * 8;
+    Graph* path = create_graph(num_nodes);
+    Graph* random = create_graph(num_nodes);
+    GraphEdge* edges = bench_uniform_edges(num_nodes, num_edges);
+    int* arrays = (int*)malloc((size_t)num_nodes * 5 * sizeof(int));
+    FILE* sink = fopen("/dev/null", "w");
+    int ok = 1;
+
+    if (num_nodes < 1 || !path || !random || !edges || !arrays || !sink) {
+        printf("not enough memory\n");
+        destroy_graph(path);
+        destroy_graph(random);
+        free(edges);
+        free(arrays);
+        if (sink) fclose(sink);
+        return;
+    }
+
+    GraphTraversal traversal = {arrays, arrays + num_nodes, arrays + 2 * (size_t)num_nodes,
+                                arrays + 3 * (size_t)num_nodes, arrays + 4 * (size_t)num_nodes};
+
+    for (int i = 1; i < num_nodes; i++) add_edge(path, i - 1, i);
+    for (size_t i = 0; i < num_edges; i++) add_edge(random, edges[i].src, edges[i].dest);
+
+    free(edges);
+
+    for (int pass = 0; pass < 2; pass++) {
+        int (*visit)(const Graph*, int, const GraphVisitor*, GraphTraversal*) = pass ? bfs_visit : dfs_visit;
+        const char* name = pass ? "bfs" : "dfs";
+
+        double start = bench_now();
+        int count = visit(path, 0, NULL, &traversal);
+        double elapsed = bench_now() - start;
+        int path_ok = bench_check_path(num_nodes, &traversal, count, !pass);
+
+        ok &= path_ok;
+        printf("%s path of %d vertices: %d visited, %.1f ms, arrays %s\n", name, num_nodes, count, elapsed * 1e3,
+               path_ok ? "ok" : "WRONG");
+
+        GraphTraversal order_only = {arrays, NULL, NULL, NULL, NULL};
+        BenchCounts counts = {0, 0, 0, 0};
+        GraphVisitor counter = {bench_count_discover, bench_count_finish, bench_count_edge, &counts};
+        GraphVisitor printer = {bench_print_discover, NULL, NULL, sink};
+
+        start = bench_now();
+        count = visit(random, 0, NULL, &order_only);
+        double order_time = bench_now() - start;
+
+        start = bench_now();
+        int full_count = visit(random, 0, NULL, &traversal);
+        double full_time = bench_now() - start;
+
+        start = bench_now();
+        int counted = visit(random, 0, &counter, NULL);
+        double counter_time = bench_now() - start;
+
+        start = bench_now();
+        int printed = visit(random, 0, &printer, NULL);
+        fflush(sink);
+        double print_time = bench_now() - start;
+
+        long tree_edges = 0;
+
+        for (int i = 0; i < num_nodes; i++) tree_edges += traversal.parent[i] >= 0 && i != 0;
+
+        int random_ok = full_count == count && counted == count && printed == count && counts.discovered == count &&
+                        counts.finished == count && counts.tree_edges == count - 1 && tree_edges == count - 1;
+
+        ok &= random_ok;
+        printf("%s random, %d vertices reached: order %.1f ms, all arrays %.1f ms, counting visitor %.1f ms, "
+               "printf visitor %.1f ms  %s\n", name, count, order_time * 1e3, full_time * 1e3, counter_time * 1e3,
+               print_time * 1e3, random_ok ? "ok" : "WRONG");
+    }
+
+    destroy_graph(path);
+    destroy_graph(random);
+    free(arrays);
+    fclose(sink);
+
+    printf("check: %s\n", ok ? "ok" : "FAILED");
+}
+
+/**
+ * @brief Обход списков смежности против CSR на случайных графах.
+ * @details ./graph --bench csr [млн рёбер], по умолчанию 100: графы с 1, 10, 100, ... млн рёбер
+ * (не больше заданного) и средней степенью 8. Скорость - миллионы просмотренных рёбер в секунду.
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void bench_csr(int argc, char** argv) {
+    long max_millions = argc > 0 ? atol(argv[0]) : 100;
+    int all_same = 1;
+
+    for (long millions = 1; millions <= max_millions; millions *= 10) {
+        size_t num_edges = (size_t)millions * 1000000;
+        int num_nodes = (int)(num_edges / 8);
+        GraphEdge* edges = bench_uniform_edges(num_nodes, num_edges);
+        Graph* graph = create_graph(num_nodes);
+        int* order = (int*)malloc(num_nodes * sizeof(int));
+        int* csr_order = (int*)malloc(num_nodes * sizeof(int));
+
+        if (!edges || !graph || !order || !csr_order) {
+            printf("%ldM edges: not enough memory\n", millions);
+            free(edges);
+            destroy_graph(graph);
+            free(order);
+            free(csr_order);
+            break;
+        }
+
+        double start = bench_now();
+
+        for (size_t i = 0; i < num_edges; i++) add_edge(graph, edges[i].src, edges[i].dest);
+
+        double list_build = bench_now() - start;
+
+        start = bench_now();
+        CsrGraph* from_graph = csr_from_graph(graph);
+        double graph_build = bench_now() - start;
+
+        start = bench_now();
+        CsrGraph* from_edges = csr_from_edges(num_nodes, edges, num_edges);
+        double edges_build = bench_now() - start;
+
+        free(edges);
+
+        if (!from_graph || !from_edges) {
+            printf("%ldM edges: not enough memory\n", millions);
+            csr_destroy(from_graph);
+            csr_destroy(from_edges);
+            destroy_graph(graph);
+            free(order);
+            free(csr_order);
+            break;
+        }
+
+        printf("%ldM edges, %d vertices: add_edge %.0f ms, csr_from_graph %.0f ms, csr_from_edges %.0f ms\n",
+               millions, num_nodes, list_build * 1e3, graph_build * 1e3, edges_build * 1e3);
+
+        for (int pass = 0; pass < 2; pass++) {
+            const char* name = pass ? "dfs" : "bfs";
+
+            start = bench_now();
+            GraphTraversal traversal = {order, NULL, NULL, NULL, NULL};
+            int count = pass ? dfs_visit(graph, 0, NULL, &traversal) : bfs_visit(graph, 0, NULL, &traversal);
+            double list_time = bench_now() - start;
+
+            start = bench_now();
+            int csr_count = pass ? csr_dfs(from_graph, 0, csr_order) : csr_bfs(from_graph, 0, csr_order);
+            double csr_time = bench_now() - start;
+
+            // Тот же порядок соседей - тот же порядок обхода; у csr_from_edges порядок другой, но не множество
+            int same = count == csr_count && memcmp(order, csr_order, count * sizeof(int)) == 0;
+
+            start = bench_now();
+            int edges_count = pass ? csr_dfs(from_edges, 0, csr_order) : csr_bfs(from_edges, 0, csr_order);
+            double edges_time = bench_now() - start;
+
+            same &= edges_count == count;
+            all_same &= same;
+
+            double scanned = (double)bench_scanned_edges(from_graph, order, count);
+
+            printf("  %s %d vertices: list %7.1f  csr %7.1f  csr_from_edges %7.1f Medges/s  %s\n", name, count,
+                   scanned / list_time * 1e-6, scanned / csr_time * 1e-6, scanned / edges_time * 1e-6,
+                   same ? "same" : "DIFFERENT");
+        }
+
+        csr_destroy(from_graph);
+        csr_destroy(from_edges);
+        destroy_graph(graph);
+        free(order);
+        free(csr_order);
+    }
+
+    printf("check: %s\n", all_same ? "ok" : "FAILED");
+}
+
+/**
+ * @brief Граф R-MAT (a = 0.57, b = c = 0.19) с перемешанными номерами вершин, как в Graph500.
+ * @param scale Вершин 2^scale.
+ * @param num_edges Количество сгенерированных рёбер.
+ * @param symmetric 1 - добавить к каждому ребру обратное (неориентированный граф, 2 * num_edges рёбер).
+ * @return Массив рёбер или NULL при ошибке выделения памяти.
+ */
+static GraphEdge* bench_rmat_edges(int scale, size_t num_edges, int symmetric) {
+    int num_nodes = 1 << scale;
+    GraphEdge* edges = (GraphEdge*)malloc(num_edges * (symmetric ? 2 : 1) * sizeof(GraphEdge));
+    int* label = (int*)malloc(num_nodes * sizeof(int));
+    unsigned long long state = 88172645463325252ULL;
+
+    if (!edges || !label) {
+        free(edges);
+        free(label);
+        return NULL;
+    }
+
+    for (int i = 0; i < num_nodes; i++) label[i] = i;
+
+    for (int i = num_nodes - 1; i > 0; i--) {
+        int j = (int)(bench_random(&state) % (i + 1));
+        int temp = label[i];
+
+        label[i] = label[j];
+        label[j] = temp;
+    }
+
+    for (size_t i = 0; i < num_edges; i++) {
+        int src = 0, dest = 0;
+
+        for (int bit = 0; bit < scale; bit++) {
+            unsigned r = (unsigned)(bench_random(&state) % 100);
+
+            src = src << 1 | (r >= 76);
+            dest = dest << 1 | (r >= 57 && r < 76) | (r >= 95);
+        }
+
+        edges[i].src = label[src];
+        edges[i].dest = label[dest];
+
+        if (symmetric) {
+            edges[num_edges + i].src = label[dest];
+            edges[num_edges + i].dest = label[src];
+        }
+    }
+
+    free(label);
+
+    return edges;
+}
+
+/**
+ * @brief Проверяет результат BFS: глубины согласованы с рёбрами, родитель - сосед на уровень выше.
+ * @param out CSR-граф.
+ * @param in Транспонированный граф.
+ * @param start Начальная вершина.
+ * @param parent Массив родителей.
+ * @param depth Массив глубин.
+ * @param reached Количество достижимых вершин по другому обходу.
+ * @return 1, если дерево обхода корректно.
+ */
+static int bench_check_bfs(const CsrGraph* out, const CsrGraph* in, int start, const int* parent, const int* depth,
+                           int reached) {
+    int count = 0;
+
+    if (parent[start] != start || depth[start] != 0) return 0;
+
+    for (int v = 0; v < out->num_nodes; v++) {
+        if (parent[v] < 0) continue;
+
+        count++;
+
+        // Рёбра из достижимой вершины ведут в достижимые, не дальше чем на уровень вниз
+        for (size_t j = out->offsets[v]; j < out->offsets[v + 1]; j++) {
+            int u = out->targets[j];
+
+            if (parent[u] < 0 || depth[u] > depth[v] + 1) return 0;
+        }
+
+        if (v == start) continue;
+
+        int found = 0;
+
+        for (size_t j = in->offsets[v]; j < in->offsets[v + 1] && !found; j++) found = in->targets[j] == parent[v];
+
+        if (!found || depth[parent[v]] != depth[v] - 1) return 0;
+    }
+
+    return count == reached;
+}
+
+/**
+ * @brief BFS с выбором направления против обхода сверху вниз на графах R-MAT.
+ * @details ./graph --bench dobfs [scale] [рёбер на вершину], по умолчанию 20 и 16:
+ * неориентированный граф с 2^scale вершинами, 16 случайных стартовых вершин.
+ * TEPS - рёбра, исходящие из достижимых вершин, в секунду; числитель у всех обходов общий.
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void bench_dobfs(int argc, char** argv) {
+    int scale = argc > 0 ? atoi(argv[0]) : 20;
+    int edge_factor = argc > 1 ? atoi(argv[1]) : 16;
+    int num_nodes = 1 << scale;
+    size_t num_edges = (size_t)edge_factor << scale;
+    int all_valid = 1;
+
+    // Ориентированный граф поменьше: обход снизу вверх по транспонированному графу
+    int small_scale = scale > 14 ? 14 : scale;
+    int small_nodes = 1 << small_scale;
+    GraphEdge* edges = bench_rmat_edges(small_scale, (size_t)edge_factor << small_scale, 0);
+    CsrGraph* directed = edges ? csr_from_edges(small_nodes, edges, (size_t)edge_factor << small_scale) : NULL;
+    CsrGraph* transposed = directed ? csr_transpose(directed) : NULL;
+    int* parent = (int*)malloc(num_nodes * sizeof(int));
+    int* depth = (int*)malloc(num_nodes * sizeof(int));
+    int* order = (int*)malloc(num_nodes * sizeof(int));
+
+    free(edges);
+
+    if (!transposed || !parent || !depth || !order) {
+        printf("not enough memory\n");
+        csr_destroy(directed);
+        csr_destroy(transposed);
+        free(parent);
+        free(depth);
+        free(order);
+        return;
+    }
+
+    for (int root = 0; root < small_nodes; root += small_nodes > 8 ? small_nodes / 8 : 1) {
+        csr_bfs_direction_optimizing(directed, transposed, root, parent, depth);
+        all_valid &= bench_check_bfs(directed, transposed, root, parent, depth, csr_bfs(directed, root, order));
+    }
+
+    csr_destroy(directed);
+    csr_destroy(transposed);
+
+    // Неориентированный граф: обратные рёбра добавлены, in = out
+    edges = bench_rmat_edges(scale, num_edges, 1);
+
+    CsrGraph* csr = edges ? csr_from_edges(num_nodes, edges, 2 * num_edges) : NULL;
+    Graph* graph = csr ? create_graph(num_nodes) : NULL;
+
+    for (size_t i = 0; graph && i < 2 * num_edges; i++) add_edge(graph, edges[i].src, edges[i].dest);
+
+    free(edges);
+
+    if (!graph) {
+        printf("not enough memory\n");
+        csr_destroy(csr);
+        free(parent);
+        free(depth);
+        free(order);
+        return;
+    }
+
+    double list_time = 0, csr_time = 0, dobfs_time = 0, traversed = 0;
+    unsigned long long state = 42;
+    int roots = 0;
+
+    printf("R-MAT scale %d, edge factor %d: %d vertices, %zu directed edges\n", scale, edge_factor, num_nodes,
+           csr->num_edges);
+
+    while (roots < 16) {
+        int root = (int)(bench_random(&state) % num_nodes);
+
+        if (csr->offsets[root + 1] == csr->offsets[root]) continue;
+
+        double start = bench_now();
+        GraphTraversal traversal = {order, NULL, NULL, NULL, NULL};
+        int list_count = bfs_visit(graph, root, NULL, &traversal);
+        list_time += bench_now() - start;
+
+        start = bench_now();
+        int csr_count = csr_bfs(csr, root, order);
+        csr_time += bench_now() - start;
+
+        start = bench_now();
+        int count = csr_bfs_direction_optimizing(csr, csr, root, parent, depth);
+        dobfs_time += bench_now() - start;
+
+        all_valid &= list_count == count && bench_check_bfs(csr, csr, root, parent, depth, csr_count);
+        traversed += (double)bench_scanned_edges(csr, order, csr_count);
+        roots++;
+    }
+
+    printf("bfs (linked lists)            %8.1f MTEPS\n", traversed / list_time * 1e-6);
+    printf("csr_bfs (top-down)            %8.1f MTEPS\n", traversed / csr_time * 1e-6);
+    printf("csr_bfs_direction_optimizing  %8.1f MTEPS\n", traversed / dobfs_time * 1e-6);
+    printf("check: %s\n", all_valid ? "ok" : "FAILED");
+
+    csr_destroy(csr);
+    destroy_graph(graph);
+    free(parent);
+    free(depth);
+    free(order);
+}
+
+/**
+ * @brief Компоненты связности обходами csr_bfs по возрастанию номеров: метка - наименьшая вершина.
+ * @param symmetric Неориентированный CSR-граф.
+ * @param component Массив меток.
+ * @param order Рабочий массив из num_nodes элементов.
+ * @return Количество компонент.
+ */
+static int bench_reference_components(const CsrGraph* symmetric, int* component, int* order) {
+    int count = 0;
+
+    for (int v = 0; v < symmetric->num_nodes; v++) component[v] = -1;
+
+    for (int v = 0; v < symmetric->num_nodes; v++) {
+        if (component[v] >= 0) continue;
+
+        int reached = csr_bfs(symmetric, v, order);
+
+        for (int i = 0; i < reached; i++) component[order[i]] = v;
+
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Сильная масштабируемость параллельных BFS и поиска компонент на графе R-MAT.
+ * @details ./graph --bench parallel [scale] [потоков], по умолчанию 20 и 64: неориентированный
+ * граф с 2^scale вершинами и 16 рёбрами на вершину, построенный add_edge и обходимый через
+ * csr_from_graph; потоки 1, 2, 4, ... до заданного числа. Перед замерами - проверка на
+ * ориентированном графе через обёртки bfs_parallel и connected_components.
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void bench_parallel(int argc, char** argv) {
+    int scale = argc > 0 ? atoi(argv[0]) : 20;
+    int max_threads = argc > 1 ? atoi(argv[1]) : 64;
+    int num_nodes = 1 << scale;
+    size_t num_edges = (size_t)16 << scale;
+    int* parent = (int*)malloc(num_nodes * sizeof(int));
+    int* depth = (int*)malloc(num_nodes * sizeof(int));
+    int* order = (int*)malloc(num_nodes * sizeof(int));
+    int* component = (int*)malloc(num_nodes * sizeof(int));
+    int* reference = (int*)malloc(num_nodes * sizeof(int));
+    int all_valid = 1;
+
+    // Ориентированный граф поменьше: слабые компоненты, обёртки над Graph
+    int small_scale = scale > 14 ? 14 : scale;
+    int small_nodes = 1 << small_scale;
+    size_t small_edges = (size_t)4 << small_scale;
+    GraphEdge* edges = bench_rmat_edges(small_scale, small_edges, 1);
+    Graph* graph = edges ? create_graph(small_nodes) : NULL;
+    CsrGraph* symmetric = edges ? csr_from_edges(small_nodes, edges, 2 * small_edges) : NULL;
+
+    for (size_t i = 0; graph && i < small_edges; i++) add_edge(graph, edges[i].src, edges[i].dest);
+
+    free(edges);
+
+    CsrGraph* directed = graph ? csr_from_graph(graph) : NULL;
+    CsrGraph* transposed = directed ? csr_transpose(directed) : NULL;
+
+    if (!transposed || !symmetric || !parent || !depth || !order || !component || !reference) {
+        printf("not enough memory\n");
+        all_valid = 0;
+    } else {
+        int expected = bench_reference_components(symmetric, reference, order);
+
+        for (int threads = 1; threads <= 4; threads++) {
+            all_valid &= connected_components(graph, component, threads) == expected &&
+                         memcmp(component, reference, small_nodes * sizeof(int)) == 0;
+            all_valid &= csr_connected_components(directed, NULL, component, threads) == expected &&
+                         memcmp(component, reference, small_nodes * sizeof(int)) == 0;
+
+            for (int root = 0; root < small_nodes; root += small_nodes > 4 ? small_nodes / 4 : 1) {
+                bfs_parallel(graph, root, parent, depth, threads);
+                all_valid &= bench_check_bfs(directed, transposed, root, parent, depth, csr_bfs(directed, root, order));
+            }
+        }
+    }
+
+    destroy_graph(graph);
+    csr_destroy(directed);
+    csr_destroy(transposed);
+    csr_destroy(symmetric);
+
+    // Неориентированный граф для замеров
+    edges = all_valid ? bench_rmat_edges(scale, num_edges, 1) : NULL;
+    graph = edges ? create_graph(num_nodes) : NULL;
+
+    for (size_t i = 0; graph && i < 2 * num_edges; i++) add_edge(graph, edges[i].src, edges[i].dest);
+
+    free(edges);
+
+    double start = bench_now();
+    CsrGraph* csr = graph ? csr_from_graph(graph) : NULL;
+    double view_time = bench_now() - start;
+
+    if (csr) {
+        int expected = bench_reference_components(csr, reference, order);
+        int roots[8];
+        double traversed = 0, base_bfs = 0, base_cc = 0;
+        unsigned long long state = 42;
+
+        for (int i = 0; i < 8;) {
+            roots[i] = (int)(bench_random(&state) % num_nodes);
+
+            if (csr->offsets[roots[i] + 1] > csr->offsets[roots[i]])
+                traversed += (double)bench_scanned_edges(csr, order, csr_bfs(csr, roots[i++], order));
+        }
+
+        printf("R-MAT scale %d: %d vertices, %zu directed edges, %d components, csr_from_graph %.0f ms\n", scale,
+               num_nodes, csr->num_edges, expected, view_time * 1e3);
+
+        for (int threads = 1; threads <= max_threads; threads *= 2) {
+            start = bench_now();
+
+            int reached = 0;
+
+            for (int i = 0; i < 8; i++) reached = csr_bfs_parallel(csr, roots[i], parent, depth, threads);
+
+            double bfs_time = bench_now() - start;
+
+            all_valid &= bench_check_bfs(csr, csr, roots[7], parent, depth, reached);
+
+            start = bench_now();
+            int count = csr_connected_components(csr, csr, component, threads);
+            double cc_time = bench_now() - start;
+
+            all_valid &= count == expected && memcmp(component, reference, num_nodes * sizeof(int)) == 0;
+
+            if (threads == 1) {
+                base_bfs = bfs_time;
+                base_cc = cc_time;
+            }
+
+            printf("%3d threads: bfs %8.1f MTEPS (x%.2f), components %7.1f ms (x%.2f)\n", threads,
+                   traversed / bfs_time * 1e-6, base_bfs / bfs_time, cc_time * 1e3, base_cc / cc_time);
+        }
+    } else if (all_valid) {
+        printf("not enough memory\n");
+    }
+
+    printf("check: %s\n", all_valid ? "ok" : "FAILED");
+
+    csr_destroy(csr);
+    destroy_graph(graph);
+    free(parent);
+    free(depth);
+    free(order);
+    free(component);
+    free(reference);
+}
+
+/**
+ * @brief add_edge без хеш-множеств: повтор ищется по всему списку, O(степень).
+ */
+static GraphError bench_list_add_edge(Graph* graph, int src, int dest) {
+    for (Node* temp = graph->adj_list[src]; temp; temp = temp->next)
+        if (temp->node == dest) return GRAPH_ERR_EDGE_EXISTS;
+
+    Node* new_node = create_node(dest);
+
+    if (!new_node) return GRAPH_ERR_MEMORY;
+
+    new_node->next = graph->adj_list[src];
+    graph->adj_list[src] = new_node;
+
+    return GRAPH_SUCCESS;
+}
+
+/**
+ * @brief has_edge без хеш-множеств, O(степень).
+ */
+static int bench_list_has_edge(const Graph* graph, int src, int dest) {
+    for (Node* temp = graph->adj_list[src]; temp; temp = temp->next)
+        if (temp->node == dest) return 1;
+
+    return 0;
+}
+
+/**
+ * @brief remove_edge без хеш-множеств, O(степень).
+ */
+static GraphError bench_list_remove_edge(Graph* graph, int src, int dest) {
+    Node** link = &graph->adj_list[src];
+
+    while (*link && (*link)->node != dest) link = &(*link)->next;
+
+    if (!*link) return GRAPH_ERR_EDGE_NOT_FOUND;
+
+    Node* temp = *link;
+
+    *link = temp->next;
+    free(temp);
+
+    return GRAPH_SUCCESS;
+}
+
+/**
+ * @brief Операции с рёбрами на степенном распределении степеней: хеш-множества хабов против списков.
+ * @details ./graph --bench hubs [scale] [рёбер на вершину], по умолчанию 14 и 16: ориентированный
+ * граф R-MAT с 2^scale вершинами. Все рёбра (с повторами) добавляются, проверяются вместе с таким же
+ * числом случайных пар, затем удаляются в два приёма с проверкой между ними. Результаты каждой
+ * операции у обоих вариантов должны совпасть, после добавления - и CSR-представления.
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void bench_hubs(int argc, char** argv) {
+    int scale = argc > 0 ? atoi(argv[0]) : 14;
+    int edge_factor = argc > 1 ? atoi(argv[1]) : 16;
+    int num_nodes = 1 << scale;
+    size_t num_edges = (size_t)num_nodes * edge_factor;
+    GraphEdge* edges = bench_rmat_edges(scale, num_edges, 0);
+    GraphEdge* pairs = bench_uniform_edges(num_nodes, num_edges);
+    CsrGraph* csr[2] = {NULL, NULL};
+    size_t results[2][4];
+    int ok = 1;
+
+    if (!edges || !pairs) {
+        printf("not enough memory\n");
+        free(edges);
+        free(pairs);
+        return;
+    }
+
+    printf("R-MAT scale %d, edge factor %d: %d vertices, %zu edges with repeats\n", scale, edge_factor, num_nodes,
+           num_edges);
+
+    for (int pass = 0; pass < 2; pass++) {
+        GraphError (*add)(Graph*, int, int) = pass ? add_edge : bench_list_add_edge;
+        int (*has)(const Graph*, int, int) = pass ? has_edge : bench_list_has_edge;
+        GraphError (*remove)(Graph*, int, int) = pass ? remove_edge : bench_list_remove_edge;
+        Graph* graph = create_graph(num_nodes);
+        size_t added = 0, found = 0, removed = 0, left = 0;
+
+        if (!graph) {
+            printf("not enough memory\n");
+            ok = 0;
+            break;
+        }
+
+        double start = bench_now();
+
+        for (size_t i = 0; i < num_edges; i++) added += add(graph, edges[i].src, edges[i].dest) == GRAPH_SUCCESS;
+
+        double add_time = bench_now() - start;
+
+        csr[pass] = csr_from_graph(graph);
+        start = bench_now();
+
+        for (size_t i = 0; i < num_edges; i++) {
+            found += has(graph, edges[i].src, edges[i].dest);
+            found += has(graph, pairs[i].src, pairs[i].dest);
+        }
+
+        double has_time = bench_now() - start;
+
+        start = bench_now();
+
+        for (size_t i = 0; i < num_edges / 2; i++)
+            removed += remove(graph, edges[i].src, edges[i].dest) == GRAPH_SUCCESS;
+
+        double remove_time = bench_now() - start;
+
+        for (size_t i = 0; i < num_edges; i++) left += has(graph, edges[i].src, edges[i].dest);
+
+        start = bench_now();
+
+        for (size_t i = num_edges / 2; i < num_edges; i++)
+            removed += remove(graph, edges[i].src, edges[i].dest) == GRAPH_SUCCESS;
+
+        remove_time += bench_now() - start;
+
+        int hubs = 0;
+
+        for (int i = 0; i < num_nodes; i++) {
+            ok &= graph->adj_list[i] == NULL && graph->hubs[i] == NULL;
+            hubs += pass && csr[pass] && csr[pass]->offsets[i + 1] - csr[pass]->offsets[i] >= GRAPH_HUB_DEGREE;
+        }
+
+        results[pass][0] = added;
+        results[pass][1] = found;
+        results[pass][2] = left;
+        results[pass][3] = removed;
+        ok &= removed == added;
+
+        printf("%-6s add %7.1f  has %7.1f  remove %7.1f ns/op", pass ? "hashed" : "list", add_time / num_edges * 1e9,
+               has_time / (2.0 * num_edges) * 1e9, remove_time / num_edges * 1e9);
+        if (pass) printf(", %d hubs", hubs);
+        printf("\n");
+
+        destroy_graph(graph);
+    }
+
+    if (csr[0] && csr[1]) {
+        size_t max_degree = 0;
+
+        for (int i = 0; i < num_nodes; i++)
+            if (csr[0]->offsets[i + 1] - csr[0]->offsets[i] > max_degree)
+                max_degree = csr[0]->offsets[i + 1] - csr[0]->offsets[i];
+
+        printf("%zu distinct edges, max out-degree %zu\n", csr[0]->num_edges, max_degree);
+        ok &= csr[0]->num_edges == csr[1]->num_edges &&
+              memcmp(csr[0]->offsets, csr[1]->offsets, ((size_t)num_nodes + 1) * sizeof(size_t)) == 0 &&
+              memcmp(csr[0]->targets, csr[1]->targets, csr[0]->num_edges * sizeof(int)) == 0;
+    } else {
+        ok = 0;
+    }
+
+    ok &= memcmp(results[0], results[1], sizeof(results[0])) == 0;
+
+    csr_destroy(csr[0]);
+    csr_destroy(csr[1]);
+    free(edges);
+    free(pairs);
+
+    printf("check: %s\n", ok ? "ok" : "FAILED");
+}
+
+/**
+ * @brief Запускает бенчмарк по имени.
+ * @return Код завершения.
+ */
+static int graph_benchmarks(int argc, char** argv) {
+    if (argc >= 1 && strcmp(argv[0], "csr") == 0) {
+        bench_csr(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "dobfs") == 0) {
+        bench_dobfs(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "parallel") == 0) {
+        bench_parallel(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "traversal") == 0) {
+        bench_traversal(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "hubs") == 0) {
+        bench_hubs(argc - 1, argv + 1);
+        return 0;
+    }
+
+    printf("Доступные бенчмарки: csr, dobfs, parallel, traversal, hubs\n");
+
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "--bench") == 0) return graph_benchmarks(argc - 2, argv + 2);
+
+    printf("Использование: %s --bench <имя> [параметры]\n", argv[0]);
+
+    return 1;
+}
+#endif
@@ -1,7 +1,23 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
 #include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
 
 /// @brief Коды ошибок для операций хеш-таблицы
 typedef enum {
@@ -9,33 +25,454 @@ typedef enum {
     HASH_TABLE_KEY_NOT_FOUND,    ///< Ошибка: ключ не найден
     HASH_TABLE_ALLOCATION_ERROR, ///< Ошибка: не удалось выделить память
     HASH_TABLE_ALREADY_EXISTS,   ///< Ошибка: ключ уже существует
-    HASH_TABLE_FULL              ///< Ошибка: таблица заполнена
+    HASH_TABLE_FULL,             ///< Ошибка: таблица заполнена
+    HASH_TABLE_INVALID_OPERATION, ///< Ошибка: операция недопустима для таблицы в текущем состоянии
+    HASH_TABLE_IO_ERROR          ///< Ошибка: не удалось прочитать или записать файл, или его формат неверен
 } HashTable_ErrorCode;
 
+#define HASH_KEY_INLINE_CAPACITY 23   ///< Максимальная длина ключа, хранимого прямо в узле
+
+/// @brief Ключ: короткий хранится внутри узла, длинный - в арене таблицы
+/// @details Последний байт inlineKey служит признаком: 0 - ключ лежит в inlineKey
+///          (для ключа из 23 символов это и есть завершающий ноль), 1 - в external.
+typedef union {
+    char inlineKey[HASH_KEY_INLINE_CAPACITY + 1]; ///< Короткий ключ с завершающим нулём
+    const char* external;                        ///< Длинный ключ в арене таблицы
+} HashKey;
+
 /// @brief Узел связного списка для хранения пары ключ-значение
 typedef struct HashNode {
-    char* key;                    ///< Ключ (строка)
+    HashKey key;                  ///< Ключ (строка)
     int value;                    ///< Значение
     struct HashNode* next;        ///< Указатель на следующий узел
 } HashNode;
 
-/// @brief Хеш-таблица с разрешением коллизий с помощью связного списка
+/// @brief Заголовок блока арены, за которым следуют данные
+typedef struct HashArenaBlock {
+    struct HashArenaBlock* next;  ///< Предыдущий выделенный блок
+    size_t size;                  ///< Размер блока вместе с заголовком
+} HashArenaBlock;
+
+/// @brief Арена: память под узлы и длинные ключи выдаётся из больших блоков
+/// @details Отдельные выделения не освобождаются; вся арена освобождается
+///          целиком при очистке таблицы несколькими вызовами free.
+typedef struct {
+    HashArenaBlock* blocks;       ///< Список блоков (последний выделенный первым)
+    char* cursor;                 ///< Начало свободного места в текущем блоке
+    size_t left;                  ///< Свободных байт в текущем блоке
+    size_t reserved;              ///< Всего байт в блоках
+    size_t maxBlock;              ///< Предел размера блока или 0 - HASH_ARENA_MAX_BLOCK
+} HashArena;
+
+/// @brief Способ хранения элементов в хеш-таблице
+typedef enum {
+    HASH_TABLE_BACKEND_CHAINED,   ///< Цепочки: список узлов в каждом бакете
+    HASH_TABLE_BACKEND_FLAT,      ///< Открытая адресация в стиле SwissTable
+    HASH_TABLE_BACKEND_SHARDED,   ///< Потокобезопасные шарды с цепочками и чтением без блокировок
+    HASH_TABLE_BACKEND_MAPPED,    ///< Снимок в файле, отображённый в память только для чтения
+    HASH_TABLE_BACKEND_PERFECT    ///< Минимальное идеальное хеширование неизменного набора ключей
+} HashTable_Backend;
+
+/// @brief Слот плоской таблицы: пара ключ-значение без указателя next
+typedef struct {
+    HashKey key;                  ///< Ключ (строка)
+    int value;                    ///< Значение
+} HashSlot;
+
+/// @brief Хеш-функция таблицы
+/// @details Все 64 бита результата должны быть хорошо перемешаны: цепочки берут
+///          младшие биты, плоская таблица - младшие 7 для отпечатка и биты над
+///          ними (hash >> 7) для группы, шарды - самые старшие.
+/// @param key Ключ
+/// @param length Длина ключа в байтах
+/// @param seed Зерно таблицы
+/// @return 64-битный хеш
+typedef uint64_t (*HashTable_HashFunction)(const char* key, size_t length, uint64_t seed);
+
+#define HASH_TABLE_STATS_HISTOGRAM 17    ///< Корзины гистограмм: длины 0..15 и "16 и больше"
+
+#ifdef HASH_TABLE_STATS
+/// @brief Счётчики операций таблицы (только при сборке с -DHASH_TABLE_STATS)
+typedef struct {
+    uint64_t inserts;             ///< Вызовы hashTableInsertUnique
+    uint64_t lookups;             ///< Искомые ключи (hashTableGet, hashTableContains, hashTableGetBatch)
+    uint64_t hits;                ///< Найденные ключи
+    uint64_t misses;              ///< Ненайденные ключи
+    uint64_t removes;             ///< Вызовы hashTableRemove
+    uint64_t probeHistogram[HASH_TABLE_STATS_HISTOGRAM]; ///< Длины поиска в hashTableGet и hashTableContains
+} HashTableStats;
+#endif
+
+/// @brief Хеш-таблица с разрешением коллизий цепочками или открытой адресацией
 typedef struct {
-    HashNode** buckets;           ///< Массив списков (бакетов)
-    size_t size;                  ///< Размер таблицы (количество бакетов)
+    HashTable_Backend backend;    ///< Используемый способ хранения
+    HashNode** buckets;           ///< Массив списков (бакетов), только для цепочек
+    size_t size;                  ///< Размер таблицы (количество бакетов или слотов)
     size_t count;                 ///< Текущее количество элементов
+    HashNode** oldBuckets;        ///< Старый массив бакетов во время постепенного перехеширования
+    size_t oldSize;               ///< Размер старого массива бакетов
+    size_t rehashIndex;           ///< Бакеты старого массива с меньшим индексом уже перенесены
+    size_t rehashStep;            ///< Сколько бакетов переносить за операцию (0 - все сразу)
+    size_t resizeCount;           ///< Сколько раз менялся массив бакетов или слотов
+    uint8_t* ctrl;                ///< Управляющие байты слотов, только для плоской таблицы
+    HashSlot* slots;              ///< Массив слотов, только для плоской таблицы
+    size_t growthLeft;            ///< Сколько пустых слотов можно занять до расширения
+    struct HashShard* shards;     ///< Массив шардов, только для потокобезопасной таблицы
+    size_t shardCount;            ///< Количество шардов (степень двойки)
+    unsigned shardShift;          ///< Сдвиг хеша, дающий номер шарда из старших бит
+    HashArena arena;              ///< Память под узлы и длинные ключи
+    HashNode* freeNodes;          ///< Узлы удалённых элементов для повторного использования
+    HashTable_HashFunction hash;  ///< Хеш-функция
+    uint64_t seed;                ///< Случайное зерно хеш-функции, своё у каждой таблицы
+    const char* mapping;          ///< Отображённый файл снимка, только для снимка
+    size_t mappingSize;           ///< Размер отображения
+    uint8_t* pilots;              ///< Пилоты бакетов, только для идеального хеширования
+    size_t pilotCount;            ///< Количество бакетов идеального хеширования
+    size_t positions;             ///< Количество позиций, из которых выбирает идеальная функция
+    uint32_t* remap;              ///< Слоты для позиций от count до positions
+    uint64_t* largePilots;        ///< Пилоты от 255 и больше: (бакет << 32) | пилот по возрастанию
+    size_t largePilotCount;       ///< Количество больших пилотов
+#ifdef HASH_TABLE_STATS
+    HashTableStats stats;         ///< Счётчики операций
+#endif
 } HashTable;
 
+/*
+ * Статистика.
+ *
+ * При сборке с -DHASH_TABLE_STATS таблица считает операции, попадания и
+ * длины поиска; без флага макрос HASH_STATS раскрывается в пустой оператор,
+ * и горячий путь не меняется. Длина поиска - количество просмотренных
+ * позиций: узлов цепочки (записей снимка), групп плоской таблицы или
+ * одного слота идеального хеширования. Она накапливается в переменной
+ * потока statsProbes, поэтому чтения потокобезопасной таблицы из разных
+ * потоков не мешают друг другу, а счётчики увеличиваются атомарно.
+ */
+
+#ifdef HASH_TABLE_STATS
+#define HASH_STATS(code) do { code; } while (0)
+
+static _Thread_local size_t statsProbes;  ///< Длина текущего поиска
+
+/// @brief Атомарно прибавляет к счётчику
+static inline void statsAdd(uint64_t* counter, uint64_t amount) {
+    __atomic_fetch_add(counter, amount, __ATOMIC_RELAXED);
+}
+
+/// @brief Учитывает завершённый поиск и его длину statsProbes
+static inline void statsRecordLookup(HashTable* table, int found) {
+    size_t bin = statsProbes < HASH_TABLE_STATS_HISTOGRAM - 1 ? statsProbes : HASH_TABLE_STATS_HISTOGRAM - 1;
+
+    statsAdd(&table->stats.lookups, 1);
+    statsAdd(found ? &table->stats.hits : &table->stats.misses, 1);
+    statsAdd(&table->stats.probeHistogram[bin], 1);
+}
+#else
+#define HASH_STATS(code) do { } while (0)
+#endif
+
+#define HASH_ARENA_MIN_BLOCK 4096                 ///< Размер первого блока арены
+#define HASH_ARENA_MAX_BLOCK ((size_t)1 << 20)    ///< Предел удвоения размера блока
+
+/// @brief Выделяет память из арены
+/// @param arena Арена
+/// @param size Размер
+/// @param align Выравнивание (степень двойки, не больше 16)
+/// @return Указатель или NULL при нехватке памяти
+static void* arenaAlloc(HashArena* arena, size_t size, size_t align) {
+    size_t padding = (align - ((uintptr_t)arena->cursor & (align - 1))) & (align - 1);
+
+    if (!arena->blocks || padding + size > arena->left) {
+        size_t blockSize = arena->blocks ? arena->blocks->size * 2 : HASH_ARENA_MIN_BLOCK;
+        size_t maxBlock = arena->maxBlock ? arena->maxBlock : HASH_ARENA_MAX_BLOCK;
+
+        if (blockSize > maxBlock) blockSize = maxBlock;
+        if (blockSize < sizeof(HashArenaBlock) + size) blockSize = sizeof(HashArenaBlock) + size;
+
+        HashArenaBlock* block = (HashArenaBlock*)malloc(blockSize);
+
+        if (!block) return NULL;
+
+        block->next = arena->blocks;
+        block->size = blockSize;
+        arena->blocks = block;
+        arena->cursor = (char*)(block + 1);
+        arena->left = blockSize - sizeof(HashArenaBlock);
+        arena->reserved += blockSize;
+        padding = 0;
+    }
+
+    void* result = arena->cursor + padding;
+
+    arena->cursor += padding + size;
+    arena->left -= padding + size;
+
+    return result;
+}
+
+/// @brief Освобождает все блоки арены
+/// @param arena Арена
+static void arenaRelease(HashArena* arena) {
+    while (arena->blocks) {
+        HashArenaBlock* next = arena->blocks->next;
+        free(arena->blocks);
+        arena->blocks = next;
+    }
+
+    arena->cursor = NULL;
+    arena->left = 0;
+    arena->reserved = 0;
+}
+
+/// @brief Возвращает строку ключа
+/// @param key Ключ
+/// @return Указатель на строку, завершённую нулём
+static inline const char* hashKeyData(const HashKey* key) {
+    return key->inlineKey[HASH_KEY_INLINE_CAPACITY] ? key->external : key->inlineKey;
+}
+
+/// @brief Сохраняет копию строки в ключе: короткую - на месте, длинную - в арене
+/// @param slot Ключ, в который выполняется запись
+/// @param key Исходная строка
+/// @param arena Арена для длинных ключей
+/// @return Код ошибки (успех или ошибка выделения)
+static HashTable_ErrorCode hashKeyInit(HashKey* slot, const char* key, HashArena* arena) {
+    size_t length = strlen(key);
+
+    if (length <= HASH_KEY_INLINE_CAPACITY) {
+        memcpy(slot->inlineKey, key, length + 1);
+        slot->inlineKey[HASH_KEY_INLINE_CAPACITY] = 0;
+        return HASH_TABLE_SUCCESS;
+    }
+
+    char* copy = (char*)arenaAlloc(arena, length + 1, 1);
+
+    if (!copy) return HASH_TABLE_ALLOCATION_ERROR;
+
+    memcpy(copy, key, length + 1);
+    slot->external = copy;
+    slot->inlineKey[HASH_KEY_INLINE_CAPACITY] = 1;
+
+    return HASH_TABLE_SUCCESS;
+}
+
+/// @brief Выделяет узел: из списка освобождённых или из арены
+/// @param arena Арена
+/// @param freeNodes Список освобождённых узлов
+/// @return Узел или NULL при нехватке памяти
+static HashNode* nodeAlloc(HashArena* arena, HashNode** freeNodes) {
+    HashNode* node = *freeNodes;
+
+    if (node) {
+        *freeNodes = node->next;
+        return node;
+    }
+
+    return (HashNode*)arenaAlloc(arena, sizeof(HashNode), _Alignof(HashNode));
+}
+
+/*
+ * Хеш-функции.
+ *
+ * Встроенные функции обрабатывают ключ по 8 байт за шаг и принимают зерно,
+ * которое каждая таблица выбирает случайно при инициализации: не зная его,
+ * нельзя заранее подобрать ключи, попадающие в один бакет. Количество
+ * бакетов и слотов всегда степень двойки, поэтому индекс получается маской
+ * вместо деления.
+ */
+
+/// @brief Читает 8 байт без требований к выравниванию
+static inline uint64_t hashRead64(const unsigned char* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+
+    return value;
+}
+
+/// @brief Читает 4 байта без требований к выравниванию
+static inline uint64_t hashRead32(const unsigned char* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+
+    return value;
+}
+
+/// @brief 128-битное произведение, свёрнутое в 64 бита
+static inline uint64_t hashMultiplyFold(uint64_t a, uint64_t b) {
+    __uint128_t product = (__uint128_t)a * b;
+
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+/// @brief Финальное перемешивание бит (из MurmurHash3)
+static inline uint64_t hashAvalanche(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+/// @brief DJB2 по одному байту с зерном и финальным перемешиванием
+/// @details Медленнее остальных на длинных ключах; оставлена для сравнения.
+uint64_t hashDjb2(const char* key, size_t length, uint64_t seed) {
+    uint64_t hash = 5381 ^ seed;
+
+    for (size_t i = 0; i < length; i++) hash = ((hash << 5) + hash) + (unsigned char)key[i];
+
+    return hashAvalanche(hash);
+}
+
+/// @brief Хеш в стиле wyhash: 16-48 байт за шаг через 128-битные умножения
+/// @details Используется таблицами по умолчанию.
+uint64_t hashWy(const char* key, size_t length, uint64_t seed) {
+    static const uint64_t primes[4] = {0x2D358DCCAA6C78A5ULL, 0x8BB84B93962EACC9ULL,
+                                       0x4B33A62ED433D4A3ULL, 0x4D5A2DA51DE1AA47ULL};
+    const unsigned char* p = (const unsigned char*)key;
+    uint64_t a, b;
+
+    seed ^= hashMultiplyFold(seed ^ primes[0], primes[1]);
+
+    if (length <= 16) {
+        if (length >= 4) {
+            size_t middle = (length >> 3) << 2;
+            a = (hashRead32(p) << 32) | hashRead32(p + middle);
+            b = (hashRead32(p + length - 4) << 32) | hashRead32(p + length - 4 - middle);
+        } else if (length > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8) | p[length - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t left = length;
+
+        if (left > 48) {
+            uint64_t seed1 = seed, seed2 = seed;
+
+            do {
+                seed = hashMultiplyFold(hashRead64(p) ^ primes[1], hashRead64(p + 8) ^ seed);
+                seed1 = hashMultiplyFold(hashRead64(p + 16) ^ primes[2], hashRead64(p + 24) ^ seed1);
+                seed2 = hashMultiplyFold(hashRead64(p + 32) ^ primes[3], hashRead64(p + 40) ^ seed2);
+                p += 48;
+                left -= 48;
+            } while (left > 48);
+
+            seed ^= seed1 ^ seed2;
+        }
+
+        while (left > 16) {
+            seed = hashMultiplyFold(hashRead64(p) ^ primes[1], hashRead64(p + 8) ^ seed);
+            p += 16;
+            left -= 16;
+        }
+
+        a = hashRead64(p + left - 16);
+        b = hashRead64(p + left - 8);
+    }
+
+    __uint128_t product = (__uint128_t)(a ^ primes[1]) * (b ^ seed);
+
+    return hashMultiplyFold((uint64_t)product ^ primes[0] ^ length, (uint64_t)(product >> 64) ^ primes[1]);
+}
+
+/// @brief Хеш в стиле XXH3: полосы по 16 байт, смешанные с секретом и зерном
+uint64_t hashXxh3(const char* key, size_t length, uint64_t seed) {
+    static const uint64_t secret[8] = {0xBE4BA423396CFEB8ULL, 0x1CAD21F72C81017CULL, 0xDB979083E96DD4DEULL,
+                                       0x1F67B3B7A4A44072ULL, 0x78E5C0CC4EE679CBULL, 0x2172FFCC7DD05A82ULL,
+                                       0x8E2443F7744608B8ULL, 0x4C263A81E69035E0ULL};
+    const unsigned char* p = (const unsigned char*)key;
+    uint64_t acc = length * 0x9E3779B185EBCA87ULL;
+
+    if (length > 16) {
+        size_t stripe = 0;
+
+        for (size_t i = 0; i + 16 < length; i += 16, stripe = (stripe + 2) & 7)
+            acc += hashMultiplyFold(hashRead64(p + i) ^ (secret[stripe] + seed),
+                                    hashRead64(p + i + 8) ^ (secret[stripe + 1] - seed));
+
+        // Последние 16 байт (могут перекрываться с предыдущей полосой)
+        acc += hashMultiplyFold(hashRead64(p + length - 16) ^ (secret[stripe] + seed),
+                                hashRead64(p + length - 8) ^ (secret[stripe + 1] - seed));
+    } else if (length >= 8) {
+        acc += hashMultiplyFold(hashRead64(p) ^ (secret[0] + seed), hashRead64(p + length - 8) ^ (secret[1] - seed));
+    } else if (length >= 4) {
+        uint64_t input = (hashRead32(p) << 32) | hashRead32(p + length - 4);
+        acc += hashMultiplyFold(input ^ (secret[2] + seed), length ^ (secret[3] - seed));
+    } else if (length > 0) {
+        uint64_t input = ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8) | p[length - 1];
+        acc += hashMultiplyFold(input ^ (secret[4] + seed), secret[5] - seed);
+    } else {
+        acc += hashMultiplyFold(secret[6] + seed, secret[7] - seed);
+    }
+
+    acc ^= acc >> 37;
+    acc *= 0x165667919E3779F9ULL;
+    acc ^= acc >> 32;
+
+    return acc;
+}
+
+/// @brief Выбирает случайное зерно для новой таблицы
+/// @return Зерно из /dev/urandom, а если он недоступен - из времени и адресов
+static uint64_t hashRandomSeed(void) {
+    uint64_t seed = 0;
+    FILE* random = fopen("/dev/urandom", "rb");
+
+    if (random) {
+        if (fread(&seed, sizeof(seed), 1, random) != 1) seed = 0;
+        fclose(random);
+    }
+
+    if (!seed) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        seed = hashAvalanche((uint64_t)ts.tv_nsec ^ ((uint64_t)ts.tv_sec << 32) ^ (uint64_t)(uintptr_t)&seed);
+    }
+
+    return seed;
+}
+
+/// @brief Хеширует ключ хеш-функцией и зерном таблицы
+static inline uint64_t tableHash(const HashTable* table, const char* key) {
+    return table->hash(key, strlen(key), table->seed);
+}
+
+/// @brief Округляет вверх до степени двойки
+static size_t roundUpPowerOfTwo(size_t value) {
+    size_t result = 1;
+
+    while (result < value) result *= 2;
+
+    return result;
+}
+
+#define HASH_TABLE_MAX_LOAD 1         ///< Среднее число узлов на бакет, после которого таблица растёт
+#define HASH_TABLE_REHASH_STEP 4      ///< Количество бакетов, переносимых за одну операцию
+
 /// @brief Инициализация хеш-таблицы
+/// @details Размер задаёт начальное количество бакетов и округляется вверх до
+///          степени двойки. Когда элементов становится больше, чем
+///          HASH_TABLE_MAX_LOAD на бакет, таблица удваивается, а узлы
+///          переносятся в новый массив понемногу при каждой операции.
 /// @param table Указатель на хеш-таблицу
 /// @param size Размер таблицы
 void hashTableInit(HashTable* table, size_t size) {
-    table->size = size;
-    table->count = 0;
-    table->buckets = (HashNode**)calloc(size, sizeof(HashNode*));
+    memset(table, 0, sizeof(HashTable));
+
+    table->backend = HASH_TABLE_BACKEND_CHAINED;
+    table->size = roundUpPowerOfTwo(size);
+    table->rehashStep = HASH_TABLE_REHASH_STEP;
+    table->hash = hashWy;
+    table->seed = hashRandomSeed();
+    table->buckets = (HashNode**)calloc(table->size, sizeof(HashNode*));
 }
 
 /// @brief Вычисляет улучшенный хеш для строки с использованием алгоритма DJB2
+/// @details Сама таблица использует table->hash (см. hashTableSetHashFunction);
+///          функция оставлена для кода, которому нужен индекс бакета DJB2.
 /// @param key Ключ (строка)
 /// @param size Размер таблицы
 /// @return Индекс бакета для заданного ключа
@@ -48,200 +485,3752 @@ size_t hashFunction(const char* key, size_t size) {
     return hash % size;
 }
 
-/// @brief Вставляет новую пару ключ-значение в таблицу, если ключа нет
-/// @param table Указатель на хеш-таблицу
-/// @param key Ключ
-/// @param value Значение
-/// @return Код ошибки (успех, уже существует или ошибка выделения)
-HashTable_ErrorCode hashTableInsertUnique(HashTable* table, const char* key, int value) {
-    size_t index = hashFunction(key, table->size);
-    HashNode* node = table->buckets[index];
+/*
+ * Плоская таблица (HASH_TABLE_BACKEND_FLAT).
+ *
+ * Все элементы лежат в одном массиве слотов, а рядом хранится массив
+ * управляющих байтов ctrl: 0x80 - пустой слот, 0xFE - удалённый (надгробие),
+ * 0..127 - занятый слот с 7-битным отпечатком хеша (h2). Слоты разбиты на
+ * группы по 16; поиск сравнивает отпечаток сразу со всей группой одной
+ * SSE2-инструкцией и вызывает strcmp только для совпавших отпечатков.
+ * Номер стартовой группы берётся из бит хеша над отпечатком (h1 = hash >> 7), группы
+ * перебираются треугольными шагами, что обходит все группы при
+ * количестве групп, равном степени двойки.
+ */
 
-    while (node) {
-        if (strcmp(node->key, key) == 0) return HASH_TABLE_ALREADY_EXISTS;
-        
-        node = node->next;
-    }
+#define HASH_TABLE_GROUP_WIDTH 16           ///< Количество слотов в группе
+#define HASH_TABLE_CTRL_EMPTY ((uint8_t)0x80)   ///< Управляющий байт пустого слота
+#define HASH_TABLE_CTRL_DELETED ((uint8_t)0xFE) ///< Управляющий байт удалённого слота
+#define HASH_TABLE_NOT_FOUND SIZE_MAX       ///< Индекс "слот не найден"
 
-    node = (HashNode*)malloc(sizeof(HashNode));
+/// @brief Возвращает битовую маску слотов группы, управляющий байт которых равен byte
+/// @param group Указатель на первый управляющий байт группы
+/// @param byte Искомое значение
+/// @return Маска: бит i установлен, если group[i] == byte
+static inline uint32_t groupMatch(const uint8_t* group, uint8_t byte) {
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
 
-    if (!node) return HASH_TABLE_ALLOCATION_ERROR;
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)byte)));
+#else
+    uint32_t mask = 0;
 
-    node->key = strdup(key);
+    for (int i = 0; i < HASH_TABLE_GROUP_WIDTH; i++)
+        if (group[i] == byte) mask |= 1u << i;
 
-    if (!node->key) {
-        free(node);
-        return HASH_TABLE_ALLOCATION_ERROR;
-    }
+    return mask;
+#endif
+}
 
-    node->value = value;
-    node->next = table->buckets[index];
-    table->buckets[index] = node;
-    table->count++;
+/// @brief Возвращает маску пустых или удалённых слотов группы (старший бит установлен)
+/// @param group Указатель на первый управляющий байт группы
+/// @return Маска свободных слотов
+static inline uint32_t groupMatchEmptyOrDeleted(const uint8_t* group) {
+#if defined(__SSE2__)
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+    uint32_t mask = 0;
 
-    return HASH_TABLE_SUCCESS;
+    for (int i = 0; i < HASH_TABLE_GROUP_WIDTH; i++)
+        if (group[i] & 0x80) mask |= 1u << i;
+
+    return mask;
+#endif
 }
 
-/// @brief Проверяет, существует ли ключ в таблице
+/// @brief Ищет слот с ключом в плоской таблице
 /// @param table Указатель на хеш-таблицу
 /// @param key Ключ
-/// @return Код ошибки (успех или ключ не найден)
-HashTable_ErrorCode hashTableContains(HashTable* table, const char* key) {
-    size_t index = hashFunction(key, table->size);
-    HashNode* node = table->buckets[index];
+/// @param hash Хеш ключа (tableHash)
+/// @return Индекс слота или HASH_TABLE_NOT_FOUND
+static size_t flatFind(const HashTable* table, const char* key, uint64_t hash) {
+    size_t groupMask = table->size / HASH_TABLE_GROUP_WIDTH - 1;
+    size_t group = (size_t)(hash >> 7) & groupMask;
+    uint8_t h2 = (uint8_t)(hash & 0x7F);
 
-    while (node) {
-        if (strcmp(node->key, key) == 0) return HASH_TABLE_SUCCESS;
-        
-        node = node->next;
-    }
+    for (size_t step = 1;; step++) {
+        const uint8_t* ctrl = table->ctrl + group * HASH_TABLE_GROUP_WIDTH;
+        uint32_t match = groupMatch(ctrl, h2);
 
-    return HASH_TABLE_KEY_NOT_FOUND;
-}
+        HASH_STATS(statsProbes++);
 
-/// @brief Возвращает значение по ключу из хеш-таблицы
-/// @param table Указатель на хеш-таблицу
-/// @param key Ключ
-/// @param[out] value Указатель для сохранения значения
-/// @return Код ошибки (успех или ключ не найден)
-HashTable_ErrorCode hashTableGet(HashTable* table, const char* key, int* value) {
-    size_t index = hashFunction(key, table->size);
-    HashNode* node = table->buckets[index];
+        while (match) {
+            size_t index = group * HASH_TABLE_GROUP_WIDTH + (size_t)__builtin_ctz(match);
 
-    while (node) {
-        if (strcmp(node->key, key) == 0) {
-            *value = node->value;
-            return HASH_TABLE_SUCCESS;
+            if (strcmp(hashKeyData(&table->slots[index].key), key) == 0) return index;
+
+            match &= match - 1;
         }
-        node = node->next;
-    }
 
-    return HASH_TABLE_KEY_NOT_FOUND;
+        if (groupMatch(ctrl, HASH_TABLE_CTRL_EMPTY)) return HASH_TABLE_NOT_FOUND;
+
+        group = (group + step) & groupMask;
+    }
 }
 
-/// @brief Возвращает текущее количество элементов в таблице
-/// @param table Указатель на хеш-таблицу
-/// @return Количество элементов
-size_t hashTableCount(HashTable* table) { return table->count; }
+/// @brief Ищет первый пустой или удалённый слот на пути поиска хеша
+/// @param ctrl Массив управляющих байтов
+/// @param size Количество слотов
+/// @param hash Хеш ключа
+/// @return Индекс свободного слота
+static size_t flatFindInsertSlot(const uint8_t* ctrl, size_t size, uint64_t hash) {
+    size_t groupMask = size / HASH_TABLE_GROUP_WIDTH - 1;
+    size_t group = (size_t)(hash >> 7) & groupMask;
 
-/// @brief Удаляет элемент из хеш-таблицы по ключу
-/// @param table Указатель на хеш-таблицу
-/// @param key Ключ
-/// @return Код ошибки (успех или ключ не найден)
-HashTable_ErrorCode hashTableRemove(HashTable* table, const char* key) {
-    size_t index = hashFunction(key, table->size);
-    HashNode* node = table->buckets[index];
-    HashNode* prev = NULL;
+    for (size_t step = 1;; step++) {
+        uint32_t free = groupMatchEmptyOrDeleted(ctrl + group * HASH_TABLE_GROUP_WIDTH);
 
-    while (node) {
-        if (strcmp(node->key, key) == 0) {
-            if (prev) {
-                prev->next = node->next;
-            } else {
-                table->buckets[index] = node->next;
-            }
-            free(node->key);
-            free(node);
-            table->count--;
-            return HASH_TABLE_SUCCESS;
-        }
-        prev = node;
-        node = node->next;
+        if (free) return group * HASH_TABLE_GROUP_WIDTH + (size_t)__builtin_ctz(free);
+
+        group = (group + step) & groupMask;
     }
-    return HASH_TABLE_KEY_NOT_FOUND;
 }
 
-/// @brief Выводит все ключи хеш-таблицы
-/// @param table Указатель на хеш-таблицу
-/// @return Массив строк с ключами (пользователь должен освободить память)
-char** hashTableKeys(HashTable* table) {
-    char** keys = (char**)malloc(table->count * sizeof(char*));
-    if (!keys) return NULL;
+/// @brief Подбирает количество слотов (степень двойки, не меньше группы) для числа элементов
+/// @param count Ожидаемое количество элементов
+/// @return Количество слотов, при котором загрузка не превышает 7/8
+static size_t flatCapacityFor(size_t count) {
+    size_t capacity = HASH_TABLE_GROUP_WIDTH;
 
-    size_t idx = 0;
-    for (size_t i = 0; i < table->size; i++) {
-        HashNode* node = table->buckets[i];
-        while (node) {
-            keys[idx++] = strdup(node->key);
-            node = node->next;
-        }
-    }
-    return keys;
+    while (capacity - capacity / 8 < count) capacity *= 2;
+
+    return capacity;
 }
 
-/// @brief Очистка хеш-таблицы и освобождение памяти
+/// @brief Выделяет пустые массивы ctrl и slots заданного размера
 /// @param table Указатель на хеш-таблицу
-void hashTableClear(HashTable* table) {
-    for (size_t i = 0; i < table->size; i++) {
-        HashNode* node = table->buckets[i];
-        while (node) {
-            HashNode* temp = node;
-            node = node->next;
-            free(temp->key);
-            free(temp);
-        }
+/// @param capacity Количество слотов
+/// @return Код ошибки (успех или ошибка выделения)
+static HashTable_ErrorCode flatAllocate(HashTable* table, size_t capacity) {
+    uint8_t* ctrl = (uint8_t*)malloc(capacity);
+    HashSlot* slots = (HashSlot*)malloc(capacity * sizeof(HashSlot));
+
+    if (!ctrl || !slots) {
+        free(ctrl);
+        free(slots);
+        return HASH_TABLE_ALLOCATION_ERROR;
     }
-    free(table->buckets);
-    table->buckets = NULL;
-    table->count = 0;
-}
 
-/// @brief Функция для запуска всех тестов хеш-таблицы
-void hashTableTests() {
-    HashTable table;
-    hashTableInit(&table, 10);
-    
-    // Тест: Вставка уникальных значений
-    assert(hashTableInsertUnique(&table, "apple", 100) == HASH_TABLE_SUCCESS);
-    assert(hashTableInsertUnique(&table, "banana", 200) == HASH_TABLE_SUCCESS);
-    assert(hashTableInsertUnique(&table, "apple", 300) == HASH_TABLE_ALREADY_EXISTS);
+    memset(ctrl, HASH_TABLE_CTRL_EMPTY, capacity);
 
-    // Тест: Получение значения по ключу
-    int value;
-    assert(hashTableGet(&table, "apple", &value) == HASH_TABLE_SUCCESS);
-    assert(value == 100);
+    table->ctrl = ctrl;
+    table->slots = slots;
+    table->size = capacity;
+    table->resizeCount++;
+    table->growthLeft = capacity - capacity / 8 - table->count;
 
-    assert(hashTableGet(&table, "banana", &value) == HASH_TABLE_SUCCESS);
-    assert(value == 200);
+    return HASH_TABLE_SUCCESS;
+}
 
-    // Тест: Получение значения для несуществующего ключа
-    assert(hashTableGet(&table, "cherry", &value) == HASH_TABLE_KEY_NOT_FOUND);
+/// @brief Перестраивает плоскую таблицу, освобождая место под новые элементы
+/// @details Надгробия при перестроении исчезают, поэтому при большом их числе
+///          размер может остаться прежним.
+/// @param table Указатель на хеш-таблицу
+/// @return Код ошибки (успех или ошибка выделения)
+static HashTable_ErrorCode flatResize(HashTable* table) {
+    uint8_t* oldCtrl = table->ctrl;
+    HashSlot* oldSlots = table->slots;
+    size_t oldSize = table->size;
 
-    // Тест: Проверка существования ключа
-    assert(hashTableContains(&table, "apple") == HASH_TABLE_SUCCESS);
-    assert(hashTableContains(&table, "cherry") == HASH_TABLE_KEY_NOT_FOUND);
+    if (flatAllocate(table, flatCapacityFor((table->count + 1) * 2)) != HASH_TABLE_SUCCESS) {
+        table->ctrl = oldCtrl;
+        table->slots = oldSlots;
+        return HASH_TABLE_ALLOCATION_ERROR;
+    }
 
-    // Тест: Удаление элемента
-    assert(hashTableRemove(&table, "apple") == HASH_TABLE_SUCCESS);
-    assert(hashTableRemove(&table, "apple") == HASH_TABLE_KEY_NOT_FOUND);
+    for (size_t i = 0; i < oldSize; i++) {
+        if (oldCtrl[i] & 0x80) continue;
 
-    // Тест: Вставка и проверка нового значения после удаления
-    assert(hashTableInsertUnique(&table, "apple", 300) == HASH_TABLE_SUCCESS);
-    assert(hashTableGet(&table, "apple", &value) == HASH_TABLE_SUCCESS);
-    assert(value == 300);
+        uint64_t hash = tableHash(table, hashKeyData(&oldSlots[i].key));
+        size_t index = flatFindInsertSlot(table->ctrl, table->size, hash);
 
-    // Тест: Количество элементов
-    assert(hashTableCount(&table) == 2);
+        table->ctrl[index] = (uint8_t)(hash & 0x7F);
+        table->slots[index] = oldSlots[i];
+    }
 
-    // Тест: Получение всех ключей
-    char** keys = hashTableKeys(&table);
-    assert(keys != NULL);
-    assert(strcmp(keys[0], "banana") == 0 || strcmp(keys[0], "apple") == 0);
-    assert(strcmp(keys[1], "banana") == 0 || strcmp(keys[1], "apple") == 0);
-    free(keys[0]);
-    free(keys[1]);
-    free(keys);
+    free(oldCtrl);
+    free(oldSlots);
 
-    // Тест: Очистка таблицы
-    hashTableClear(&table);
-    assert(hashTableCount(&table) == 0);
+    return HASH_TABLE_SUCCESS;
 }
 
-int main() {
-    hashTableTests();
+/// @brief Инициализация хеш-таблицы с открытой адресацией (SwissTable)
+/// @param table Указатель на хеш-таблицу
+/// @param capacity Ожидаемое количество элементов (таблица расширяется автоматически)
+/// @return Код ошибки (успех или ошибка выделения)
+HashTable_ErrorCode hashTableInitFlat(HashTable* table, size_t capacity) {
+    memset(table, 0, sizeof(HashTable));
 
-    printf("All hash table tests passed!\n");
+    table->backend = HASH_TABLE_BACKEND_FLAT;
+    table->hash = hashWy;
+    table->seed = hashRandomSeed();
 
-    return 0;
+    return flatAllocate(table, flatCapacityFor(capacity));
 }
 
+/// @brief Вставка в плоскую таблицу (см. hashTableInsertUnique)
+static HashTable_ErrorCode flatInsertUnique(HashTable* table, const char* key, int value) {
+    uint64_t hash = tableHash(table, key);
+
+    if (flatFind(table, key, hash) != HASH_TABLE_NOT_FOUND) return HASH_TABLE_ALREADY_EXISTS;
+
+    size_t index = flatFindInsertSlot(table->ctrl, table->size, hash);
+
+    if (table->growthLeft == 0 && table->ctrl[index] == HASH_TABLE_CTRL_EMPTY) {
+        if (flatResize(table) != HASH_TABLE_SUCCESS) return HASH_TABLE_ALLOCATION_ERROR;
+
+        index = flatFindInsertSlot(table->ctrl, table->size, hash);
+    }
+
+    if (hashKeyInit(&table->slots[index].key, key, &table->arena) != HASH_TABLE_SUCCESS)
+        return HASH_TABLE_ALLOCATION_ERROR;
+
+    if (table->ctrl[index] == HASH_TABLE_CTRL_EMPTY) table->growthLeft--;
+
+    table->ctrl[index] = (uint8_t)(hash & 0x7F);
+    table->slots[index].value = value;
+    table->count++;
+
+    return HASH_TABLE_SUCCESS;
+}
+
+/// @brief Удаление из плоской таблицы (см. hashTableRemove)
+/// @details Если в группе слота есть пустой слот, ни один поиск не проходил
+///          дальше этой группы, и слот можно снова пометить пустым. Иначе
+///          ставится надгробие, чтобы не разорвать цепочки проб.
+static HashTable_ErrorCode flatRemove(HashTable* table, const char* key) {
+    size_t index = flatFind(table, key, tableHash(table, key));
+
+    if (index == HASH_TABLE_NOT_FOUND) return HASH_TABLE_KEY_NOT_FOUND;
+
+    const uint8_t* group = table->ctrl + index / HASH_TABLE_GROUP_WIDTH * HASH_TABLE_GROUP_WIDTH;
+
+    if (groupMatch(group, HASH_TABLE_CTRL_EMPTY)) {
+        table->ctrl[index] = HASH_TABLE_CTRL_EMPTY;
+        table->growthLeft++;
+    } else {
+        table->ctrl[index] = HASH_TABLE_CTRL_DELETED;
+    }
+
+    table->count--;
+
+    return HASH_TABLE_SUCCESS;
+}
+
+/*
+ * Потокобезопасная таблица (HASH_TABLE_BACKEND_SHARDED).
+ *
+ * Таблица разбита на шарды по старшим битам хеша, у каждого шарда свой
+ * мьютекс и свой массив бакетов с цепочками. Писатели блокируют только
+ * свой шард. Читатели (hashTableGet, hashTableContains) не берут
+ * блокировок: указатели на головы цепочек и поля next публикуются
+ * атомарными записями с release-семантикой, а удалённые узлы освобождаются
+ * отложенно с помощью эпох (epoch-based reclamation). Узел, удалённый в
+ * эпоху e, освобождается только после того, как глобальная эпоха дошла до
+ * e + 2: к этому моменту все читатели, которые могли его видеть, вышли из
+ * критической секции. Рост шарда строит новый массив с копиями узлов и
+ * атомарно подменяет старый, который тоже освобождается отложенно.
+ *
+ * Каждый поток-читатель при первом обращении занимает слот в таблице
+ * эпох и возвращает его при завершении. Если свободных слотов
+ * (HASH_TABLE_MAX_READERS) не хватило, поток читает под мьютексом шарда.
+ * Для сборки нужен -pthread.
+ */
+
+#define HASH_TABLE_MAX_READERS 256    ///< Количество слотов читателей в таблице эпох
+#define HASH_TABLE_RETIRE_BATCH 64    ///< Сколько отложенных освобождений копить до попытки сбора
+
+/// @brief Массив бакетов одного шарда
+typedef struct {
+    size_t size;                  ///< Количество бакетов (степень двойки)
+    HashNode* heads[];            ///< Головы цепочек
+} HashShardBuckets;
+
+/// @brief Память, ожидающая окончания эпохи перед освобождением
+typedef struct {
+    void* ptr;                    ///< Узел или массив бакетов
+    int isNode;                   ///< 1 - узел возвращается в список свободных, 0 - вызывается free
+    uint64_t epoch;               ///< Глобальная эпоха в момент удаления
+} HashRetired;
+
+/// @brief Шард потокобезопасной таблицы
+typedef struct HashShard {
+    _Alignas(64) pthread_mutex_t lock; ///< Блокировка писателей
+    HashShardBuckets* buckets;    ///< Текущий массив бакетов (читается атомарно)
+    size_t count;                 ///< Количество элементов в шарде
+    HashRetired* retired;         ///< Отложенные освобождения
+    size_t retiredCount;          ///< Количество отложенных освобождений
+    size_t retiredCapacity;       ///< Вместимость массива retired
+    HashArena arena;              ///< Память под узлы и длинные ключи шарда
+    HashNode* freeNodes;          ///< Узлы, которые уже не видит ни один читатель
+} HashShard;
+
+/// @brief Слот читателя в таблице эпох (на отдельной кеш-линии)
+typedef struct {
+    _Alignas(64) uint64_t epoch;  ///< Эпоха, в которой читатель вошёл в секцию, или 0
+} EpochReader;
+
+static uint64_t epochGlobal = 1;                          ///< Глобальная эпоха
+static EpochReader epochReaders[HASH_TABLE_MAX_READERS];  ///< Слоты читателей
+static unsigned char epochSlotTaken[HASH_TABLE_MAX_READERS]; ///< Занят ли слот живым потоком
+static unsigned epochReaderCount;                         ///< Граница когда-либо занятых слотов
+static _Thread_local int epochSlot = -1;                  ///< Слот текущего потока
+static pthread_key_t epochKey;                            ///< Ключ для возврата слота при выходе потока
+static pthread_once_t epochKeyOnce = PTHREAD_ONCE_INIT;   ///< Однократное создание epochKey
+
+/// @brief Возвращает слот читателя завершившегося потока
+/// @param slot Номер слота плюс один
+static void epochReleaseSlot(void* slot) {
+    __atomic_store_n(&epochSlotTaken[(intptr_t)slot - 1], 0, __ATOMIC_RELEASE);
+}
+
+/// @brief Создаёт ключ потока, освобождающий слот при завершении
+static void epochCreateKey(void) { pthread_key_create(&epochKey, epochReleaseSlot); }
+
+/// @brief Занимает свободный слот читателя для текущего потока
+static void epochAcquireSlot(void) {
+    pthread_once(&epochKeyOnce, epochCreateKey);
+    epochSlot = HASH_TABLE_MAX_READERS;
+
+    for (int i = 0; i < HASH_TABLE_MAX_READERS; i++) {
+        unsigned char expected = 0;
+
+        if (!__atomic_compare_exchange_n(&epochSlotTaken[i], &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            continue;
+
+        unsigned count = __atomic_load_n(&epochReaderCount, __ATOMIC_RELAXED);
+        while (count < (unsigned)i + 1 &&
+               !__atomic_compare_exchange_n(&epochReaderCount, &count, (unsigned)i + 1, 0, __ATOMIC_ACQ_REL,
+                                            __ATOMIC_RELAXED)) {
+        }
+
+        epochSlot = i;
+        pthread_setspecific(epochKey, (void*)(intptr_t)(i + 1));
+        return;
+    }
+}
+
+/// @brief Входит в критическую секцию читателя
+/// @return 1 в случае успеха, 0 если у потока нет слота и читать нужно под мьютексом
+static int epochEnter(void) {
+    if (epochSlot < 0) epochAcquireSlot();
+
+    if (epochSlot == HASH_TABLE_MAX_READERS) return 0;
+
+    __atomic_store_n(&epochReaders[epochSlot].epoch, __atomic_load_n(&epochGlobal, __ATOMIC_RELAXED),
+                     __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    return 1;
+}
+
+/// @brief Выходит из критической секции читателя
+static void epochExit(void) { __atomic_store_n(&epochReaders[epochSlot].epoch, 0, __ATOMIC_RELEASE); }
+
+/// @brief Продвигает глобальную эпоху, если все активные читатели её уже видели
+/// @return Глобальная эпоха после попытки
+static uint64_t epochTryAdvance(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    uint64_t epoch = __atomic_load_n(&epochGlobal, __ATOMIC_ACQUIRE);
+    unsigned readers = __atomic_load_n(&epochReaderCount, __ATOMIC_ACQUIRE);
+
+    for (unsigned i = 0; i < readers; i++) {
+        uint64_t seen = __atomic_load_n(&epochReaders[i].epoch, __ATOMIC_ACQUIRE);
+
+        if (seen && seen != epoch) return epoch;
+    }
+
+    if (__atomic_compare_exchange_n(&epochGlobal, &epoch, epoch + 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        return epoch + 1;
+
+    return epoch;
+}
+
+/// @brief Освобождает отложенный блок шарда
+/// @param shard Шард (мьютекс захвачен)
+/// @param item Отложенное освобождение
+static void shardRelease(HashShard* shard, const HashRetired* item) {
+    if (item->isNode) {
+        HashNode* node = (HashNode*)item->ptr;
+        node->next = shard->freeNodes;
+        shard->freeNodes = node;
+    } else {
+        free(item->ptr);
+    }
+}
+
+/// @brief Освобождает отложенную память шарда, которую уже не может видеть ни один читатель
+/// @param shard Шард (мьютекс захвачен)
+/// @param wait 1 - ждать, пока освободится всё; 0 - освободить только то, что уже можно
+static void shardReclaim(HashShard* shard, int wait) {
+    uint64_t epoch = epochTryAdvance();
+
+    while (wait && shard->retiredCount && shard->retired[shard->retiredCount - 1].epoch + 2 > epoch) {
+        sched_yield();
+        epoch = epochTryAdvance();
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < shard->retiredCount; i++) {
+        if (shard->retired[i].epoch + 2 <= epoch) {
+            shardRelease(shard, &shard->retired[i]);
+        } else {
+            shard->retired[kept++] = shard->retired[i];
+        }
+    }
+
+    shard->retiredCount = kept;
+}
+
+/// @brief Откладывает освобождение памяти до окончания текущей эпохи
+/// @param shard Шард (мьютекс захвачен)
+/// @param ptr Освобождаемый блок
+/// @param isNode 1, если это узел шарда, 0 - блок из malloc
+static void shardRetire(HashShard* shard, void* ptr, int isNode) {
+    HashRetired item = {ptr, isNode, __atomic_load_n(&epochGlobal, __ATOMIC_ACQUIRE)};
+
+    if (shard->retiredCount == shard->retiredCapacity) {
+        size_t capacity = shard->retiredCapacity ? shard->retiredCapacity * 2 : HASH_TABLE_RETIRE_BATCH;
+        HashRetired* retired = (HashRetired*)realloc(shard->retired, capacity * sizeof(HashRetired));
+
+        if (!retired) {
+            // Памяти под очередь нет: дожидаемся конца эпохи и освобождаем сразу
+            shardReclaim(shard, 1);
+
+            while (epochTryAdvance() < item.epoch + 2) sched_yield();
+
+            shardRelease(shard, &item);
+            return;
+        }
+
+        shard->retired = retired;
+        shard->retiredCapacity = capacity;
+    }
+
+    shard->retired[shard->retiredCount++] = item;
+
+    if (shard->retiredCount % HASH_TABLE_RETIRE_BATCH == 0) shardReclaim(shard, 0);
+}
+
+/// @brief Выделяет пустой массив бакетов шарда
+/// @param size Количество бакетов (степень двойки)
+/// @return Указатель на массив или NULL
+static HashShardBuckets* shardBucketsCreate(size_t size) {
+    HashShardBuckets* buckets = (HashShardBuckets*)calloc(1, sizeof(HashShardBuckets) + size * sizeof(HashNode*));
+
+    if (buckets) buckets->size = size;
+
+    return buckets;
+}
+
+/// @brief Возвращает шард, отвечающий за хеш
+static inline HashShard* shardFor(const HashTable* table, uint64_t hash) {
+    return &table->shards[table->shardCount > 1 ? hash >> table->shardShift : 0];
+}
+
+/// @brief Ищет узел в шарде без блокировок (вызывается внутри секции читателя или под мьютексом)
+/// @param shard Шард
+/// @param key Ключ
+/// @param hash Хеш ключа (tableHash)
+/// @return Узел или NULL
+static HashNode* shardFind(HashShard* shard, const char* key, uint64_t hash) {
+    HashShardBuckets* buckets = __atomic_load_n(&shard->buckets, __ATOMIC_ACQUIRE);
+    HashNode* node = __atomic_load_n(&buckets->heads[hash & (buckets->size - 1)], __ATOMIC_ACQUIRE);
+
+    while (node) {
+        HASH_STATS(statsProbes++);
+
+        if (strcmp(hashKeyData(&node->key), key) == 0) return node;
+
+        node = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+    }
+
+    return NULL;
+}
+
+/// @brief Удваивает массив бакетов шарда, копируя узлы
+/// @details Старые узлы остаются нетронутыми, пока их могут читать другие потоки,
+///          и освобождаются через shardRetire. При нехватке памяти шард остаётся прежним.
+/// @param table Указатель на хеш-таблицу
+/// @param shard Шард (мьютекс захвачен)
+static void shardGrow(const HashTable* table, HashShard* shard) {
+    HashShardBuckets* old = shard->buckets;
+    HashShardBuckets* buckets = shardBucketsCreate(old->size * 2);
+
+    if (!buckets) return;
+
+    for (size_t i = 0; i < old->size; i++) {
+        for (HashNode* node = old->heads[i]; node; node = node->next) {
+            HashNode* copy = nodeAlloc(&shard->arena, &shard->freeNodes);
+
+            if (!copy) {
+                for (size_t j = 0; j < buckets->size; j++) {
+                    while (buckets->heads[j]) {
+                        HashNode* temp = buckets->heads[j];
+                        buckets->heads[j] = temp->next;
+                        temp->next = shard->freeNodes;
+                        shard->freeNodes = temp;
+                    }
+                }
+                free(buckets);
+                return;
+            }
+
+            size_t index = tableHash(table, hashKeyData(&node->key)) & (buckets->size - 1);
+
+            copy->key = node->key;
+            copy->value = node->value;
+            copy->next = buckets->heads[index];
+            buckets->heads[index] = copy;
+        }
+    }
+
+    __atomic_store_n(&shard->buckets, buckets, __ATOMIC_RELEASE);
+
+    for (size_t i = 0; i < old->size; i++)
+        for (HashNode* node = old->heads[i]; node; node = node->next) shardRetire(shard, node, 1);
+
+    shardRetire(shard, old, 0);
+}
+
+/// @brief Инициализация потокобезопасной хеш-таблицы
+/// @param table Указатель на хеш-таблицу
+/// @param shardCount Количество шардов (округляется вверх до степени двойки)
+/// @param capacity Ожидаемое количество элементов (шарды растут автоматически)
+/// @return Код ошибки (успех или ошибка выделения)
+HashTable_ErrorCode hashTableInitSharded(HashTable* table, size_t shardCount, size_t capacity) {
+    memset(table, 0, sizeof(HashTable));
+
+    table->backend = HASH_TABLE_BACKEND_SHARDED;
+    table->hash = hashWy;
+    table->seed = hashRandomSeed();
+    table->shardCount = 1;
+    table->shardShift = 64;
+
+    while (table->shardCount < shardCount) {
+        table->shardCount *= 2;
+        table->shardShift--;
+    }
+
+    size_t bucketCount = roundUpPowerOfTwo((capacity + table->shardCount - 1) / table->shardCount);
+    // Недозаполненные последние блоки всех шардов вместе не больше одного блока обычной арены
+    size_t maxBlock = HASH_ARENA_MAX_BLOCK / table->shardCount;
+
+    if (maxBlock < HASH_ARENA_MIN_BLOCK) maxBlock = HASH_ARENA_MIN_BLOCK;
+
+    table->shards = (HashShard*)aligned_alloc(_Alignof(HashShard), table->shardCount * sizeof(HashShard));
+
+    if (!table->shards) return HASH_TABLE_ALLOCATION_ERROR;
+
+    for (size_t i = 0; i < table->shardCount; i++) {
+        HashShard* shard = &table->shards[i];
+
+        memset(shard, 0, sizeof(HashShard));
+        pthread_mutex_init(&shard->lock, NULL);
+        shard->arena.maxBlock = maxBlock;
+        shard->buckets = shardBucketsCreate(bucketCount);
+
+        if (!shard->buckets) {
+            table->shardCount = i + 1;
+            return HASH_TABLE_ALLOCATION_ERROR;
+        }
+    }
+
+    return HASH_TABLE_SUCCESS;
+}
+
+/// @brief Вставка в потокобезопасную таблицу (см. hashTableInsertUnique)
+static HashTable_ErrorCode shardedInsertUnique(HashTable* table, const char* key, int value) {
+    uint64_t hash = tableHash(table, key);
+    HashShard* shard = shardFor(table, hash);
+    HashTable_ErrorCode result = HASH_TABLE_SUCCESS;
+
+    pthread_mutex_lock(&shard->lock);
+
+    if (shardFind(shard, key, hash)) {
+        result = HASH_TABLE_ALREADY_EXISTS;
+    } else {
+        HashNode* node = nodeAlloc(&shard->arena, &shard->freeNodes);
+
+        if (!node || hashKeyInit(&node->key, key, &shard->arena) != HASH_TABLE_SUCCESS) {
+            if (node) {
+                node->next = shard->freeNodes;
+                shard->freeNodes = node;
+            }
+            result = HASH_TABLE_ALLOCATION_ERROR;
+        } else {
+            HashNode** head = &shard->buckets->heads[hash & (shard->buckets->size - 1)];
+
+            node->value = value;
+            node->next = *head;
+            __atomic_store_n(head, node, __ATOMIC_RELEASE);
+            __atomic_store_n(&shard->count, shard->count + 1, __ATOMIC_RELAXED);
+
+            if (shard->count > shard->buckets->size * HASH_TABLE_MAX_LOAD) shardGrow(table, shard);
+        }
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+
+    return result;
+}
+
+/// @brief Поиск в потокобезопасной таблице без блокировок (см. hashTableGet)
+static HashTable_ErrorCode shardedGet(HashTable* table, const char* key, int* value) {
+    uint64_t hash = tableHash(table, key);
+    HashShard* shard = shardFor(table, hash);
+    int locked = !epochEnter();
+
+    if (locked) pthread_mutex_lock(&shard->lock);
+
+    HashNode* node = shardFind(shard, key, hash);
+
+    if (node && value) *value = node->value;
+
+    if (locked) pthread_mutex_unlock(&shard->lock);
+    else epochExit();
+
+    return node ? HASH_TABLE_SUCCESS : HASH_TABLE_KEY_NOT_FOUND;
+}
+
+/// @brief Удаление из потокобезопасной таблицы (см. hashTableRemove)
+static HashTable_ErrorCode shardedRemove(HashTable* table, const char* key) {
+    uint64_t hash = tableHash(table, key);
+    HashShard* shard = shardFor(table, hash);
+    HashTable_ErrorCode result = HASH_TABLE_KEY_NOT_FOUND;
+
+    pthread_mutex_lock(&shard->lock);
+
+    HashNode** link = &shard->buckets->heads[hash & (shard->buckets->size - 1)];
+
+    while (*link) {
+        HashNode* node = *link;
+
+        if (strcmp(hashKeyData(&node->key), key) == 0) {
+            // Сам узел не меняется: читатель, стоящий на нём, дойдёт до конца цепочки
+            __atomic_store_n(link, node->next, __ATOMIC_RELEASE);
+            __atomic_store_n(&shard->count, shard->count - 1, __ATOMIC_RELAXED);
+            shardRetire(shard, node, 1);
+            result = HASH_TABLE_SUCCESS;
+            break;
+        }
+
+        link = &node->next;
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+
+    return result;
+}
+
+/// @brief Количество элементов потокобезопасной таблицы (снимок без блокировок)
+static size_t shardedCount(const HashTable* table) {
+    size_t count = 0;
+
+    for (size_t i = 0; i < table->shardCount; i++)
+        count += __atomic_load_n(&table->shards[i].count, __ATOMIC_RELAXED);
+
+    return count;
+}
+
+/// @brief Освобождает потокобезопасную таблицу (одновременных обращений быть не должно)
+static void shardedClear(HashTable* table) {
+    for (size_t i = 0; i < table->shardCount; i++) {
+        HashShard* shard = &table->shards[i];
+
+        for (size_t j = 0; j < shard->retiredCount; j++)
+            if (!shard->retired[j].isNode) free(shard->retired[j].ptr);
+
+        free(shard->retired);
+        free(shard->buckets);
+        arenaRelease(&shard->arena);
+
+        pthread_mutex_destroy(&shard->lock);
+    }
+
+    free(table->shards);
+    table->shards = NULL;
+    table->shardCount = 0;
+}
+
+/*
+ * Постепенное перехеширование таблицы с цепочками.
+ *
+ * Во время роста живут два массива бакетов: старый (oldBuckets) и новый
+ * (buckets). Каждая операция переносит rehashStep бакетов старого массива,
+ * поэтому ни одна вставка не платит за перенос всей таблицы. Пока старый
+ * бакет ключа не пуст, ключ ищется и вставляется в нём; в пустой старый
+ * бакет ничего не добавляется, поэтому ключи каждого старого бакета лежат
+ * либо все в старом массиве, либо все в новом, и поиск проходит ровно одну
+ * цепочку. Это же позволяет переносить отдельные бакеты вне очереди
+ * (так делает курсор обхода).
+ */
+
+/// @brief Возвращает бакет, в котором лежит или должен лежать ключ
+/// @param table Указатель на хеш-таблицу
+/// @param key Ключ
+/// @return Указатель на голову цепочки
+static HashNode** chainedBucket(HashTable* table, const char* key) {
+    uint64_t hash = tableHash(table, key);
+
+    if (table->oldBuckets) {
+        size_t oldIndex = (size_t)hash & (table->oldSize - 1);
+
+        if (table->oldBuckets[oldIndex]) return &table->oldBuckets[oldIndex];
+    }
+
+    return &table->buckets[(size_t)hash & (table->size - 1)];
+}
+
+/// @brief Переносит один бакет старого массива в новый
+/// @param table Указатель на хеш-таблицу
+/// @param oldIndex Индекс бакета в старом массиве
+static void chainedMigrateBucket(HashTable* table, size_t oldIndex) {
+    HashNode* node = table->oldBuckets[oldIndex];
+
+    while (node) {
+        HashNode* next = node->next;
+        size_t index = (size_t)tableHash(table, hashKeyData(&node->key)) & (table->size - 1);
+
+        node->next = table->buckets[index];
+        table->buckets[index] = node;
+        node = next;
+    }
+
+    table->oldBuckets[oldIndex] = NULL;
+}
+
+/// @brief Переносит очередную порцию бакетов из старого массива в новый
+/// @param table Указатель на хеш-таблицу
+static void chainedRehashStep(HashTable* table) {
+    if (!table->oldBuckets) return;
+
+    size_t limit = table->rehashStep ? table->rehashStep : table->oldSize;
+
+    for (size_t moved = 0; moved < limit && table->rehashIndex < table->oldSize; moved++)
+        chainedMigrateBucket(table, table->rehashIndex++);
+
+    if (table->rehashIndex == table->oldSize) {
+        free(table->oldBuckets);
+        table->oldBuckets = NULL;
+        table->oldSize = 0;
+        table->rehashIndex = 0;
+    }
+}
+
+/// @brief Начинает удвоение таблицы, если превышен допустимый коэффициент загрузки
+/// @details Если памяти под новый массив не хватило, таблица продолжает работать
+///          в прежнем размере, а попытка повторится при следующей вставке.
+/// @param table Указатель на хеш-таблицу
+static void chainedMaybeGrow(HashTable* table) {
+    if (table->oldBuckets || table->count <= table->size * HASH_TABLE_MAX_LOAD) return;
+
+    HashNode** buckets = (HashNode**)calloc(table->size * 2, sizeof(HashNode*));
+
+    if (!buckets) return;
+
+    table->oldBuckets = table->buckets;
+    table->oldSize = table->size;
+    table->rehashIndex = 0;
+    table->buckets = buckets;
+    table->size *= 2;
+    table->resizeCount++;
+
+    chainedRehashStep(table);
+}
+
+/*
+ * Снимок таблицы в файле (HASH_TABLE_BACKEND_MAPPED).
+ *
+ * hashTableSave записывает таблицу любого вида в файл, где вместо указателей
+ * хранятся смещения, а hashTableOpenMapped отображает его в память только
+ * для чтения: поиск идёт прямо по отображению, без разбора файла, поэтому
+ * открытие занимает одинаковое время для таблицы любого размера, а страницы
+ * подгружаются ядром по мере обращения к ним.
+ *
+ * Разметка файла (все секции начинаются на границе HASH_SNAPSHOT_PAGE):
+ *   - заголовок HashSnapshotHeader;
+ *   - bucketCount + 1 смещений uint64_t: записи бакета i занимают байты
+ *     [offsets[i], offsets[i + 1]) секции записей;
+ *   - записи: HashSnapshotEntry, затем ключ с завершающим нулём,
+ *     дополненные до 8 байт.
+ *
+ * Числа хранятся в порядке байт машины, на которой файл записан; файл с
+ * другим порядком байт не откроется. Хеш-функция записывается номером,
+ * поэтому сохранить можно только таблицу со встроенной функцией.
+ */
+
+#define HASH_SNAPSHOT_PAGE 4096                   ///< Выравнивание секций файла
+#define HASH_SNAPSHOT_VERSION 1                   ///< Версия формата
+#define HASH_SNAPSHOT_BYTE_ORDER 0x01020304u      ///< Метка порядка байт
+
+static const char hashSnapshotMagic[8] = {'H', 'T', 'S', 'N', 'A', 'P', '\0', '\0'};
+
+/// @brief Встроенные хеш-функции; номер в файле - индекс в этом массиве плюс один
+static const HashTable_HashFunction hashSnapshotFunctions[] = {hashWy, hashXxh3, hashDjb2};
+
+/// @brief Заголовок файла снимка
+typedef struct {
+    char magic[8];                ///< hashSnapshotMagic
+    uint32_t version;             ///< HASH_SNAPSHOT_VERSION
+    uint32_t byteOrder;           ///< HASH_SNAPSHOT_BYTE_ORDER
+    uint32_t hashId;              ///< Номер хеш-функции в hashSnapshotFunctions плюс один
+    uint32_t reserved;            ///< Всегда 0
+    uint64_t seed;                ///< Зерно хеш-функции
+    uint64_t count;               ///< Количество элементов
+    uint64_t bucketCount;         ///< Количество бакетов (степень двойки)
+    uint64_t bucketsOffset;       ///< Смещение массива смещений бакетов от начала файла
+    uint64_t entriesOffset;       ///< Смещение секции записей от начала файла
+    uint64_t entriesSize;         ///< Размер секции записей в байтах
+} HashSnapshotHeader;
+
+/// @brief Запись снимка; сразу за ней следует ключ с завершающим нулём
+typedef struct {
+    uint32_t keyLength;           ///< Длина ключа без завершающего нуля
+    int32_t value;                ///< Значение
+} HashSnapshotEntry;
+
+/// @brief Размер записи вместе с ключом и выравниванием
+static inline uint64_t snapshotEntrySize(uint64_t keyLength) {
+    return (sizeof(HashSnapshotEntry) + keyLength + 1 + 7) & ~(uint64_t)7;
+}
+
+/// @brief Смещение, округлённое вверх до границы страницы
+static inline uint64_t snapshotPageAlign(uint64_t offset) {
+    return (offset + HASH_SNAPSHOT_PAGE - 1) & ~(uint64_t)(HASH_SNAPSHOT_PAGE - 1);
+}
+
+/// @brief Ищет ключ в отображённом снимке
+/// @param table Указатель на хеш-таблицу
+/// @param key Ключ
+/// @param hash Хеш ключа (tableHash)
+/// @return Запись или NULL, если ключа нет
+static const HashSnapshotEntry* mappedFind(const HashTable* table, const char* key, uint64_t hash) {
+    const HashSnapshotHeader* header = (const HashSnapshotHeader*)table->mapping;
+    const uint64_t* offsets = (const uint64_t*)(table->mapping + header->bucketsOffset);
+    const char* entries = table->mapping + header->entriesOffset;
+    size_t bucket = (size_t)hash & (table->size - 1);
+    uint64_t position = offsets[bucket];
+    uint64_t end = offsets[bucket + 1];
+    size_t length = strlen(key);
+
+    // Смещения проверяются при каждом поиске, чтобы повреждённый файл не увёл за отображение
+    if (end > header->entriesSize) return NULL;
+
+    while (position + sizeof(HashSnapshotEntry) <= end) {
+        const HashSnapshotEntry* entry = (const HashSnapshotEntry*)(entries + position);
+
+        HASH_STATS(statsProbes++);
+
+        if (entry->keyLength == length && position + sizeof(HashSnapshotEntry) + length < end &&
+            memcmp(entry + 1, key, length) == 0)
+            return entry;
+
+        position += snapshotEntrySize(entry->keyLength);
+    }
+
+    return NULL;
+}
+
+/// @brief Вызывает функцию для каждого элемента таблицы любого вида
+/// @details Потокобезопасную таблицу вызывающий должен заблокировать сам.
+/// @param table Указатель на хеш-таблицу
+/// @param visit Функция, получающая ключ и значение
+/// @param context Параметр функции
+static void tableForEach(HashTable* table, void (*visit)(void* context, const char* key, int value), void* context) {
+    if (table->backend == HASH_TABLE_BACKEND_MAPPED) {
+        const HashSnapshotHeader* header = (const HashSnapshotHeader*)table->mapping;
+        const char* entries = table->mapping + header->entriesOffset;
+
+        for (uint64_t position = 0; position + sizeof(HashSnapshotEntry) <= header->entriesSize;) {
+            const HashSnapshotEntry* entry = (const HashSnapshotEntry*)(entries + position);
+
+            if (position + sizeof(HashSnapshotEntry) + entry->keyLength >= header->entriesSize) break;
+
+            visit(context, (const char*)(entry + 1), entry->value);
+            position += snapshotEntrySize(entry->keyLength);
+        }
+        return;
+    }
+
+    if (table->backend == HASH_TABLE_BACKEND_SHARDED) {
+        for (size_t i = 0; i < table->shardCount; i++) {
+            HashShardBuckets* buckets = table->shards[i].buckets;
+
+            for (size_t j = 0; j < buckets->size; j++)
+                for (HashNode* node = buckets->heads[j]; node; node = node->next)
+                    visit(context, hashKeyData(&node->key), node->value);
+        }
+        return;
+    }
+
+    if (table->backend == HASH_TABLE_BACKEND_FLAT || table->backend == HASH_TABLE_BACKEND_PERFECT) {
+        for (size_t i = 0; i < table->size; i++)
+            if (!table->ctrl || !(table->ctrl[i] & 0x80))
+                visit(context, hashKeyData(&table->slots[i].key), table->slots[i].value);
+        return;
+    }
+
+    for (size_t i = 0; i < table->size; i++)
+        for (HashNode* node = table->buckets[i]; node; node = node->next)
+            visit(context, hashKeyData(&node->key), node->value);
+
+    for (size_t i = table->rehashIndex; i < table->oldSize; i++)
+        for (HashNode* node = table->oldBuckets[i]; node; node = node->next)
+            visit(context, hashKeyData(&node->key), node->value);
+}
+
+/// @brief Состояние записи снимка
+typedef struct {
+    const HashTable* table;       ///< Сохраняемая таблица
+    uint64_t* offsets;            ///< Смещения бакетов (при заполнении - курсоры записи)
+    char* entries;                ///< Секция записей или NULL на первом проходе
+    uint64_t mask;                ///< bucketCount - 1
+} HashSnapshotWriter;
+
+/// @brief Первый проход: считает размер записей каждого бакета
+static void snapshotMeasure(void* context, const char* key, int value) {
+    HashSnapshotWriter* writer = (HashSnapshotWriter*)context;
+    size_t length = strlen(key);
+
+    (void)value;
+    writer->offsets[(writer->table->hash(key, length, writer->table->seed) & writer->mask) + 1] +=
+        snapshotEntrySize(length);
+}
+
+/// @brief Второй проход: раскладывает записи по бакетам
+static void snapshotFill(void* context, const char* key, int value) {
+    HashSnapshotWriter* writer = (HashSnapshotWriter*)context;
+    size_t length = strlen(key);
+    uint64_t* cursor = &writer->offsets[writer->table->hash(key, length, writer->table->seed) & writer->mask];
+    HashSnapshotEntry* entry = (HashSnapshotEntry*)(writer->entries + *cursor);
+
+    entry->keyLength = (uint32_t)length;
+    entry->value = value;
+    memcpy(entry + 1, key, length + 1);
+    *cursor += snapshotEntrySize(length);
+}
+
+/// @brief Записывает данные и дополняет файл нулями до границы страницы
+/// @return 1 в случае успеха, 0 при ошибке записи
+static int snapshotWriteSection(FILE* file, const void* data, uint64_t size) {
+    static const char zeros[HASH_SNAPSHOT_PAGE];
+    uint64_t padding = snapshotPageAlign(size) - size;
+
+    if (size && fwrite(data, 1, size, file) != size) return 0;
+
+    return padding == 0 || fwrite(zeros, 1, padding, file) == padding;
+}
+
+/// @brief Сохраняет таблицу в файл снимка
+/// @details Файл сначала пишется рядом под именем с суффиксом ".tmp" и только
+///          затем переименовывается, поэтому читатели старого снимка никогда не
+///          видят недописанный файл. Потокобезопасная таблица на время сохранения
+///          блокируется целиком. Ключи длиннее 4 ГБ не поддерживаются.
+/// @param table Указатель на хеш-таблицу (любого вида)
+/// @param path Путь к файлу
+/// @return Код ошибки (успех, ошибка выделения, ошибка ввода-вывода или
+///         недопустимая операция, если у таблицы не встроенная хеш-функция)
+HashTable_ErrorCode hashTableSave(HashTable* table, const char* path) {
+    HashSnapshotHeader header;
+    uint32_t hashId = 0;
+
+    for (size_t i = 0; i < sizeof(hashSnapshotFunctions) / sizeof(hashSnapshotFunctions[0]); i++)
+        if (table->hash == hashSnapshotFunctions[i]) hashId = (uint32_t)i + 1;
+
+    if (!hashId) return HASH_TABLE_INVALID_OPERATION;
+
+    // Оба прохода должны увидеть одни и те же элементы
+    if (table->backend == HASH_TABLE_BACKEND_SHARDED)
+        for (size_t i = 0; i < table->shardCount; i++) pthread_mutex_lock(&table->shards[i].lock);
+
+    size_t count = table->backend == HASH_TABLE_BACKEND_SHARDED ? shardedCount(table) : table->count;
+    uint64_t bucketCount = roundUpPowerOfTwo(count ? count : 1);
+    HashSnapshotWriter writer = {table, (uint64_t*)calloc(bucketCount + 1, sizeof(uint64_t)), NULL, bucketCount - 1};
+
+    uint64_t entriesSize = 0;
+
+    if (writer.offsets) {
+        tableForEach(table, snapshotMeasure, &writer);
+        for (uint64_t i = 0; i < bucketCount; i++) writer.offsets[i + 1] += writer.offsets[i];
+        entriesSize = writer.offsets[bucketCount];
+    }
+
+    // Записи раскладываются, сдвигая начало каждого бакета к его концу;
+    // после этого сдвиг массива на один элемент возвращает начала бакетов
+    writer.entries = writer.offsets ? (char*)calloc(1, entriesSize ? entriesSize : 1) : NULL;
+    if (writer.entries) tableForEach(table, snapshotFill, &writer);
+
+    if (table->backend == HASH_TABLE_BACKEND_SHARDED)
+        for (size_t i = 0; i < table->shardCount; i++) pthread_mutex_unlock(&table->shards[i].lock);
+
+    if (!writer.entries) {
+        free(writer.offsets);
+        return HASH_TABLE_ALLOCATION_ERROR;
+    }
+
+    memmove(writer.offsets + 1, writer.offsets, bucketCount * sizeof(uint64_t));
+    writer.offsets[0] = 0;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, hashSnapshotMagic, sizeof(header.magic));
+    header.version = HASH_SNAPSHOT_VERSION;
+    header.byteOrder = HASH_SNAPSHOT_BYTE_ORDER;
+    header.hashId = hashId;
+    header.seed = table->seed;
+    header.count = count;
+    header.bucketCount = bucketCount;
+    header.bucketsOffset = snapshotPageAlign(sizeof(header));
+    header.entriesOffset = header.bucketsOffset + snapshotPageAlign((bucketCount + 1) * sizeof(uint64_t));
+    header.entriesSize = entriesSize;
+
+    size_t pathLength = strlen(path);
+    char* temporary = (char*)malloc(pathLength + sizeof(".tmp"));
+    FILE* file = temporary ? fopen(strcat(strcpy(temporary, path), ".tmp"), "wb") : NULL;
+    int written = file && snapshotWriteSection(file, &header, sizeof(header)) &&
+                  snapshotWriteSection(file, writer.offsets, (bucketCount + 1) * sizeof(uint64_t)) &&
+                  snapshotWriteSection(file, writer.entries, entriesSize) && fflush(file) == 0 &&
+                  fsync(fileno(file)) == 0;
+
+    if (file && fclose(file) != 0) written = 0;
+    if (written && rename(temporary, path) != 0) written = 0;
+    if (!written && file) remove(temporary);
+
+    free(temporary);
+    free(writer.entries);
+    free(writer.offsets);
+
+    if (!temporary) return HASH_TABLE_ALLOCATION_ERROR;
+
+    return written ? HASH_TABLE_SUCCESS : HASH_TABLE_IO_ERROR;
+}
+
+/// @brief Открывает файл снимка как таблицу только для чтения
+/// @details Файл отображается в память целиком; проверяется только заголовок,
+///          так что время открытия не зависит от размера таблицы. Вставка и
+///          удаление возвращают HASH_TABLE_INVALID_OPERATION. Отображение
+///          освобождается hashTableClear.
+/// @param table Указатель на хеш-таблицу
+/// @param path Путь к файлу
+/// @return Код ошибки (успех или ошибка ввода-вывода, в том числе неверный формат)
+HashTable_ErrorCode hashTableOpenMapped(HashTable* table, const char* path) {
+    struct stat info;
+    int fd = open(path, O_RDONLY);
+
+    memset(table, 0, sizeof(HashTable));
+
+    if (fd < 0) return HASH_TABLE_IO_ERROR;
+
+    if (fstat(fd, &info) != 0 || (uint64_t)info.st_size < sizeof(HashSnapshotHeader)) {
+        close(fd);
+        return HASH_TABLE_IO_ERROR;
+    }
+
+    size_t fileSize = (size_t)info.st_size;
+    void* mapping = mmap(NULL, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (mapping == MAP_FAILED) return HASH_TABLE_IO_ERROR;
+
+    const HashSnapshotHeader* header = (const HashSnapshotHeader*)mapping;
+    size_t functionCount = sizeof(hashSnapshotFunctions) / sizeof(hashSnapshotFunctions[0]);
+    int valid = memcmp(header->magic, hashSnapshotMagic, sizeof(header->magic)) == 0 &&
+                header->version == HASH_SNAPSHOT_VERSION && header->byteOrder == HASH_SNAPSHOT_BYTE_ORDER &&
+                header->hashId >= 1 && header->hashId <= functionCount && header->bucketCount != 0 &&
+                (header->bucketCount & (header->bucketCount - 1)) == 0 &&
+                header->bucketsOffset % HASH_SNAPSHOT_PAGE == 0 && header->bucketsOffset <= fileSize &&
+                header->bucketCount < (fileSize - header->bucketsOffset) / sizeof(uint64_t) &&
+                header->entriesOffset % HASH_SNAPSHOT_PAGE == 0 && header->entriesOffset <= fileSize &&
+                header->entriesSize <= fileSize - header->entriesOffset;
+
+    // Последнее смещение бакетов должно совпадать с размером секции записей
+    if (valid) {
+        const uint64_t* offsets = (const uint64_t*)((const char*)mapping + header->bucketsOffset);
+
+        valid = offsets[header->bucketCount] == header->entriesSize;
+    }
+
+    if (!valid) {
+        munmap(mapping, fileSize);
+        return HASH_TABLE_IO_ERROR;
+    }
+
+    table->backend = HASH_TABLE_BACKEND_MAPPED;
+    table->mapping = (const char*)mapping;
+    table->mappingSize = fileSize;
+    table->size = (size_t)header->bucketCount;
+    table->count = (size_t)header->count;
+    table->hash = hashSnapshotFunctions[header->hashId - 1];
+    table->seed = header->seed;
+
+    return HASH_TABLE_SUCCESS;
+}
+
+/*
+ * Минимальное идеальное хеширование (HASH_TABLE_BACKEND_PERFECT).
+ *
+ * Для словарей, которые строятся один раз и потом только читаются,
+ * hashTableBuildPerfect подбирает функцию, отображающую n известных ключей
+ * в n слотов без коллизий, по схеме PTHash:
+ *   - ключи раскладываются по pilotCount = 3n/8 бакетам, причём 60% ключей
+ *     попадает в первые 30% бакетов, чтобы большие бакеты были размещены,
+ *     пока таблица почти пуста;
+ *   - бакеты обрабатываются от больших к малым, и для каждого подбирается
+ *     наименьший пилот, при котором все его ключи попадают в свободные
+ *     позиции position(hash, pilot) из positions = n / 0.99 возможных;
+ *   - пилоты меньше 255 хранятся байтом; большие нужны только последним
+ *     бакетам, когда свободных позиций почти не осталось, и хранятся в
+ *     отсортированном массиве largePilots, а байт пилота равен 255;
+ *   - позиции за пределами [0, n) перенаправляются массивом remap в
+ *     оставшиеся свободными слоты, поэтому слотов ровно n.
+ * Пилоты занимают 3 бита на ключ, remap - около 0,3 бита на ключ, largePilots -
+ * доли бита. Поиск читает пилот и ровно один слот и сравнивает ключ, так что
+ * отсутствующий ключ распознаётся. Если при выбранном зерне какому-то бакету
+ * не хватило пилотов, построение повторяется с другим зерном, а после
+ * нескольких неудач - с большим запасом позиций.
+ */
+
+#define PERFECT_LARGE_PILOT 255         ///< Байт пилота, означающий "пилот в largePilots"
+#define PERFECT_MAX_PILOT (1u << 20)    ///< Сколько пилотов перебирать для одного бакета
+#define PERFECT_MAX_ATTEMPTS 16         ///< Сколько раз пробовать новое зерно
+
+/// @brief Отображает 32-битное значение в [0, range) без деления
+static inline size_t perfectRange32(uint64_t value32, size_t range) {
+    return (size_t)((value32 * (uint64_t)range) >> 32);
+}
+
+/// @brief Бакет ключа с перекосом: 60% ключей в первые 30% бакетов
+static inline size_t perfectBucket(size_t pilotCount, uint64_t hash) {
+    size_t dense = pilotCount * 3 / 10;
+
+    if (dense && (uint32_t)hash < 0x9999999AU) return perfectRange32(hash >> 32, dense);
+
+    return dense + perfectRange32(hash >> 32, pilotCount - dense);
+}
+
+/// @brief Позиция ключа при заданном пилоте
+static inline size_t perfectPosition(size_t positions, uint64_t hash, uint32_t pilot) {
+    uint64_t mixed = (hash ^ (((uint64_t)pilot + 1) * 0x9E3779B97F4A7C15ULL)) * 0xBF58476D1CE4E5B9ULL;
+
+    return (size_t)(((__uint128_t)mixed * positions) >> 64);
+}
+
+/// @brief Пилот бакета
+/// @details largePilots хранит (бакет << 32) | пилот по возрастанию бакета.
+static inline uint32_t perfectPilot(const HashTable* table, size_t bucket) {
+    uint8_t pilot = table->pilots[bucket];
+
+    if (pilot != PERFECT_LARGE_PILOT) return pilot;
+
+    size_t low = 0, high = table->largePilotCount;
+
+    while (high - low > 1) {
+        size_t middle = (low + high) / 2;
+
+        if ((table->largePilots[middle] >> 32) <= bucket) low = middle;
+        else high = middle;
+    }
+
+    return (uint32_t)table->largePilots[low];
+}
+
+/// @brief Ищет ключ в таблице с идеальным хешированием
+/// @param table Указатель на хеш-таблицу
+/// @param key Ключ
+/// @param hash Хеш ключа (tableHash)
+/// @return Слот или NULL, если ключа нет
+static const HashSlot* perfectFind(const HashTable* table, const char* key, uint64_t hash) {
+    if (table->count == 0) return NULL;
+
+    size_t position = perfectPosition(table->positions, hash, perfectPilot(table, perfectBucket(table->pilotCount, hash)));
+
+    if (position >= table->count) position = table->remap[position - table->count];
+
+    const HashSlot* slot = &table->slots[position];
+
+    HASH_STATS(statsProbes++);
+
+    return strcmp(hashKeyData(&slot->key), key) == 0 ? slot : NULL;
+}
+
+/// @brief Сравнение 64-битных значений для qsort
+static int compareUint64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+/// @brief Сортирует ключи бакета по хешу вставками (бакеты маленькие)
+static void perfectSortBucket(uint32_t* keys, size_t size, const uint64_t* hashes) {
+    for (size_t i = 1; i < size; i++) {
+        uint32_t key = keys[i];
+        size_t j = i;
+
+        for (; j > 0 && hashes[keys[j - 1]] > hashes[key]; j--) keys[j] = keys[j - 1];
+
+        keys[j] = key;
+    }
+}
+
+/// @brief Одна попытка подобрать пилоты при заданных хешах
+/// @param table Таблица с заполненными pilotCount, positions, pilots
+/// @param hashes Хеши ключей
+/// @param n Количество ключей
+/// @param[out] placed Позиция каждого ключа
+/// @param keys Ключи (для различения одинаковых ключей и совпавших хешей)
+/// @return Код ошибки: успех, ключ уже существует (в наборе есть повторы),
+///         ошибка выделения или недопустимая операция, если нужно другое зерно
+static HashTable_ErrorCode perfectPlace(HashTable* table, const uint64_t* hashes, size_t n, uint32_t* placed,
+                                        const char* const* keys) {
+    size_t pilotCount = table->pilotCount;
+    uint32_t* start = (uint32_t*)calloc(pilotCount + 2, sizeof(uint32_t));
+    uint32_t* order = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+    uint32_t* buckets = (uint32_t*)malloc(pilotCount * sizeof(uint32_t));
+    uint64_t* taken = (uint64_t*)calloc(table->positions / 64 + 1, sizeof(uint64_t));
+    HashTable_ErrorCode result = HASH_TABLE_SUCCESS;
+    size_t maxSize = 0;
+    size_t largeCapacity = 0;
+
+    free(table->largePilots);
+    table->largePilots = NULL;
+    table->largePilotCount = 0;
+
+    if (!start || !order || !buckets || !taken) {
+        result = HASH_TABLE_ALLOCATION_ERROR;
+        goto done;
+    }
+
+    // Сортировка подсчётом: ключи, сгруппированные по бакетам
+    for (size_t i = 0; i < n; i++) start[perfectBucket(pilotCount, hashes[i]) + 2]++;
+    for (size_t b = 0; b < pilotCount; b++) start[b + 2] += start[b + 1];
+    for (size_t i = 0; i < n; i++) order[start[perfectBucket(pilotCount, hashes[i]) + 1]++] = (uint32_t)i;
+
+    // Теперь ключи бакета b - order[start[b] .. start[b + 1]); совпавшие хеши соседствуют
+    for (size_t b = 0; b < pilotCount; b++) {
+        size_t size = start[b + 1] - start[b];
+
+        if (size > maxSize) maxSize = size;
+        perfectSortBucket(order + start[b], size, hashes);
+
+        for (size_t j = start[b] + 1; j < start[b + 1]; j++) {
+            if (hashes[order[j]] != hashes[order[j - 1]]) continue;
+
+            result = strcmp(keys[order[j]], keys[order[j - 1]]) == 0 ? HASH_TABLE_ALREADY_EXISTS
+                                                                   : HASH_TABLE_INVALID_OPERATION;
+            goto done;
+        }
+    }
+
+    // Бакеты от больших к малым (сортировка подсчётом по размеру)
+    {
+        size_t* bySize = (size_t*)calloc(maxSize + 2, sizeof(size_t));
+
+        if (!bySize) {
+            result = HASH_TABLE_ALLOCATION_ERROR;
+            goto done;
+        }
+
+        for (size_t b = 0; b < pilotCount; b++) bySize[maxSize - (start[b + 1] - start[b]) + 1]++;
+        for (size_t s = 0; s <= maxSize; s++) bySize[s + 1] += bySize[s];
+        for (size_t b = 0; b < pilotCount; b++) buckets[bySize[maxSize - (start[b + 1] - start[b])]++] = (uint32_t)b;
+
+        free(bySize);
+    }
+
+    for (size_t k = 0; k < pilotCount; k++) {
+        size_t b = buckets[k];
+        size_t size = start[b + 1] - start[b];
+        uint32_t pilot;
+
+        if (size == 0) {
+            table->pilots[b] = 0;
+            continue;
+        }
+
+        for (pilot = 0; pilot < PERFECT_MAX_PILOT; pilot++) {
+            size_t j;
+
+            // Занимаем позиции по одной, чтобы заметить совпадения внутри бакета
+            for (j = 0; j < size; j++) {
+                uint32_t key = order[start[b] + j];
+                size_t position = perfectPosition(table->positions, hashes[key], pilot);
+
+                if (taken[position / 64] & (1ULL << (position % 64))) break;
+
+                taken[position / 64] |= 1ULL << (position % 64);
+                placed[key] = (uint32_t)position;
+            }
+
+            if (j == size) break;
+
+            while (j-- > 0) taken[placed[order[start[b] + j]] / 64] &= ~(1ULL << (placed[order[start[b] + j]] % 64));
+        }
+
+        if (pilot == PERFECT_MAX_PILOT) {
+            result = HASH_TABLE_INVALID_OPERATION;
+            goto done;
+        }
+
+        if (pilot >= PERFECT_LARGE_PILOT) {
+            if (table->largePilotCount == largeCapacity) {
+                size_t capacity = largeCapacity ? largeCapacity * 2 : 64;
+                uint64_t* grown = (uint64_t*)realloc(table->largePilots, capacity * sizeof(uint64_t));
+
+                if (!grown) {
+                    result = HASH_TABLE_ALLOCATION_ERROR;
+                    goto done;
+                }
+
+                table->largePilots = grown;
+                largeCapacity = capacity;
+            }
+
+            table->largePilots[table->largePilotCount++] = ((uint64_t)b << 32) | pilot;
+            pilot = PERFECT_LARGE_PILOT;
+        }
+
+        table->pilots[b] = (uint8_t)pilot;
+    }
+
+    if (table->largePilotCount) qsort(table->largePilots, table->largePilotCount, sizeof(uint64_t), compareUint64);
+
+    // Позиции за пределами [0, n) по порядку отдаём свободным слотам; незанятые
+    // указывают на слот 0, где сравнение ключа отсеет отсутствующий ключ
+    size_t nextFree = 0;
+
+    for (size_t position = n; position < table->positions; position++) {
+        table->remap[position - n] = 0;
+
+        if (!(taken[position / 64] & (1ULL << (position % 64)))) continue;
+
+        while (taken[nextFree / 64] & (1ULL << (nextFree % 64))) nextFree++;
+
+        table->remap[position - n] = (uint32_t)nextFree++;
+    }
+
+done:
+    free(start);
+    free(order);
+    free(buckets);
+    free(taken);
+
+    return result;
+}
+
+/// @brief Строит таблицу с минимальным идеальным хешированием по набору ключей
+/// @details Таблица только для чтения: вставка и удаление возвращают
+///          HASH_TABLE_INVALID_OPERATION. Поиск читает ровно один слот.
+///          Память освобождается hashTableClear.
+/// @param table Указатель на хеш-таблицу
+/// @param keys Ключи (без повторов, не больше UINT32_MAX)
+/// @param values Значения ключей
+/// @param n Количество ключей
+/// @return Код ошибки (успех, ключ уже существует, ошибка выделения или
+///         недопустимая операция, если подобрать функцию не удалось)
+HashTable_ErrorCode hashTableBuildPerfect(HashTable* table, const char* const* keys, const int* values, size_t n) {
+    memset(table, 0, sizeof(HashTable));
+
+    table->backend = HASH_TABLE_BACKEND_PERFECT;
+    table->hash = hashWy;
+
+    if (n > UINT32_MAX) return HASH_TABLE_INVALID_OPERATION;
+
+    uint64_t* hashes = (uint64_t*)malloc((n ? n : 1) * sizeof(uint64_t));
+    uint32_t* placed = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+    HashTable_ErrorCode result = hashes && placed ? HASH_TABLE_INVALID_OPERATION : HASH_TABLE_ALLOCATION_ERROR;
+    uint64_t seed = hashRandomSeed();
+
+    table->pilotCount = n * 3 / 8 + 1;
+    table->pilots = (uint8_t*)malloc(table->pilotCount);
+
+    if (!table->pilots) result = HASH_TABLE_ALLOCATION_ERROR;
+
+    for (int attempt = 0; attempt < PERFECT_MAX_ATTEMPTS && result == HASH_TABLE_INVALID_OPERATION; attempt++) {
+        // Каждые 4 неудачи удваиваем запас свободных позиций
+        size_t slack = (n / 100 + 1) << (attempt / 4);
+
+        table->seed = hashAvalanche(seed + (uint64_t)attempt);
+        table->positions = n + slack;
+
+        free(table->remap);
+        table->remap = (uint32_t*)malloc(slack * sizeof(uint32_t));
+
+        if (!table->remap) {
+            result = HASH_TABLE_ALLOCATION_ERROR;
+            break;
+        }
+
+        for (size_t i = 0; i < n; i++) hashes[i] = table->hash(keys[i], strlen(keys[i]), table->seed);
+
+        result = perfectPlace(table, hashes, n, placed, keys);
+    }
+
+    if (result == HASH_TABLE_SUCCESS) {
+        table->slots = (HashSlot*)malloc((n ? n : 1) * sizeof(HashSlot));
+
+        if (!table->slots) result = HASH_TABLE_ALLOCATION_ERROR;
+
+        for (size_t i = 0; i < n && result == HASH_TABLE_SUCCESS; i++) {
+            size_t position = placed[i] < n ? placed[i] : table->remap[placed[i] - n];
+
+            result = hashKeyInit(&table->slots[position].key, keys[i], &table->arena);
+            table->slots[position].value = values[i];
+        }
+    }
+
+    free(hashes);
+    free(placed);
+
+    if (result != HASH_TABLE_SUCCESS) {
+        free(table->pilots);
+        free(table->remap);
+        free(table->largePilots);
+        free(table->slots);
+        arenaRelease(&table->arena);
+        memset(table, 0, sizeof(HashTable));
+        return result;
+    }
+
+    table->size = n;
+    table->count = n;
+
+    return HASH_TABLE_SUCCESS;
+}
+
+/// @brief Вставляет новую пару ключ-значение в таблицу, если ключа нет
+/// @param table Указатель на хеш-таблицу
+/// @param key Ключ
+/// @param value Значение
+/// @return Код ошибки (успех, уже существует или ошибка выделения)
+HashTable_ErrorCode hashTableInsertUnique(HashTable* table, const char* key, int value) {
+    HASH_STATS(statsAdd(&table->stats.inserts, 1));
+
+    if (table->backend == HASH_TABLE_BACKEND_MAPPED || table->backend == HASH_TABLE_BACKEND_PERFECT)
+        return HASH_TABLE_INVALID_OPERATION;
+    if (table->backend == HASH_TABLE_BACKEND_FLAT) return flatInsertUnique(table, key, value);
+    if (table->backend == HASH_TABLE_BACKEND_SHARDED) return shardedInsertUnique(table, key, value);
+
+    chainedRehashStep(table);
+
+    HashNode** bucket = chainedBucket(table, key);
+    HashNode* node = *bucket;
+
+    while (node) {
+        if (strcmp(hashKeyData(&node->key), key) == 0) return HASH_TABLE_ALREADY_EXISTS;
+        
+        node = node->next;
+    }
+
+    node = nodeAlloc(&table->arena, &table->freeNodes);
+
+    if (!node) return HASH_TABLE_ALLOCATION_ERROR;
+
+    if (hashKeyInit(&node->key, key, &table->arena) != HASH_TABLE_SUCCESS) {
+        node->next = table->freeNodes;
+        table->freeNodes = node;
+        return HASH_TABLE_ALLOCATION_ERROR;
+    }
+
+    node->value = value;
+    node->next = *bucket;
+    *bucket = node;
+    table->count++;
+
+    chainedMaybeGrow(table);
+
+    return HASH_TABLE_SUCCESS;
+}
+
+/// @brief Проверка наличия ключа без учёта статистики (см. hashTableContains)
+static HashTable_ErrorCode tableContains(HashTable* table, const char* key) {
+    if (table->backend == HASH_TABLE_BACKEND_FLAT)
+        return flatFind(table, key, tableHash(table, key)) != HASH_TABLE_NOT_FOUND ? HASH_TABLE_SUCCESS
+                                                                          : HASH_TABLE_KEY_NOT_FOUND;
+    if (table->backend == HASH_TABLE_BACKEND_SHARDED) return shardedGet(table, key, NULL);
+    if (table->backend == HASH_TABLE_BACKEND_MAPPED)
+        return mappedFind(table, key, tableHash(table, key)) ? HASH_TABLE_SUCCESS : HASH_TABLE_KEY_NOT_FOUND;
+    if (table->backend == HASH_TABLE_BACKEND_PERFECT)
+        return perfectFind(table, key, tableHash(table, key)) ? HASH_TABLE_SUCCESS : HASH_TABLE_KEY_NOT_FOUND;
+
+    chainedRehashStep(table);
+
+    HashNode* node = *chainedBucket(table, key);
+
+    while (node) {
+        HASH_STATS(statsProbes++);
+
+        if (strcmp(hashKeyData(&node->key), key) == 0) return HASH_TABLE_SUCCESS;
+        
+        node = node->next;
+    }
+
+    return HASH_TABLE_KEY_NOT_FOUND;
+}
+
+/// @brief Поиск значения без учёта статистики (см. hashTableGet)
+static HashTable_ErrorCode tableGet(HashTable* table, const char* key, int* value) {
+    if (table->backend == HASH_TABLE_BACKEND_FLAT) {
+        size_t slot = flatFind(table, key, tableHash(table, key));
+
+        if (slot == HASH_TABLE_NOT_FOUND) return HASH_TABLE_KEY_NOT_FOUND;
+
+        *value = table->slots[slot].value;
+        return HASH_TABLE_SUCCESS;
+    }
+    if (table->backend == HASH_TABLE_BACKEND_SHARDED) return shardedGet(table, key, value);
+    if (table->backend == HASH_TABLE_BACKEND_MAPPED) {
+        const HashSnapshotEntry* entry = mappedFind(table, key, tableHash(table, key));
+
+        if (!entry) return HASH_TABLE_KEY_NOT_FOUND;
+
+        *value = entry->value;
+        return HASH_TABLE_SUCCESS;
+    }
+    if (table->backend == HASH_TABLE_BACKEND_PERFECT) {
+        const HashSlot* slot = perfectFind(table, key, tableHash(table, key));
+
+        if (!slot) return HASH_TABLE_KEY_NOT_FOUND;
+
+        *value = slot->value;
+        return HASH_TABLE_SUCCESS;
+    }
+
+    chainedRehashStep(table);
+
+    HashNode* node = *chainedBucket(table, key);
+
+    while (node) {
+        HASH_STATS(statsProbes++);
+
+        if (strcmp(hashKeyData(&node->key), key) == 0) {
+            *value = node->value;
+            return HASH_TABLE_SUCCESS;
+        }
+        node = node->next;
+    }
+
+    return HASH_TABLE_KEY_NOT_FOUND;
+}
+
+/// @brief Проверяет, существует ли ключ в таблице
+/// @param table Указатель на хеш-таблицу
+/// @param key Ключ
+/// @return Код ошибки (успех или ключ не найден)
+HashTable_ErrorCode hashTableContains(HashTable* table, const char* key) {
+    HASH_STATS(statsProbes = 0);
+
+    HashTable_ErrorCode result = tableContains(table, key);
+
+    HASH_STATS(statsRecordLookup(table, result == HASH_TABLE_SUCCESS));
+
+    return result;
+}
+
+/// @brief Возвращает значение по ключу из хеш-таблицы
+/// @param table Указатель на хеш-таблицу
+/// @param key Ключ
+/// @param[out] value Указатель для сохранения значения
+/// @return Код ошибки (успех или ключ не найден)
+HashTable_ErrorCode hashTableGet(HashTable* table, const char* key, int* value) {
+    HASH_STATS(statsProbes = 0);
+
+    HashTable_ErrorCode result = tableGet(table, key, value);
+
+    HASH_STATS(statsRecordLookup(table, result == HASH_TABLE_SUCCESS));
+
+    return result;
+}
+
+#define HASH_TABLE_BATCH_WINDOW 16    ///< Сколько ключей пакета обрабатывается одновременно
+
+/// @brief Пакетный поиск в таблице с цепочками (см. hashTableGetBatch)
+static size_t chainedGetBatch(HashTable* table, const char* const* keys, size_t n, int* values,
+                              HashTable_ErrorCode* status) {
+    HashNode** buckets[HASH_TABLE_BATCH_WINDOW];
+    HashNode* heads[HASH_TABLE_BATCH_WINDOW];
+    size_t found = 0;
+
+    for (size_t base = 0; base < n; base += HASH_TABLE_BATCH_WINDOW) {
+        size_t window = n - base < HASH_TABLE_BATCH_WINDOW ? n - base : HASH_TABLE_BATCH_WINDOW;
+
+        chainedRehashStep(table);
+
+        // 1. Хешируем ключи окна и запрашиваем строки массива бакетов
+        for (size_t i = 0; i < window; i++) {
+            buckets[i] = chainedBucket(table, keys[base + i]);
+            __builtin_prefetch(buckets[i]);
+        }
+
+        // 2. Читаем головы цепочек и запрашиваем первые узлы (ключ лежит в узле)
+        for (size_t i = 0; i < window; i++) {
+            heads[i] = *buckets[i];
+            if (heads[i]) __builtin_prefetch(heads[i]);
+        }
+
+        // 3. К этому моменту большая часть узлов уже в кеше
+        for (size_t i = 0; i < window; i++) {
+            HashNode* node = heads[i];
+
+            while (node && strcmp(hashKeyData(&node->key), keys[base + i]) != 0) node = node->next;
+
+            if (node) {
+                values[base + i] = node->value;
+                status[base + i] = HASH_TABLE_SUCCESS;
+                found++;
+            } else {
+                status[base + i] = HASH_TABLE_KEY_NOT_FOUND;
+            }
+        }
+    }
+
+    return found;
+}
+
+/// @brief Пакетный поиск в плоской таблице (см. hashTableGetBatch)
+static size_t flatGetBatch(HashTable* table, const char* const* keys, size_t n, int* values,
+                           HashTable_ErrorCode* status) {
+    uint64_t hashes[HASH_TABLE_BATCH_WINDOW];
+    size_t groupMask = table->size / HASH_TABLE_GROUP_WIDTH - 1;
+    size_t found = 0;
+
+    for (size_t base = 0; base < n; base += HASH_TABLE_BATCH_WINDOW) {
+        size_t window = n - base < HASH_TABLE_BATCH_WINDOW ? n - base : HASH_TABLE_BATCH_WINDOW;
+
+        // Запрашиваем управляющие байты и начало слотов стартовой группы каждого ключа
+        for (size_t i = 0; i < window; i++) {
+            hashes[i] = tableHash(table, keys[base + i]);
+
+            size_t group = (size_t)(hashes[i] >> 7) & groupMask;
+
+            __builtin_prefetch(table->ctrl + group * HASH_TABLE_GROUP_WIDTH);
+            __builtin_prefetch(table->slots + group * HASH_TABLE_GROUP_WIDTH);
+        }
+
+        for (size_t i = 0; i < window; i++) {
+            size_t slot = flatFind(table, keys[base + i], hashes[i]);
+
+            if (slot != HASH_TABLE_NOT_FOUND) {
+                values[base + i] = table->slots[slot].value;
+                status[base + i] = HASH_TABLE_SUCCESS;
+                found++;
+            } else {
+                status[base + i] = HASH_TABLE_KEY_NOT_FOUND;
+            }
+        }
+    }
+
+    return found;
+}
+
+/// @brief Пакетный поиск в потокобезопасной таблице (см. hashTableGetBatch)
+/// @details Всё окно читается внутри одной секции читателя.
+static size_t shardedGetBatch(HashTable* table, const char* const* keys, size_t n, int* values,
+                              HashTable_ErrorCode* status) {
+    uint64_t hashes[HASH_TABLE_BATCH_WINDOW];
+    HashNode** heads[HASH_TABLE_BATCH_WINDOW];
+    size_t found = 0;
+
+    for (size_t base = 0; base < n; base += HASH_TABLE_BATCH_WINDOW) {
+        size_t window = n - base < HASH_TABLE_BATCH_WINDOW ? n - base : HASH_TABLE_BATCH_WINDOW;
+
+        if (!epochEnter()) {
+            for (size_t i = 0; i < window; i++) {
+                status[base + i] = shardedGet(table, keys[base + i], &values[base + i]);
+                if (status[base + i] == HASH_TABLE_SUCCESS) found++;
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < window; i++) {
+            HashShard* shard = shardFor(table, hashes[i] = tableHash(table, keys[base + i]));
+            HashShardBuckets* buckets = __atomic_load_n(&shard->buckets, __ATOMIC_ACQUIRE);
+
+            heads[i] = &buckets->heads[hashes[i] & (buckets->size - 1)];
+            __builtin_prefetch(heads[i]);
+        }
+
+        for (size_t i = 0; i < window; i++) {
+            HashNode* node = __atomic_load_n(heads[i], __ATOMIC_ACQUIRE);
+
+            if (node) __builtin_prefetch(node);
+        }
+
+        for (size_t i = 0; i < window; i++) {
+            HashNode* node = __atomic_load_n(heads[i], __ATOMIC_ACQUIRE);
+
+            while (node && strcmp(hashKeyData(&node->key), keys[base + i]) != 0)
+                node = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+
+            if (node) {
+                values[base + i] = node->value;
+                status[base + i] = HASH_TABLE_SUCCESS;
+                found++;
+            } else {
+                status[base + i] = HASH_TABLE_KEY_NOT_FOUND;
+            }
+        }
+
+        epochExit();
+    }
+
+    return found;
+}
+
+/// @brief Пакетный поиск в снимке (см. hashTableGetBatch)
+static size_t mappedGetBatch(HashTable* table, const char* const* keys, size_t n, int* values,
+                             HashTable_ErrorCode* status) {
+    const HashSnapshotHeader* header = (const HashSnapshotHeader*)table->mapping;
+    const uint64_t* offsets = (const uint64_t*)(table->mapping + header->bucketsOffset);
+    const char* entries = table->mapping + header->entriesOffset;
+    uint64_t hashes[HASH_TABLE_BATCH_WINDOW];
+    size_t found = 0;
+
+    for (size_t base = 0; base < n; base += HASH_TABLE_BATCH_WINDOW) {
+        size_t window = n - base < HASH_TABLE_BATCH_WINDOW ? n - base : HASH_TABLE_BATCH_WINDOW;
+
+        // Запрашиваем смещения бакетов, затем первые записи бакетов
+        for (size_t i = 0; i < window; i++) {
+            hashes[i] = tableHash(table, keys[base + i]);
+            __builtin_prefetch(&offsets[hashes[i] & (table->size - 1)]);
+        }
+
+        for (size_t i = 0; i < window; i++) {
+            uint64_t position = offsets[hashes[i] & (table->size - 1)];
+
+            if (position < header->entriesSize) __builtin_prefetch(entries + position);
+        }
+
+        for (size_t i = 0; i < window; i++) {
+            const HashSnapshotEntry* entry = mappedFind(table, keys[base + i], hashes[i]);
+
+            if (entry) {
+                values[base + i] = entry->value;
+                status[base + i] = HASH_TABLE_SUCCESS;
+                found++;
+            } else {
+                status[base + i] = HASH_TABLE_KEY_NOT_FOUND;
+            }
+        }
+    }
+
+    return found;
+}
+
+/// @brief Пакетный поиск в таблице с идеальным хешированием (см. hashTableGetBatch)
+static size_t perfectGetBatch(HashTable* table, const char* const* keys, size_t n, int* values,
+                              HashTable_ErrorCode* status) {
+    uint64_t hashes[HASH_TABLE_BATCH_WINDOW];
+    size_t found = 0;
+
+    for (size_t base = 0; base < n; base += HASH_TABLE_BATCH_WINDOW) {
+        size_t window = n - base < HASH_TABLE_BATCH_WINDOW ? n - base : HASH_TABLE_BATCH_WINDOW;
+
+        // Пилоты занимают мало места и обычно в кеше; запрашиваем сразу слоты
+        for (size_t i = 0; i < window && table->count; i++) {
+            hashes[i] = tableHash(table, keys[base + i]);
+
+            size_t bucket = perfectBucket(table->pilotCount, hashes[i]);
+            size_t position = perfectPosition(table->positions, hashes[i], perfectPilot(table, bucket));
+
+            if (position < table->count) __builtin_prefetch(&table->slots[position]);
+        }
+
+        for (size_t i = 0; i < window; i++) {
+            const HashSlot* slot = table->count ? perfectFind(table, keys[base + i], hashes[i]) : NULL;
+
+            if (slot) {
+                values[base + i] = slot->value;
+                status[base + i] = HASH_TABLE_SUCCESS;
+                found++;
+            } else {
+                status[base + i] = HASH_TABLE_KEY_NOT_FOUND;
+            }
+        }
+    }
+
+    return found;
+}
+
+/// @brief Пакетный поиск значений по массиву ключей
+/// @details Ключи обрабатываются окнами по HASH_TABLE_BATCH_WINDOW: сначала для всего
+///          окна вычисляются хеши и запрашиваются в кеш бакеты, затем первые узлы,
+///          и только потом ключи сравниваются. Промахи кеша разных ключей при этом
+///          перекрываются, а не ждут друг друга, как в цикле из hashTableGet.
+/// @param table Указатель на хеш-таблицу
+/// @param keys Массив ключей
+/// @param n Количество ключей
+/// @param[out] values Найденные значения (для ненайденных ключей элемент не меняется)
+/// @param[out] status Код результата для каждого ключа
+/// @return Количество найденных ключей
+size_t hashTableGetBatch(HashTable* table, const char* const* keys, size_t n, int* values,
+                         HashTable_ErrorCode* status) {
+    size_t found;
+
+    if (table->backend == HASH_TABLE_BACKEND_FLAT) found = flatGetBatch(table, keys, n, values, status);
+    else if (table->backend == HASH_TABLE_BACKEND_SHARDED) found = shardedGetBatch(table, keys, n, values, status);
+    else if (table->backend == HASH_TABLE_BACKEND_MAPPED) found = mappedGetBatch(table, keys, n, values, status);
+    else if (table->backend == HASH_TABLE_BACKEND_PERFECT) found = perfectGetBatch(table, keys, n, values, status);
+    else found = chainedGetBatch(table, keys, n, values, status);
+
+    // Длины поиска пакета в гистограмму не попадают: ключи окна ищутся вперемешку
+    HASH_STATS(statsAdd(&table->stats.lookups, n); statsAdd(&table->stats.hits, found);
+               statsAdd(&table->stats.misses, n - found));
+
+    return found;
+}
+
+/// @brief Возвращает текущее количество элементов в таблице
+/// @param table Указатель на хеш-таблицу
+/// @return Количество элементов
+size_t hashTableCount(HashTable* table) {
+    if (table->backend == HASH_TABLE_BACKEND_SHARDED) return shardedCount(table);
+
+    return table->count;
+}
+
+/// @brief Задаёт хеш-функцию и зерно пустой таблицы
+/// @details Полезно, когда нужен воспроизводимый порядок бакетов или своя функция.
+///          Встроенные функции: hashWy (по умолчанию), hashXxh3, hashDjb2.
+/// @param table Указатель на хеш-таблицу
+/// @param hash Хеш-функция
+/// @param seed Зерно
+/// @return Код ошибки (успех или недопустимая операция, если таблица не пуста)
+HashTable_ErrorCode hashTableSetHashFunction(HashTable* table, HashTable_HashFunction hash, uint64_t seed) {
+    if (!hash || hashTableCount(table) != 0 || table->backend == HASH_TABLE_BACKEND_MAPPED ||
+        table->backend == HASH_TABLE_BACKEND_PERFECT)
+        return HASH_TABLE_INVALID_OPERATION;
+
+    table->hash = hash;
+    table->seed = seed;
+
+    return HASH_TABLE_SUCCESS;
+}
+
+/// @brief Удаляет элемент из хеш-таблицы по ключу
+/// @param table Указатель на хеш-таблицу
+/// @param key Ключ
+/// @return Код ошибки (успех или ключ не найден)
+HashTable_ErrorCode hashTableRemove(HashTable* table, const char* key) {
+    HASH_STATS(statsAdd(&table->stats.removes, 1));
+
+    if (table->backend == HASH_TABLE_BACKEND_MAPPED || table->backend == HASH_TABLE_BACKEND_PERFECT)
+        return HASH_TABLE_INVALID_OPERATION;
+    if (table->backend == HASH_TABLE_BACKEND_FLAT) return flatRemove(table, key);
+    if (table->backend == HASH_TABLE_BACKEND_SHARDED) return shardedRemove(table, key);
+
+    chainedRehashStep(table);
+
+    HashNode** bucket = chainedBucket(table, key);
+    HashNode* node = *bucket;
+    HashNode* prev = NULL;
+
+    while (node) {
+        if (strcmp(hashKeyData(&node->key), key) == 0) {
+            if (prev) {
+                prev->next = node->next;
+            } else {
+                *bucket = node->next;
+            }
+            node->next = table->freeNodes;
+            table->freeNodes = node;
+            table->count--;
+            return HASH_TABLE_SUCCESS;
+        }
+        prev = node;
+        node = node->next;
+    }
+    return HASH_TABLE_KEY_NOT_FOUND;
+}
+
+/*
+ * Курсор обхода.
+ *
+ * hashTableIterNext выдаёт указатели на ключ и значение прямо внутри
+ * таблицы, ничего не копируя и не выделяя. Позиция обхода целиком хранится
+ * в HashTableIter, поэтому обход можно прервать и продолжить позже (например,
+ * обрабатывать по тысяче элементов за такт), меняя таблицу между вызовами.
+ *
+ * Гарантии при изменении таблицы между вызовами:
+ *   - ключ, который был в таблице от hashTableIterBegin до конца обхода,
+ *     будет выдан хотя бы один раз;
+ *   - вставки (в том числе вызвавшие рост таблицы) могут привести к
+ *     повторной выдаче уже пройденных ключей; новые ключи могут быть как
+ *     выданы, так и пропущены;
+ *   - удалять последний выданный элемент нужно через hashTableIterRemove;
+ *     удаление других ключей во время обхода таблицы с цепочками может
+ *     привести к пропуску одного соседнего ключа в том же бакете;
+ *   - выданные указатели действительны до следующего изменения таблицы.
+ *
+ * Таблица с цепочками обходится курсором в обратном двоичном порядке бакетов
+ * (как SCAN в Redis): при удвоении таблицы ещё не пройденные бакеты остаются
+ * впереди курсора. Перед началом каждого бакета во время перехеширования
+ * соответствующий старый бакет переносится вне очереди. Плоская таблица и
+ * таблица с идеальным хешированием обходятся по индексу слота; если между вызовами она была перестроена,
+ * обход начинается заново. Потокобезопасная таблица и снимок (значения в нём
+ * только для чтения) курсор не поддерживают.
+ */
+
+/// @brief Позиция обхода хеш-таблицы
+typedef struct {
+    uint64_t cursor;              ///< Номер бакета в обратном двоичном порядке или индекс слота
+    size_t skip;                  ///< Сколько узлов текущего бакета уже выдано
+    size_t resizeCount;           ///< table->resizeCount, при котором получена позиция
+    const char* lastKey;          ///< Последний выданный ключ (для hashTableIterRemove)
+    int done;                     ///< 1, если обход завершён
+} HashTableIter;
+
+/// @brief Переставляет биты 64-битного числа в обратном порядке
+static uint64_t reverseBits(uint64_t value) {
+    value = ((value >> 1) & 0x5555555555555555ULL) | ((value & 0x5555555555555555ULL) << 1);
+    value = ((value >> 2) & 0x3333333333333333ULL) | ((value & 0x3333333333333333ULL) << 2);
+    value = ((value >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((value & 0x0F0F0F0F0F0F0F0FULL) << 4);
+
+    return __builtin_bswap64(value);
+}
+
+/// @brief Начинает обход таблицы
+/// @param table Указатель на хеш-таблицу
+/// @param[out] iter Позиция обхода
+/// @return Код ошибки (успех или недопустимая операция для потокобезопасной таблицы и снимка)
+HashTable_ErrorCode hashTableIterBegin(HashTable* table, HashTableIter* iter) {
+    memset(iter, 0, sizeof(HashTableIter));
+    iter->resizeCount = table->resizeCount;
+
+    if (table->backend == HASH_TABLE_BACKEND_SHARDED || table->backend == HASH_TABLE_BACKEND_MAPPED) {
+        iter->done = 1;
+        return HASH_TABLE_INVALID_OPERATION;
+    }
+
+    return HASH_TABLE_SUCCESS;
+}
+
+/// @brief Шаг обхода плоской таблицы (см. hashTableIterNext)
+static int flatIterNext(HashTable* table, HashTableIter* iter, const char** key, int** value) {
+    if (iter->resizeCount != table->resizeCount) {
+        iter->resizeCount = table->resizeCount;
+        iter->cursor = 0;
+    }
+
+    while (iter->cursor < table->size) {
+        size_t index = (size_t)iter->cursor++;
+
+        if (table->ctrl && (table->ctrl[index] & 0x80)) continue;
+
+        iter->lastKey = hashKeyData(&table->slots[index].key);
+        if (key) *key = iter->lastKey;
+        if (value) *value = &table->slots[index].value;
+
+        return 1;
+    }
+
+    iter->done = 1;
+
+    return 0;
+}
+
+/// @brief Шаг обхода таблицы с цепочками (см. hashTableIterNext)
+static int chainedIterNext(HashTable* table, HashTableIter* iter, const char** key, int** value) {
+    if (iter->resizeCount != table->resizeCount) {
+        // Узлы текущего бакета могли разойтись по новым бакетам: проходим его заново
+        iter->resizeCount = table->resizeCount;
+        iter->skip = 0;
+    }
+
+    while (!iter->done) {
+        size_t mask = table->size - 1;
+        size_t index = (size_t)iter->cursor & mask;
+
+        if (iter->skip == 0 && table->oldBuckets) chainedMigrateBucket(table, index & (table->oldSize - 1));
+
+        HashNode* node = table->buckets[index];
+        for (size_t i = 0; node && i < iter->skip; i++) node = node->next;
+
+        if (node) {
+            iter->skip++;
+            iter->lastKey = hashKeyData(&node->key);
+            if (key) *key = iter->lastKey;
+            if (value) *value = &node->value;
+
+            return 1;
+        }
+
+        // Следующий бакет: увеличиваем курсор, начиная со старшего бита маски
+        iter->skip = 0;
+        iter->cursor = reverseBits(reverseBits(iter->cursor | ~(uint64_t)mask) + 1);
+
+        if (iter->cursor == 0) iter->done = 1;
+    }
+
+    return 0;
+}
+
+/// @brief Выдаёт следующий элемент обхода без копирования
+/// @param table Указатель на хеш-таблицу
+/// @param iter Позиция обхода
+/// @param[out] key Указатель на ключ внутри таблицы (можно NULL)
+/// @param[out] value Указатель на значение внутри таблицы (можно NULL)
+/// @return 1, если элемент выдан; 0, если обход завершён
+int hashTableIterNext(HashTable* table, HashTableIter* iter, const char** key, int** value) {
+    if (iter->done) return 0;
+
+    iter->lastKey = NULL;
+
+    if (table->backend == HASH_TABLE_BACKEND_FLAT || table->backend == HASH_TABLE_BACKEND_PERFECT)
+        return flatIterNext(table, iter, key, value);
+
+    return chainedIterNext(table, iter, key, value);
+}
+
+/// @brief Добавляет длину в гистограмму и обновляет максимум
+static void statsHistogramAdd(uint64_t* histogram, size_t length, size_t* longest) {
+    histogram[length < HASH_TABLE_STATS_HISTOGRAM - 1 ? length : HASH_TABLE_STATS_HISTOGRAM - 1]++;
+
+    if (length > *longest) *longest = length;
+}
+
+/// @brief Длина цепочки, начинающейся с узла
+static size_t statsChainLength(const HashNode* node) {
+    size_t length = 0;
+
+    for (; node; node = node->next) length++;
+
+    return length;
+}
+
+/// @brief Выводит гистограмму как массив JSON
+static void statsHistogramDump(FILE* out, const char* name, const uint64_t* histogram) {
+    fprintf(out, "  \"%s\": [", name);
+    for (size_t i = 0; i < HASH_TABLE_STATS_HISTOGRAM; i++)
+        fprintf(out, "%s%llu", i ? ", " : "", (unsigned long long)histogram[i]);
+    fprintf(out, "]");
+}
+
+/// @brief Записывает состояние таблицы в формате JSON
+/// @details Загрузка, гистограмма длин цепочек и самая длинная цепочка вычисляются
+///          обходом таблицы при каждом вызове и доступны всегда. Для цепочек и снимка
+///          гистограмма строится по бакетам (включая пустые), для плоской таблицы -
+///          по элементам: сколько групп просматривает поиск элемента; у идеального
+///          хеширования все длины равны 1. Последняя корзина гистограмм -
+///          "16 и больше". Счётчики операций, доля попаданий и гистограмма длин
+///          поиска выводятся только при сборке с -DHASH_TABLE_STATS.
+/// @param table Указатель на хеш-таблицу (потокобезопасная блокируется по шардам)
+/// @param out Поток вывода
+void hashTableStatsDump(HashTable* table, FILE* out) {
+    static const char* const backends[] = {"chained", "flat", "sharded", "mapped", "perfect"};
+    uint64_t chains[HASH_TABLE_STATS_HISTOGRAM] = {0};
+    size_t longest = 0;
+    size_t size = table->size;
+    size_t count = hashTableCount(table);
+
+    if (table->backend == HASH_TABLE_BACKEND_CHAINED) {
+        for (size_t i = 0; i < table->size; i++) statsHistogramAdd(chains, statsChainLength(table->buckets[i]), &longest);
+        for (size_t i = table->rehashIndex; i < table->oldSize; i++)
+            if (table->oldBuckets[i]) statsHistogramAdd(chains, statsChainLength(table->oldBuckets[i]), &longest);
+    } else if (table->backend == HASH_TABLE_BACKEND_FLAT) {
+        size_t groupMask = table->size / HASH_TABLE_GROUP_WIDTH - 1;
+
+        for (size_t i = 0; i < table->size; i++) {
+            if (table->ctrl[i] & 0x80) continue;
+
+            size_t group = (size_t)(tableHash(table, hashKeyData(&table->slots[i].key)) >> 7) & groupMask;
+            size_t length = 1;
+
+            for (size_t step = 1; group != i / HASH_TABLE_GROUP_WIDTH; step++, length++)
+                group = (group + step) & groupMask;
+
+            statsHistogramAdd(chains, length, &longest);
+        }
+    } else if (table->backend == HASH_TABLE_BACKEND_SHARDED) {
+        size = 0;
+
+        for (size_t i = 0; i < table->shardCount; i++) {
+            HashShard* shard = &table->shards[i];
+
+            pthread_mutex_lock(&shard->lock);
+            size += shard->buckets->size;
+            for (size_t j = 0; j < shard->buckets->size; j++)
+                statsHistogramAdd(chains, statsChainLength(shard->buckets->heads[j]), &longest);
+            pthread_mutex_unlock(&shard->lock);
+        }
+    } else if (table->backend == HASH_TABLE_BACKEND_MAPPED) {
+        const HashSnapshotHeader* header = (const HashSnapshotHeader*)table->mapping;
+        const uint64_t* offsets = (const uint64_t*)(table->mapping + header->bucketsOffset);
+        const char* entries = table->mapping + header->entriesOffset;
+
+        for (size_t i = 0; i < table->size; i++) {
+            size_t length = 0;
+            uint64_t end = offsets[i + 1] <= header->entriesSize ? offsets[i + 1] : 0;
+
+            for (uint64_t position = offsets[i]; position + sizeof(HashSnapshotEntry) <= end; length++)
+                position += snapshotEntrySize(((const HashSnapshotEntry*)(entries + position))->keyLength);
+
+            statsHistogramAdd(chains, length, &longest);
+        }
+    } else {
+        for (size_t i = 0; i < table->count; i++) statsHistogramAdd(chains, 1, &longest);
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"backend\": \"%s\",\n", backends[table->backend]);
+    fprintf(out, "  \"count\": %zu,\n", count);
+    fprintf(out, "  \"size\": %zu,\n", size);
+    fprintf(out, "  \"load_factor\": %.4f,\n", size ? (double)count / (double)size : 0.0);
+    fprintf(out, "  \"longest_chain\": %zu,\n", longest);
+    statsHistogramDump(out, "chain_length_histogram", chains);
+
+#ifdef HASH_TABLE_STATS
+    HashTableStats stats = table->stats;
+
+    fprintf(out, ",\n");
+    fprintf(out, "  \"inserts\": %llu,\n", (unsigned long long)stats.inserts);
+    fprintf(out, "  \"lookups\": %llu,\n", (unsigned long long)stats.lookups);
+    fprintf(out, "  \"hits\": %llu,\n", (unsigned long long)stats.hits);
+    fprintf(out, "  \"misses\": %llu,\n", (unsigned long long)stats.misses);
+    fprintf(out, "  \"hit_ratio\": %.4f,\n", stats.lookups ? (double)stats.hits / (double)stats.lookups : 0.0);
+    fprintf(out, "  \"removes\": %llu,\n", (unsigned long long)stats.removes);
+    statsHistogramDump(out, "probe_length_histogram", stats.probeHistogram);
+#endif
+
+    fprintf(out, "\n}\n");
+}
+
+/// @brief Копирует очередной ключ в массив hashTableKeys
+static void keysCollect(void* context, const char* key, int value) {
+    char*** cursor = (char***)context;
+
+    (void)value;
+    *(*cursor)++ = strdup(key);
+}
+
+/// @brief Выводит все ключи хеш-таблицы
+/// @param table Указатель на хеш-таблицу
+/// @return Массив строк с ключами (пользователь должен освободить память)
+char** hashTableKeys(HashTable* table) {
+    if (table->backend == HASH_TABLE_BACKEND_MAPPED || table->backend == HASH_TABLE_BACKEND_PERFECT) {
+        char** keys = (char**)malloc((table->count ? table->count : 1) * sizeof(char*));
+        char** cursor = keys;
+
+        if (keys) tableForEach(table, keysCollect, &cursor);
+
+        return keys;
+    }
+
+    if (table->backend == HASH_TABLE_BACKEND_SHARDED) {
+        // Каждый шард копируется под своим мьютексом, поэтому элементы,
+        // добавленные после начала обхода, могут не попасть в результат
+        size_t capacity = shardedCount(table);
+        char** keys = (char**)malloc((capacity ? capacity : 1) * sizeof(char*));
+        size_t idx = 0;
+
+        if (!keys) return NULL;
+
+        for (size_t i = 0; i < table->shardCount; i++) {
+            HashShard* shard = &table->shards[i];
+
+            pthread_mutex_lock(&shard->lock);
+            for (size_t j = 0; j < shard->buckets->size; j++)
+                for (HashNode* node = shard->buckets->heads[j]; node && idx < capacity; node = node->next)
+                    keys[idx++] = strdup(hashKeyData(&node->key));
+            pthread_mutex_unlock(&shard->lock);
+        }
+
+        return keys;
+    }
+
+    char** keys = (char**)malloc(table->count * sizeof(char*));
+    if (!keys) return NULL;
+
+    size_t idx = 0;
+
+    if (table->backend == HASH_TABLE_BACKEND_FLAT) {
+        for (size_t i = 0; i < table->size; i++)
+            if (!(table->ctrl[i] & 0x80)) keys[idx++] = strdup(hashKeyData(&table->slots[i].key));
+
+        return keys;
+    }
+
+    for (size_t i = 0; i < table->size; i++) {
+        HashNode* node = table->buckets[i];
+        while (node) {
+            keys[idx++] = strdup(hashKeyData(&node->key));
+            node = node->next;
+        }
+    }
+    for (size_t i = table->rehashIndex; i < table->oldSize; i++) {
+        HashNode* node = table->oldBuckets[i];
+        while (node) {
+            keys[idx++] = strdup(hashKeyData(&node->key));
+            node = node->next;
+        }
+    }
+    return keys;
+}
+
+/// @brief Очистка хеш-таблицы и освобождение памяти
+/// @param table Указатель на хеш-таблицу
+void hashTableClear(HashTable* table) {
+    if (table->backend == HASH_TABLE_BACKEND_PERFECT) {
+        free(table->pilots);
+        free(table->remap);
+        free(table->largePilots);
+        free(table->slots);
+        table->pilots = NULL;
+        table->remap = NULL;
+        table->largePilots = NULL;
+        table->largePilotCount = 0;
+        table->slots = NULL;
+        table->count = 0;
+        table->size = 0;
+        arenaRelease(&table->arena);
+        return;
+    }
+
+    if (table->backend == HASH_TABLE_BACKEND_MAPPED) {
+        if (table->mapping) munmap((void*)table->mapping, table->mappingSize);
+        table->mapping = NULL;
+        table->mappingSize = 0;
+        table->count = 0;
+        return;
+    }
+
+    if (table->backend == HASH_TABLE_BACKEND_SHARDED) {
+        shardedClear(table);
+        return;
+    }
+
+    if (table->backend == HASH_TABLE_BACKEND_FLAT) {
+        free(table->ctrl);
+        free(table->slots);
+        table->ctrl = NULL;
+        table->slots = NULL;
+        table->growthLeft = 0;
+        table->count = 0;
+        arenaRelease(&table->arena);
+        return;
+    }
+
+    free(table->buckets);
+    table->buckets = NULL;
+
+    if (table->oldBuckets) {
+        free(table->oldBuckets);
+        table->oldBuckets = NULL;
+        table->oldSize = 0;
+        table->rehashIndex = 0;
+    }
+
+    table->count = 0;
+    table->freeNodes = NULL;
+    arenaRelease(&table->arena);
+}
+
+/// @brief Удаляет элемент, выданный последним вызовом hashTableIterNext
+/// @param table Указатель на хеш-таблицу
+/// @param iter Позиция обхода
+/// @return Код ошибки (успех или недопустимая операция, если удалять нечего)
+HashTable_ErrorCode hashTableIterRemove(HashTable* table, HashTableIter* iter) {
+    if (!iter->lastKey) return HASH_TABLE_INVALID_OPERATION;
+
+    HashTable_ErrorCode result = hashTableRemove(table, iter->lastKey);
+
+    // Узлы после удалённого сдвинулись в цепочке на одну позицию
+    if (result == HASH_TABLE_SUCCESS && table->backend == HASH_TABLE_BACKEND_CHAINED) iter->skip--;
+
+    iter->lastKey = NULL;
+
+    return result;
+}
+
+/// @brief Функция для запуска всех тестов хеш-таблицы
+void hashTableTests() {
+    HashTable table;
+    hashTableInit(&table, 10);
+    
+    // Тест: Вставка уникальных значений
+    assert(hashTableInsertUnique(&table, "apple", 100) == HASH_TABLE_SUCCESS);
+    assert(hashTableInsertUnique(&table, "banana", 200) == HASH_TABLE_SUCCESS);
+    assert(hashTableInsertUnique(&table, "apple", 300) == HASH_TABLE_ALREADY_EXISTS);
+
+    // Тест: Получение значения по ключу
+    int value;
+    assert(hashTableGet(&table, "apple", &value) == HASH_TABLE_SUCCESS);
+    assert(value == 100);
+
+    assert(hashTableGet(&table, "banana", &value) == HASH_TABLE_SUCCESS);
+    assert(value == 200);
+
+    // Тест: Получение значения для несуществующего ключа
+    assert(hashTableGet(&table, "cherry", &value) == HASH_TABLE_KEY_NOT_FOUND);
+
+    // Тест: Проверка существования ключа
+    assert(hashTableContains(&table, "apple") == HASH_TABLE_SUCCESS);
+    assert(hashTableContains(&table, "cherry") == HASH_TABLE_KEY_NOT_FOUND);
+
+    // Тест: Удаление элемента
+    assert(hashTableRemove(&table, "apple") == HASH_TABLE_SUCCESS);
+    assert(hashTableRemove(&table, "apple") == HASH_TABLE_KEY_NOT_FOUND);
+
+    // Тест: Вставка и проверка нового значения после удаления
+    assert(hashTableInsertUnique(&table, "apple", 300) == HASH_TABLE_SUCCESS);
+    assert(hashTableGet(&table, "apple", &value) == HASH_TABLE_SUCCESS);
+    assert(value == 300);
+
+    // Тест: Количество элементов
+    assert(hashTableCount(&table) == 2);
+
+    // Тест: Получение всех ключей
+    char** keys = hashTableKeys(&table);
+    assert(keys != NULL);
+    assert(strcmp(keys[0], "banana") == 0 || strcmp(keys[0], "apple") == 0);
+    assert(strcmp(keys[1], "banana") == 0 || strcmp(keys[1], "apple") == 0);
+    free(keys[0]);
+    free(keys[1]);
+    free(keys);
+
+    // Тест: Очистка таблицы
+    hashTableClear(&table);
+    assert(hashTableCount(&table) == 0);
+}
+
+/// @brief Тесты плоской таблицы (SwissTable)
+void hashTableFlatTests() {
+    HashTable table;
+    assert(hashTableInitFlat(&table, 4) == HASH_TABLE_SUCCESS);
+
+    // Тест: базовые операции те же, что и у таблицы с цепочками
+    int value;
+    assert(hashTableInsertUnique(&table, "apple", 100) == HASH_TABLE_SUCCESS);
+    assert(hashTableInsertUnique(&table, "banana", 200) == HASH_TABLE_SUCCESS);
+    assert(hashTableInsertUnique(&table, "apple", 300) == HASH_TABLE_ALREADY_EXISTS);
+    assert(hashTableGet(&table, "apple", &value) == HASH_TABLE_SUCCESS && value == 100);
+    assert(hashTableGet(&table, "cherry", &value) == HASH_TABLE_KEY_NOT_FOUND);
+    assert(hashTableContains(&table, "banana") == HASH_TABLE_SUCCESS);
+    assert(hashTableRemove(&table, "apple") == HASH_TABLE_SUCCESS);
+    assert(hashTableRemove(&table, "apple") == HASH_TABLE_KEY_NOT_FOUND);
+    assert(hashTableContains(&table, "apple") == HASH_TABLE_KEY_NOT_FOUND);
+    assert(hashTableCount(&table) == 1);
+
+    // Тест: расширение таблицы и надгробия при чередовании вставок и удалений
+    char key[32];
+    for (int i = 0; i < 10000; i++) {
+        snprintf(key, sizeof(key), "key-%d", i);
+        assert(hashTableInsertUnique(&table, key, i) == HASH_TABLE_SUCCESS);
+    }
+    for (int i = 0; i < 10000; i += 2) {
+        snprintf(key, sizeof(key), "key-%d", i);
+        assert(hashTableRemove(&table, key) == HASH_TABLE_SUCCESS);
+    }
+    for (int i = 0; i < 10000; i++) {
+        snprintf(key, sizeof(key), "key-%d", i);
+        HashTable_ErrorCode expected = (i % 2) ? HASH_TABLE_SUCCESS : HASH_TABLE_KEY_NOT_FOUND;
+        assert(hashTableGet(&table, key, &value) == expected);
+        if (expected == HASH_TABLE_SUCCESS) assert(value == i);
+    }
+    assert(hashTableCount(&table) == 5001);
+
+    char** keys = hashTableKeys(&table);
+    assert(keys != NULL);
+    for (size_t i = 0; i < hashTableCount(&table); i++) free(keys[i]);
+    free(keys);
+
+    hashTableClear(&table);
+    assert(hashTableCount(&table) == 0);
+}
+
+/// @brief Тесты автоматического роста таблицы с цепочками
+void hashTableGrowthTests() {
+    HashTable table;
+    hashTableInit(&table, 2);
+
+    // Тест: ключи доступны на любой стадии постепенного перехеширования
+    char key[32];
+    int value;
+    int sawRehash = 0;
+    for (int i = 0; i < 5000; i++) {
+        snprintf(key, sizeof(key), "grow-%d", i);
+        assert(hashTableInsertUnique(&table, key, i) == HASH_TABLE_SUCCESS);
+        assert(hashTableInsertUnique(&table, key, i) == HASH_TABLE_ALREADY_EXISTS);
+
+        if (table.oldBuckets) sawRehash = 1;
+
+        snprintf(key, sizeof(key), "grow-%d", i / 2);
+        assert(hashTableGet(&table, key, &value) == HASH_TABLE_SUCCESS && value == i / 2);
+    }
+    assert(sawRehash);
+    assert(table.size >= 5000 / HASH_TABLE_MAX_LOAD);
+
+    // Тест: удаление во время переноса бакетов
+    for (int i = 0; i < 5000; i += 3) {
+        snprintf(key, sizeof(key), "grow-%d", i);
+        assert(hashTableRemove(&table, key) == HASH_TABLE_SUCCESS);
+    }
+    for (int i = 0; i < 5000; i++) {
+        snprintf(key, sizeof(key), "grow-%d", i);
+        assert(hashTableContains(&table, key) == (i % 3 ? HASH_TABLE_SUCCESS : HASH_TABLE_KEY_NOT_FOUND));
+    }
+
+    size_t count = hashTableCount(&table);
+    char** keys = hashTableKeys(&table);
+    assert(keys != NULL);
+    for (size_t i = 0; i < count; i++) {
+        assert(hashTableContains(&table, keys[i]) == HASH_TABLE_SUCCESS);
+        free(keys[i]);
+    }
+    free(keys);
+
+    hashTableClear(&table);
+    assert(hashTableCount(&table) == 0);
+}
+
+/// @brief Тесты хранения ключей: короткие внутри узла, длинные в арене
+void hashTableKeyStorageTests() {
+    const char* inlineKey = "abcdefghijklmnopqrstuvw";      // 23 символа - ещё внутри узла
+    const char* externalKey = "abcdefghijklmnopqrstuvwx";   // 24 символа - уже в арене
+    char longKey[301];
+
+    memset(longKey, 'z', 300);
+    longKey[300] = '\0';
+
+    for (int backend = 0; backend < 3; backend++) {
+        HashTable table;
+        int value;
+
+        if (backend == 0) hashTableInit(&table, 4);
+        else if (backend == 1) assert(hashTableInitFlat(&table, 4) == HASH_TABLE_SUCCESS);
+        else assert(hashTableInitSharded(&table, 2, 4) == HASH_TABLE_SUCCESS);
+
+        assert(hashTableInsertUnique(&table, inlineKey, 1) == HASH_TABLE_SUCCESS);
+        assert(hashTableInsertUnique(&table, externalKey, 2) == HASH_TABLE_SUCCESS);
+        assert(hashTableInsertUnique(&table, longKey, 3) == HASH_TABLE_SUCCESS);
+        assert(hashTableInsertUnique(&table, "", 4) == HASH_TABLE_SUCCESS);
+        assert(hashTableInsertUnique(&table, externalKey, 5) == HASH_TABLE_ALREADY_EXISTS);
+
+        assert(hashTableGet(&table, inlineKey, &value) == HASH_TABLE_SUCCESS && value == 1);
+        assert(hashTableGet(&table, externalKey, &value) == HASH_TABLE_SUCCESS && value == 2);
+        assert(hashTableGet(&table, longKey, &value) == HASH_TABLE_SUCCESS && value == 3);
+        assert(hashTableGet(&table, "", &value) == HASH_TABLE_SUCCESS && value == 4);
+        assert(hashTableContains(&table, "abcdefghijklmnopqrstuv") == HASH_TABLE_KEY_NOT_FOUND);
+
+        // Тест: удалённые узлы переиспользуются, ключи не портятся
+        char key[64];
+        for (int round = 0; round < 3; round++) {
+            for (int i = 0; i < 2000; i++) {
+                snprintf(key, sizeof(key), "%s-%d", i % 2 ? "short" : "a-rather-long-key-stored-in-arena", i);
+                assert(hashTableInsertUnique(&table, key, i) == HASH_TABLE_SUCCESS);
+            }
+            for (int i = 0; i < 2000; i++) {
+                snprintf(key, sizeof(key), "%s-%d", i % 2 ? "short" : "a-rather-long-key-stored-in-arena", i);
+                assert(hashTableGet(&table, key, &value) == HASH_TABLE_SUCCESS && value == i);
+                assert(hashTableRemove(&table, key) == HASH_TABLE_SUCCESS);
+            }
+        }
+
+        assert(hashTableCount(&table) == 4);
+
+        char** keys = hashTableKeys(&table);
+        assert(keys != NULL);
+        for (int i = 0; i < 4; i++) {
+            assert(hashTableContains(&table, keys[i]) == HASH_TABLE_SUCCESS);
+            free(keys[i]);
+        }
+        free(keys);
+
+        hashTableClear(&table);
+    }
+}
+
+/// @brief Тесты встроенных хеш-функций и их подключения к таблице
+void hashTableHashFunctionTests() {
+    HashTable_HashFunction functions[] = {hashWy, hashXxh3, hashDjb2};
+    char key[300];
+
+    for (size_t f = 0; f < sizeof(functions) / sizeof(functions[0]); f++) {
+        HashTable_HashFunction hash = functions[f];
+
+        // Тест: детерминированность и зависимость от зерна
+        assert(hash("apple", 5, 1) == hash("apple", 5, 1));
+        assert(hash("apple", 5, 1) != hash("apple", 5, 2));
+        assert(hash("apple", 5, 1) != hash("apple", 4, 1));
+
+        // Тест: нет совпадений среди префиксов длиной 0..256 (все ветви по длине)
+        uint64_t values[257];
+        memset(key, 'k', sizeof(key));
+        for (size_t length = 0; length <= 256; length++) {
+            key[length ? length - 1 : 0] = (char)('a' + length % 26);
+            values[length] = hash(key, length, 42);
+        }
+        qsort(values, 257, sizeof(uint64_t), compareUint64);
+        for (size_t i = 1; i < 257; i++) assert(values[i] != values[i - 1]);
+
+        // Тест: функция работает во всех вариантах таблицы
+        for (int backend = 0; backend < 3; backend++) {
+            HashTable table;
+            int value;
+
+            if (backend == 0) hashTableInit(&table, 10);
+            else if (backend == 1) assert(hashTableInitFlat(&table, 10) == HASH_TABLE_SUCCESS);
+            else assert(hashTableInitSharded(&table, 4, 10) == HASH_TABLE_SUCCESS);
+
+            assert(hashTableSetHashFunction(&table, hash, 12345) == HASH_TABLE_SUCCESS);
+
+            for (int i = 0; i < 3000; i++) {
+                snprintf(key, sizeof(key), "%d-%.*s", i, i % 40, "0123456789012345678901234567890123456789");
+                assert(hashTableInsertUnique(&table, key, i) == HASH_TABLE_SUCCESS);
+            }
+            for (int i = 0; i < 3000; i++) {
+                snprintf(key, sizeof(key), "%d-%.*s", i, i % 40, "0123456789012345678901234567890123456789");
+                assert(hashTableGet(&table, key, &value) == HASH_TABLE_SUCCESS && value == i);
+            }
+
+            assert(hashTableSetHashFunction(&table, hashDjb2, 1) == HASH_TABLE_INVALID_OPERATION);
+
+            hashTableClear(&table);
+        }
+    }
+
+    // Тест: количество бакетов округляется до степени двойки
+    HashTable table;
+    hashTableInit(&table, 10);
+    assert(table.size == 16);
+    hashTableClear(&table);
+}
+
+/// @brief Тесты пакетного поиска
+void hashTableBatchTests() {
+    for (int backend = 0; backend < 3; backend++) {
+        HashTable table;
+        char storage[100][32];
+        const char* keys[100];
+        int values[100];
+        HashTable_ErrorCode status[100];
+
+        if (backend == 0) hashTableInit(&table, 8);
+        else if (backend == 1) assert(hashTableInitFlat(&table, 8) == HASH_TABLE_SUCCESS);
+        else assert(hashTableInitSharded(&table, 4, 8) == HASH_TABLE_SUCCESS);
+
+        // Чётные ключи есть в таблице, нечётных нет; длина пакета не кратна окну
+        for (int i = 0; i < 100; i++) {
+            snprintf(storage[i], sizeof(storage[i]), "batch-%d", i);
+            keys[i] = storage[i];
+            values[i] = -1;
+            if (i % 2 == 0) assert(hashTableInsertUnique(&table, keys[i], i * 10) == HASH_TABLE_SUCCESS);
+        }
+
+        assert(hashTableGetBatch(&table, keys, 100, values, status) == 50);
+        for (int i = 0; i < 100; i++) {
+            assert(status[i] == (i % 2 ? HASH_TABLE_KEY_NOT_FOUND : HASH_TABLE_SUCCESS));
+            assert(values[i] == (i % 2 ? -1 : i * 10));
+        }
+
+        assert(hashTableGetBatch(&table, keys, 0, values, status) == 0);
+
+        hashTableClear(&table);
+    }
+}
+
+/// @brief Тесты курсора обхода
+void hashTableIteratorTests() {
+    for (int backend = 0; backend < 2; backend++) {
+        HashTable table;
+        HashTableIter iter;
+        char key[32];
+        const char* itemKey;
+        int* itemValue;
+        int seen[400];
+
+        if (backend == 0) hashTableInit(&table, 4);
+        else assert(hashTableInitFlat(&table, 4) == HASH_TABLE_SUCCESS);
+
+        for (int i = 0; i < 200; i++) {
+            snprintf(key, sizeof(key), "iter-%d", i);
+            assert(hashTableInsertUnique(&table, key, i) == HASH_TABLE_SUCCESS);
+        }
+
+        // Пустой обход и обход без изменений: каждый ключ ровно один раз
+        memset(seen, 0, sizeof(seen));
+        assert(hashTableIterBegin(&table, &iter) == HASH_TABLE_SUCCESS);
+        while (hashTableIterNext(&table, &iter, &itemKey, &itemValue)) {
+            snprintf(key, sizeof(key), "iter-%d", *itemValue);
+            assert(strcmp(key, itemKey) == 0);
+            seen[*itemValue]++;
+            *itemValue += 1000;
+        }
+        for (int i = 0; i < 200; i++) assert(seen[i] == 1);
+        assert(hashTableIterNext(&table, &iter, &itemKey, &itemValue) == 0);
+
+        int value;
+        assert(hashTableGet(&table, "iter-7", &value) == HASH_TABLE_SUCCESS && value == 1007);
+
+        // Вставки с ростом таблицы между шагами: старые ключи выдаются хотя бы раз
+        memset(seen, 0, sizeof(seen));
+        assert(hashTableIterBegin(&table, &iter) == HASH_TABLE_SUCCESS);
+        for (int step = 0; hashTableIterNext(&table, &iter, NULL, &itemValue); step++) {
+            seen[*itemValue % 1000]++;
+            if (step < 200) {
+                snprintf(key, sizeof(key), "iter-%d", 200 + step);
+                assert(hashTableInsertUnique(&table, key, 200 + step) == HASH_TABLE_SUCCESS);
+            }
+        }
+        for (int i = 0; i < 200; i++) assert(seen[i] >= 1);
+
+        // Удаление текущего элемента во время обхода
+        assert(hashTableIterBegin(&table, &iter) == HASH_TABLE_SUCCESS);
+        assert(hashTableIterRemove(&table, &iter) == HASH_TABLE_INVALID_OPERATION);
+        while (hashTableIterNext(&table, &iter, NULL, &itemValue)) {
+            if (*itemValue % 2) assert(hashTableIterRemove(&table, &iter) == HASH_TABLE_SUCCESS);
+        }
+        assert(hashTableCount(&table) == 200);
+
+        for (int i = 0; i < 400; i++) {
+            snprintf(key, sizeof(key), "iter-%d", i);
+            assert(hashTableContains(&table, key) == (i % 2 ? HASH_TABLE_KEY_NOT_FOUND : HASH_TABLE_SUCCESS));
+        }
+
+        hashTableClear(&table);
+    }
+
+    HashTable sharded;
+    HashTableIter iter;
+
+    assert(hashTableInitSharded(&sharded, 4, 8) == HASH_TABLE_SUCCESS);
+    assert(hashTableIterBegin(&sharded, &iter) == HASH_TABLE_INVALID_OPERATION);
+    assert(hashTableIterNext(&sharded, &iter, NULL, NULL) == 0);
+    hashTableClear(&sharded);
+}
+
+/// @brief Своя хеш-функция для теста: не встроенная, поэтому снимок не сохраняется
+static uint64_t snapshotTestHash(const char* key, size_t length, uint64_t seed) {
+    return hashWy(key, length, seed + 1);
+}
+
+/// @brief Тесты сохранения таблицы в файл и поиска по отображённому снимку
+void hashTableSnapshotTests() {
+    char path[64];
+    char key[64];
+    int value;
+
+    snprintf(path, sizeof(path), "/tmp/hash_table_test_%d.snapshot", (int)getpid());
+
+    for (int backend = 0; backend < 3; backend++) {
+        HashTable table;
+        HashTable mapped;
+
+        if (backend == 0) hashTableInit(&table, 4);
+        else if (backend == 1) assert(hashTableInitFlat(&table, 4) == HASH_TABLE_SUCCESS);
+        else assert(hashTableInitSharded(&table, 4, 4) == HASH_TABLE_SUCCESS);
+
+        // Короткие и длинные ключи, таблица с цепочками - посреди перехеширования
+        for (int i = 0; i < 1000; i++) {
+            snprintf(key, sizeof(key), i % 3 ? "snap-%d" : "a-much-longer-snapshot-key-%d", i);
+            assert(hashTableInsertUnique(&table, key, i - 500) == HASH_TABLE_SUCCESS);
+        }
+
+        assert(hashTableSave(&table, path) == HASH_TABLE_SUCCESS);
+        hashTableClear(&table);
+
+        assert(hashTableOpenMapped(&mapped, path) == HASH_TABLE_SUCCESS);
+        assert(hashTableCount(&mapped) == 1000);
+
+        for (int i = 0; i < 1000; i++) {
+            snprintf(key, sizeof(key), i % 3 ? "snap-%d" : "a-much-longer-snapshot-key-%d", i);
+            assert(hashTableGet(&mapped, key, &value) == HASH_TABLE_SUCCESS && value == i - 500);
+        }
+        assert(hashTableContains(&mapped, "snap-0") == HASH_TABLE_KEY_NOT_FOUND);
+        assert(hashTableContains(&mapped, "") == HASH_TABLE_KEY_NOT_FOUND);
+
+        const char* batch[] = {"snap-1", "missing", "a-much-longer-snapshot-key-3"};
+        int values[3];
+        HashTable_ErrorCode status[3];
+
+        assert(hashTableGetBatch(&mapped, batch, 3, values, status) == 2);
+        assert(status[1] == HASH_TABLE_KEY_NOT_FOUND && values[0] == -499 && values[2] == -497);
+
+        // Снимок только для чтения
+        assert(hashTableInsertUnique(&mapped, "new", 1) == HASH_TABLE_INVALID_OPERATION);
+        assert(hashTableRemove(&mapped, "snap-1") == HASH_TABLE_INVALID_OPERATION);
+        assert(hashTableSetHashFunction(&mapped, hashDjb2, 0) == HASH_TABLE_INVALID_OPERATION);
+
+        char** keys = hashTableKeys(&mapped);
+        assert(keys != NULL);
+        for (int i = 0; i < 1000; i++) {
+            assert(hashTableContains(&mapped, keys[i]) == HASH_TABLE_SUCCESS);
+            free(keys[i]);
+        }
+        free(keys);
+
+        hashTableClear(&mapped);
+    }
+
+    // Пустая таблица и таблица с другой встроенной хеш-функцией
+    HashTable table;
+    HashTable mapped;
+
+    hashTableInit(&table, 4);
+    assert(hashTableSetHashFunction(&table, hashXxh3, 42) == HASH_TABLE_SUCCESS);
+    assert(hashTableSave(&table, path) == HASH_TABLE_SUCCESS);
+    assert(hashTableOpenMapped(&mapped, path) == HASH_TABLE_SUCCESS);
+    assert(hashTableCount(&mapped) == 0 && mapped.hash == hashXxh3 && mapped.seed == 42);
+    assert(hashTableContains(&mapped, "anything") == HASH_TABLE_KEY_NOT_FOUND);
+    hashTableClear(&mapped);
+
+    // Таблицу со своей хеш-функцией сохранить нельзя
+    assert(hashTableSetHashFunction(&table, snapshotTestHash, 0) == HASH_TABLE_SUCCESS);
+    assert(hashTableSave(&table, path) == HASH_TABLE_INVALID_OPERATION);
+    hashTableClear(&table);
+
+    // Обрезанный и чужой файлы не открываются
+    assert(truncate(path, 100) == 0);
+    assert(hashTableOpenMapped(&mapped, path) == HASH_TABLE_IO_ERROR);
+
+    FILE* file = fopen(path, "wb");
+    assert(file != NULL);
+    for (int i = 0; i < 8192; i++) fputc('x', file);
+    fclose(file);
+    assert(hashTableOpenMapped(&mapped, path) == HASH_TABLE_IO_ERROR);
+
+    remove(path);
+    assert(hashTableOpenMapped(&mapped, path) == HASH_TABLE_IO_ERROR);
+}
+
+/// @brief Тесты таблицы с минимальным идеальным хешированием
+void hashTablePerfectTests() {
+    size_t sizes[] = {0, 1, 2, 37, 1000, 100000};
+    char* storage = (char*)malloc(100000 * 40);
+    const char** keys = (const char**)malloc(100000 * sizeof(char*));
+    int* values = (int*)malloc(100000 * sizeof(int));
+    char key[40];
+    int value;
+
+    assert(storage && keys && values);
+
+    for (size_t i = 0; i < 100000; i++) {
+        snprintf(storage + i * 40, 40, i % 4 ? "perfect-%zu" : "a-longer-perfect-hash-key-%zu", i);
+        keys[i] = storage + i * 40;
+        values[i] = (int)i * 3;
+    }
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        HashTable table;
+        HashTableIter iter;
+        size_t n = sizes[s];
+        size_t visited = 0;
+
+        assert(hashTableBuildPerfect(&table, keys, values, n) == HASH_TABLE_SUCCESS);
+        assert(hashTableCount(&table) == n);
+
+        for (size_t i = 0; i < n; i++) assert(hashTableGet(&table, keys[i], &value) == HASH_TABLE_SUCCESS && value == values[i]);
+        for (size_t i = n; i < n + 100; i++) {
+            snprintf(key, sizeof(key), "missing-%zu", i);
+            assert(hashTableContains(&table, key) == HASH_TABLE_KEY_NOT_FOUND);
+        }
+
+        // Метаданные: пилоты (3 бита на ключ) и remap (около 0,3 бита на ключ)
+        if (n >= 1000) assert((table.pilotCount * 8 + (table.positions - n) * 32 + table.largePilotCount * 64) <= n * 4);
+
+        assert(hashTableIterBegin(&table, &iter) == HASH_TABLE_SUCCESS);
+        while (hashTableIterNext(&table, &iter, NULL, NULL)) visited++;
+        assert(visited == n);
+
+        assert(hashTableInsertUnique(&table, "new", 1) == HASH_TABLE_INVALID_OPERATION);
+        assert(hashTableRemove(&table, keys[0]) == HASH_TABLE_INVALID_OPERATION);
+
+        hashTableClear(&table);
+    }
+
+    // Пакетный поиск и ключи-повторы
+    HashTable table;
+    const char* batch[] = {keys[5], "missing", keys[6]};
+    HashTable_ErrorCode status[3];
+    int found[3];
+
+    assert(hashTableBuildPerfect(&table, keys, values, 1000) == HASH_TABLE_SUCCESS);
+    assert(hashTableGetBatch(&table, batch, 3, found, status) == 2);
+    assert(found[0] == 15 && status[1] == HASH_TABLE_KEY_NOT_FOUND && found[2] == 18);
+    hashTableClear(&table);
+
+    keys[7] = keys[3];
+    assert(hashTableBuildPerfect(&table, keys, values, 1000) == HASH_TABLE_ALREADY_EXISTS);
+
+    free(storage);
+    free(keys);
+    free(values);
+}
+
+/// @brief Плохая хеш-функция для теста статистики: все ключи в одном бакете
+static uint64_t statsTestHash(const char* key, size_t length, uint64_t seed) {
+    (void)key;
+    (void)length;
+
+    return seed;
+}
+
+/// @brief Записывает hashTableStatsDump в буфер
+static void statsTestDump(HashTable* table, char* buffer, size_t size) {
+    FILE* file = tmpfile();
+
+    assert(file != NULL);
+    hashTableStatsDump(table, file);
+    rewind(file);
+
+    size_t length = fread(buffer, 1, size - 1, file);
+    buffer[length] = '\0';
+    fclose(file);
+}
+
+/// @brief Тесты статистики таблицы
+void hashTableStatsTests() {
+    char buffer[4096];
+    char key[32];
+    int value;
+
+    for (int backend = 0; backend < 5; backend++) {
+        HashTable table;
+        HashTable source;
+        const char* names[] = {"\"chained\"", "\"flat\"", "\"sharded\"", "\"mapped\"", "\"perfect\""};
+
+        if (backend == 0 || backend == 3) hashTableInit(&table, 64);
+        else if (backend == 1) assert(hashTableInitFlat(&table, 64) == HASH_TABLE_SUCCESS);
+        else if (backend == 2) assert(hashTableInitSharded(&table, 4, 64) == HASH_TABLE_SUCCESS);
+
+        if (backend < 4) {
+            for (int i = 0; i < 100; i++) {
+                snprintf(key, sizeof(key), "stats-%d", i);
+                assert(hashTableInsertUnique(&table, key, i) == HASH_TABLE_SUCCESS);
+            }
+        }
+
+        if (backend == 3) {
+            char path[64];
+
+            snprintf(path, sizeof(path), "/tmp/hash_table_stats_%d.snapshot", (int)getpid());
+            assert(hashTableSave(&table, path) == HASH_TABLE_SUCCESS);
+            hashTableClear(&table);
+            assert(hashTableOpenMapped(&table, path) == HASH_TABLE_SUCCESS);
+            remove(path);
+        } else if (backend == 4) {
+            char storage[100][32];
+            const char* keys[100];
+            int values[100];
+
+            for (int i = 0; i < 100; i++) {
+                snprintf(storage[i], sizeof(storage[i]), "stats-%d", i);
+                keys[i] = storage[i];
+                values[i] = i;
+            }
+            assert(hashTableBuildPerfect(&source, keys, values, 100) == HASH_TABLE_SUCCESS);
+            table = source;
+        }
+
+        for (int i = 0; i < 200; i += 2) {
+            snprintf(key, sizeof(key), "stats-%d", i);
+            hashTableGet(&table, key, &value);
+        }
+
+        statsTestDump(&table, buffer, sizeof(buffer));
+        assert(strstr(buffer, names[backend]) != NULL);
+        assert(strstr(buffer, "\"count\": 100,") != NULL);
+        assert(strstr(buffer, "\"chain_length_histogram\": [") != NULL);
+        if (backend == 4) assert(strstr(buffer, "\"longest_chain\": 1,") != NULL);
+
+#ifdef HASH_TABLE_STATS
+        assert(strstr(buffer, "\"lookups\": 100,") != NULL);
+        assert(strstr(buffer, "\"hits\": 50,") != NULL);
+        assert(strstr(buffer, "\"hit_ratio\": 0.5000,") != NULL);
+        assert(strstr(buffer, "\"probe_length_histogram\": [") != NULL);
+        if (backend < 3) assert(strstr(buffer, "\"inserts\": 100,") != NULL);
+#else
+        assert(strstr(buffer, "\"lookups\"") == NULL);
+#endif
+
+        hashTableClear(&table);
+    }
+
+    // Плохая хеш-функция видна по самой длинной цепочке
+    HashTable table;
+
+    hashTableInit(&table, 1024);
+    assert(hashTableSetHashFunction(&table, statsTestHash, 0) == HASH_TABLE_SUCCESS);
+    for (int i = 0; i < 100; i++) {
+        snprintf(key, sizeof(key), "stats-%d", i);
+        assert(hashTableInsertUnique(&table, key, i) == HASH_TABLE_SUCCESS);
+    }
+    assert(hashTableGet(&table, "stats-0", &value) == HASH_TABLE_SUCCESS);
+    assert(hashTableRemove(&table, "stats-1") == HASH_TABLE_SUCCESS);
+
+    statsTestDump(&table, buffer, sizeof(buffer));
+    assert(strstr(buffer, "\"longest_chain\": 99,") != NULL);
+    assert(strstr(buffer, "\"load_factor\": 0.0967,") != NULL);
+
+#ifdef HASH_TABLE_STATS
+    // Ключ вставлен первым, поэтому лежит в конце цепочки из 100 узлов
+    assert(table.stats.probeHistogram[HASH_TABLE_STATS_HISTOGRAM - 1] == 1);
+    assert(strstr(buffer, "\"removes\": 1,") != NULL);
+#endif
+
+    hashTableClear(&table);
+}
+
+/// @brief Параметры потока для теста потокобезопасной таблицы
+typedef struct {
+    HashTable* table;             ///< Общая таблица
+    int id;                       ///< Номер потока
+    int failures;                 ///< Количество ненайденных общих ключей
+} ShardedTestThread;
+
+/// @brief Поток теста: вставляет и удаляет свои ключи, параллельно читая общие
+static void* hashTableShardedTestWorker(void* arg) {
+    ShardedTestThread* self = (ShardedTestThread*)arg;
+    char key[32];
+    int value;
+
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 500; i++) {
+            snprintf(key, sizeof(key), "t%d-%d", self->id, i);
+            if (hashTableInsertUnique(self->table, key, i) != HASH_TABLE_SUCCESS) self->failures++;
+
+            snprintf(key, sizeof(key), "shared-%d", (i * 7 + round) % 1000);
+            if (hashTableGet(self->table, key, &value) != HASH_TABLE_SUCCESS || value != (i * 7 + round) % 1000)
+                self->failures++;
+        }
+        for (int i = 0; i < 500; i++) {
+            snprintf(key, sizeof(key), "t%d-%d", self->id, i);
+            if (hashTableRemove(self->table, key) != HASH_TABLE_SUCCESS) self->failures++;
+        }
+    }
+
+    return NULL;
+}
+
+/// @brief Тесты потокобезопасной таблицы
+void hashTableShardedTests() {
+    HashTable table;
+    assert(hashTableInitSharded(&table, 4, 8) == HASH_TABLE_SUCCESS);
+
+    // Тест: базовые операции в одном потоке
+    int value;
+    assert(hashTableInsertUnique(&table, "apple", 100) == HASH_TABLE_SUCCESS);
+    assert(hashTableInsertUnique(&table, "apple", 300) == HASH_TABLE_ALREADY_EXISTS);
+    assert(hashTableGet(&table, "apple", &value) == HASH_TABLE_SUCCESS && value == 100);
+    assert(hashTableContains(&table, "cherry") == HASH_TABLE_KEY_NOT_FOUND);
+    assert(hashTableRemove(&table, "apple") == HASH_TABLE_SUCCESS);
+    assert(hashTableRemove(&table, "apple") == HASH_TABLE_KEY_NOT_FOUND);
+    assert(hashTableCount(&table) == 0);
+
+    // Тест: одновременные вставки и удаления не мешают читателям
+    char key[32];
+    for (int i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "shared-%d", i);
+        assert(hashTableInsertUnique(&table, key, i) == HASH_TABLE_SUCCESS);
+    }
+
+    pthread_t threads[4];
+    ShardedTestThread args[4];
+    for (int i = 0; i < 4; i++) {
+        args[i].table = &table;
+        args[i].id = i;
+        args[i].failures = 0;
+        assert(pthread_create(&threads[i], NULL, hashTableShardedTestWorker, &args[i]) == 0);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+        assert(args[i].failures == 0);
+    }
+    assert(hashTableCount(&table) == 1000);
+
+    char** keys = hashTableKeys(&table);
+    assert(keys != NULL);
+    for (size_t i = 0; i < 1000; i++) free(keys[i]);
+    free(keys);
+
+    hashTableClear(&table);
+}
+
+/*
+ * Бенчмарки. Запуск: ./hash_table --bench <имя> [параметры]
+ * Тесты выполняются всегда, бенчмарки - только по запросу.
+ */
+
+/// @brief Текущее время монотонных часов в секундах
+static double benchNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/// @brief Набор ключей для бенчмарков, хранящийся в одном буфере
+typedef struct {
+    char* buffer;                 ///< Все ключи подряд, каждый завершается нулём
+    char** keys;                  ///< Указатели на начало каждого ключа
+    size_t count;                 ///< Количество ключей
+} BenchKeys;
+
+/// @brief Генерирует count различных ключей вида "key:<число>" с префиксом prefix
+/// @param keys Набор ключей
+/// @param count Количество ключей
+/// @param prefix Префикс, позволяющий получить непересекающиеся наборы
+/// @return 1 в случае успеха, 0 при нехватке памяти
+static int benchKeysInit(BenchKeys* keys, size_t count, const char* prefix) {
+    const size_t maxLength = 32;
+
+    keys->buffer = (char*)malloc(count * maxLength);
+    keys->keys = (char**)malloc(count * sizeof(char*));
+    keys->count = count;
+
+    if (!keys->buffer || !keys->keys) {
+        free(keys->buffer);
+        free(keys->keys);
+        return 0;
+    }
+
+    char* cursor = keys->buffer;
+    for (size_t i = 0; i < count; i++) {
+        keys->keys[i] = cursor;
+        cursor += snprintf(cursor, maxLength, "%s:%zu", prefix, i * 2654435761u % (count * 4)) + 1;
+    }
+
+    // Перемешиваем порядок, чтобы обращения к таблице не шли по порядку вставки
+    uint64_t state = 88172645463325252ULL;
+    if (count > 1) {
+        for (size_t i = count - 1; i > 0; i--) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+
+            size_t j = (size_t)(state % (i + 1));
+            char* temp = keys->keys[i];
+            keys->keys[i] = keys->keys[j];
+            keys->keys[j] = temp;
+        }
+    }
+
+    return 1;
+}
+
+/// @brief Освобождает набор ключей
+static void benchKeysFree(BenchKeys* keys) {
+    free(keys->buffer);
+    free(keys->keys);
+}
+
+/// @brief Замеряет вставку, поиск и удаление для уже инициализированной таблицы
+/// @param name Название варианта таблицы для вывода
+/// @param table Пустая инициализированная таблица
+/// @param present Ключи для вставки
+/// @param absent Ключи, которых в таблице нет
+static void benchBackend(const char* name, HashTable* table, const BenchKeys* present, const BenchKeys* absent) {
+    size_t n = present->count;
+    long long checksum = 0;
+    int value;
+
+    double start = benchNow();
+    for (size_t i = 0; i < n; i++)
+        if (hashTableInsertUnique(table, present->keys[i], (int)i) != HASH_TABLE_SUCCESS) {
+            printf("  %-8s вставка прервана на %zu ключе\n", name, i);
+            return;
+        }
+    double insertTime = benchNow() - start;
+
+    start = benchNow();
+    for (size_t i = 0; i < n; i++)
+        if (hashTableGet(table, present->keys[n - 1 - i], &value) == HASH_TABLE_SUCCESS) checksum += value;
+    double hitTime = benchNow() - start;
+
+    start = benchNow();
+    for (size_t i = 0; i < n; i++) checksum += hashTableContains(table, absent->keys[i]);
+    double missTime = benchNow() - start;
+
+    start = benchNow();
+    for (size_t i = 0; i < n; i++) hashTableRemove(table, present->keys[i]);
+    double removeTime = benchNow() - start;
+
+    printf("  %-8s insert %7.1f  get(hit) %7.1f  get(miss) %7.1f  remove %7.1f  ns/op  [%lld]\n",
+           name, insertTime * 1e9 / n, hitTime * 1e9 / n, missTime * 1e9 / n, removeTime * 1e9 / n, checksum);
+}
+
+/// @brief Сравнивает таблицу с цепочками и плоскую таблицу
+/// @details ./hash_table --bench backends [N ...], по умолчанию N = 1M, 10M, 100M.
+///          Таблица с цепочками создаётся сразу на N бакетов, плоская растёт с нуля.
+static void benchBackends(int argc, char** argv) {
+    size_t defaults[] = {1000000, 10000000, 100000000};
+    size_t runs = argc > 0 ? (size_t)argc : sizeof(defaults) / sizeof(defaults[0]);
+
+    for (size_t r = 0; r < runs; r++) {
+        size_t n = argc > 0 ? strtoull(argv[r], NULL, 10) : defaults[r];
+        BenchKeys present, absent;
+
+        printf("N = %zu\n", n);
+
+        if (!benchKeysInit(&present, n, "key")) {
+            printf("  недостаточно памяти для ключей\n");
+            continue;
+        }
+        if (!benchKeysInit(&absent, n, "miss")) {
+            printf("  недостаточно памяти для ключей\n");
+            benchKeysFree(&present);
+            continue;
+        }
+
+        HashTable table;
+
+        hashTableInit(&table, n);
+        if (table.buckets) benchBackend("chained", &table, &present, &absent);
+        hashTableClear(&table);
+
+        if (hashTableInitFlat(&table, 0) == HASH_TABLE_SUCCESS) benchBackend("flat", &table, &present, &absent);
+        hashTableClear(&table);
+
+        benchKeysFree(&present);
+        benchKeysFree(&absent);
+    }
+}
+
+/// @brief Сравнение задержек для qsort
+static int benchCompareDouble(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+
+    return (x > y) - (x < y);
+}
+
+/// @brief Задержки вставок при росте таблицы с цепочками от 10 до N элементов
+/// @details ./hash_table --bench growth [N], по умолчанию N = 10M. Для каждого
+///          десятичного диапазона размеров печатаются p50/p99/p99.9/max задержки
+///          одной вставки при постепенном переносе и при переносе всей таблицы сразу.
+static void benchGrowth(int argc, char** argv) {
+    size_t n = argc > 0 ? strtoull(argv[0], NULL, 10) : 10000000;
+    BenchKeys keys;
+    double* latencies = (double*)malloc(n * sizeof(double));
+
+    if (!latencies || !benchKeysInit(&keys, n, "key")) {
+        printf("недостаточно памяти\n");
+        free(latencies);
+        return;
+    }
+
+    for (int mode = 0; mode < 2; mode++) {
+        HashTable table;
+        hashTableInit(&table, 10);
+        table.rehashStep = mode == 0 ? HASH_TABLE_REHASH_STEP : 0;
+
+        printf("%s\n", mode == 0 ? "incremental rehash" : "stop-the-world rehash");
+
+        for (size_t i = 0; i < n; i++) {
+            double start = benchNow();
+            hashTableInsertUnique(&table, keys.keys[i], (int)i);
+            latencies[i] = benchNow() - start;
+        }
+
+        for (size_t from = 10; from < n; from *= 10) {
+            size_t to = from * 10 < n ? from * 10 : n;
+            size_t length = to - from;
+
+            qsort(latencies + from, length, sizeof(double), benchCompareDouble);
+            printf("  %9zu..%-9zu p50 %8.0f  p99 %8.0f  p99.9 %10.0f  max %12.0f ns\n", from, to,
+                   latencies[from + length / 2] * 1e9, latencies[from + length * 99 / 100] * 1e9,
+                   latencies[from + length * 999 / 1000] * 1e9, latencies[to - 1] * 1e9);
+        }
+
+        hashTableClear(&table);
+    }
+
+    benchKeysFree(&keys);
+    free(latencies);
+}
+
+/// @brief Параметры потока бенчмарка потокобезопасной таблицы
+typedef struct {
+    HashTable* table;             ///< Общая таблица
+    pthread_mutex_t* lock;        ///< Глобальный мьютекс или NULL для потокобезопасной таблицы
+    const BenchKeys* readKeys;    ///< Заранее вставленные ключи для чтения
+    BenchKeys writeKeys;          ///< Собственные ключи потока для вставок и удалений
+    size_t operations;            ///< Количество операций
+    int writePercent;             ///< Доля записей в процентах
+    long long checksum;           ///< Сумма прочитанных значений (чтобы чтение не выкинул компилятор)
+} BenchConcurrentThread;
+
+/// @brief Поток бенчмарка: случайная смесь чтений и записей
+static void* benchConcurrentWorker(void* arg) {
+    BenchConcurrentThread* self = (BenchConcurrentThread*)arg;
+    uint64_t state = (uint64_t)(uintptr_t)self | 1;
+    size_t writeIndex = 0;
+    int value;
+
+    for (size_t i = 0; i < self->operations; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        if (self->lock) pthread_mutex_lock(self->lock);
+
+        if ((int)(state % 100) < self->writePercent) {
+            // Записи чередуют вставку и удаление, чтобы размер таблицы не менялся
+            const char* key = self->writeKeys.keys[(writeIndex / 2) % self->writeKeys.count];
+
+            if (writeIndex++ % 2 == 0) hashTableInsertUnique(self->table, key, (int)i);
+            else hashTableRemove(self->table, key);
+        } else {
+            const char* key = self->readKeys->keys[(state >> 16) % self->readKeys->count];
+
+            if (hashTableGet(self->table, key, &value) == HASH_TABLE_SUCCESS) self->checksum += value;
+        }
+
+        if (self->lock) pthread_mutex_unlock(self->lock);
+    }
+
+    return NULL;
+}
+
+/// @brief Пропускная способность при 1..64 потоках и смесях чтение/запись 95/5, 50/50, 0/100
+/// @details ./hash_table --bench concurrent [N [операций]], по умолчанию N = 1M ключей
+///          и 4M операций на прогон. Сравниваются таблица с цепочками под одним
+///          глобальным мьютексом и таблица с шардами (64 шарда).
+static void benchConcurrent(int argc, char** argv) {
+    size_t n = argc > 0 ? strtoull(argv[0], NULL, 10) : 1000000;
+    size_t operations = argc > 1 ? strtoull(argv[1], NULL, 10) : 4000000;
+    int threadCounts[] = {1, 2, 4, 8, 16, 32, 64};
+    int writePercents[] = {5, 50, 100};
+    BenchKeys readKeys;
+
+    if (!benchKeysInit(&readKeys, n, "key")) {
+        printf("недостаточно памяти\n");
+        return;
+    }
+
+    for (int mode = 0; mode < 2; mode++) {
+        HashTable table;
+        pthread_mutex_t lock;
+
+        if (mode == 0) {
+            hashTableInit(&table, n);
+            pthread_mutex_init(&lock, NULL);
+        } else if (hashTableInitSharded(&table, 64, n) != HASH_TABLE_SUCCESS) {
+            printf("недостаточно памяти\n");
+            hashTableClear(&table);
+            break;
+        }
+
+        for (size_t i = 0; i < n; i++) hashTableInsertUnique(&table, readKeys.keys[i], (int)i);
+
+        printf("%s\n", mode == 0 ? "chained + global mutex" : "sharded, lock-free reads");
+
+        for (size_t w = 0; w < sizeof(writePercents) / sizeof(writePercents[0]); w++) {
+            printf("  read/write %3d/%-3d", 100 - writePercents[w], writePercents[w]);
+
+            for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); t++) {
+                int threads = threadCounts[t];
+                pthread_t handles[64];
+                BenchConcurrentThread args[64];
+                char prefix[16];
+                int ready = 0;
+
+                for (; ready < threads; ready++) {
+                    snprintf(prefix, sizeof(prefix), "w%d", ready);
+                    args[ready].table = &table;
+                    args[ready].lock = mode == 0 ? &lock : NULL;
+                    args[ready].readKeys = &readKeys;
+                    args[ready].operations = operations / threads;
+                    args[ready].writePercent = writePercents[w];
+                    args[ready].checksum = 0;
+                    if (!benchKeysInit(&args[ready].writeKeys, 1024, prefix)) break;
+                }
+
+                // Без памяти под ключи записи этот прогон пропускается
+                if (ready < threads) {
+                    for (int i = 0; i < ready; i++) benchKeysFree(&args[i].writeKeys);
+                    printf("  %2dT %7s", threads, "---");
+                    continue;
+                }
+
+                double start = benchNow();
+                for (int i = 0; i < threads; i++) pthread_create(&handles[i], NULL, benchConcurrentWorker, &args[i]);
+                for (int i = 0; i < threads; i++) pthread_join(handles[i], NULL);
+                double elapsed = benchNow() - start;
+
+                for (int i = 0; i < threads; i++) {
+                    // Удаляем ключи, оставшиеся после нечётного числа записей
+                    for (size_t k = 0; k < args[i].writeKeys.count; k++)
+                        hashTableRemove(&table, args[i].writeKeys.keys[k]);
+                    benchKeysFree(&args[i].writeKeys);
+                }
+
+                printf("  %2dT %7.2f", threads, (double)(operations / threads * threads) / elapsed / 1e6);
+            }
+
+            printf("  Mops/s\n");
+        }
+
+        hashTableClear(&table);
+        if (mode == 0) pthread_mutex_destroy(&lock);
+    }
+
+    benchKeysFree(&readKeys);
+}
+
+/// @brief Объём памяти кучи, занятой программой (только glibc)
+static size_t benchHeapBytes(void) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 info = mallinfo2();
+
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+/// @brief Байт памяти кучи на элемент для каждой таблицы при разной длине ключей
+/// @details ./hash_table --bench memory [N], по умолчанию N = 1M. Учитывается всё,
+///          что выделил malloc, включая его служебные заголовки.
+static void benchMemory(int argc, char** argv) {
+    size_t n = argc > 0 ? strtoull(argv[0], NULL, 10) : 1000000;
+    int lengths[] = {8, 16, 23, 40};
+    const char* names[] = {"chained", "flat", "sharded"};
+    char key[64];
+
+    if (benchHeapBytes() == 0) {
+        printf("измерение памяти поддерживается только с glibc 2.33+\n");
+        return;
+    }
+
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        printf("key length %2d:", lengths[l]);
+
+        for (int backend = 0; backend < 3; backend++) {
+            HashTable table;
+            size_t before = benchHeapBytes();
+
+            if (backend == 0) hashTableInit(&table, n);
+            else if (backend == 1) hashTableInitFlat(&table, n);
+            else hashTableInitSharded(&table, 64, n);
+
+            for (size_t i = 0; i < n; i++) {
+                snprintf(key, sizeof(key), "%0*zu", lengths[l], i);
+                hashTableInsertUnique(&table, key, (int)i);
+            }
+
+            printf("  %s %6.1f", names[backend], (double)(benchHeapBytes() - before) / (double)n);
+            hashTableClear(&table);
+        }
+
+        printf("  bytes/entry\n");
+    }
+}
+
+/// @brief Пакетный поиск против цикла из hashTableGet на таблице больше кеша
+/// @details ./hash_table --bench batch [N], по умолчанию N = 10M ключей, чего
+///          достаточно, чтобы массивы бакетов и узлы не помещались в LLC.
+static void benchBatch(int argc, char** argv) {
+    size_t n = argc > 0 ? strtoull(argv[0], NULL, 10) : 10000000;
+    size_t batchSizes[] = {8, 16, 64, 256};
+    BenchKeys keys;
+
+    if (!benchKeysInit(&keys, n, "key")) {
+        printf("недостаточно памяти\n");
+        return;
+    }
+
+    int* values = (int*)malloc(256 * sizeof(int));
+    HashTable_ErrorCode* status = (HashTable_ErrorCode*)malloc(256 * sizeof(HashTable_ErrorCode));
+    const char* names[] = {"chained", "flat", "sharded"};
+
+    for (int backend = 0; backend < 3 && values && status; backend++) {
+        HashTable table;
+        long long checksum = 0;
+        int value;
+
+        if (backend == 0) hashTableInit(&table, n);
+        else if (backend == 1) hashTableInitFlat(&table, n);
+        else hashTableInitSharded(&table, 64, n);
+
+        for (size_t i = 0; i < n; i++) hashTableInsertUnique(&table, keys.keys[i], (int)i);
+
+        // Ищем в порядке, отличном от порядка вставки
+        double start = benchNow();
+        for (size_t i = 0; i < n; i++)
+            if (hashTableGet(&table, keys.keys[(i * 7919) % n], &value) == HASH_TABLE_SUCCESS) checksum += value;
+        double loopTime = benchNow() - start;
+
+        printf("%-8s hashTableGet loop %6.1f ns/key", names[backend], loopTime * 1e9 / n);
+
+        for (size_t b = 0; b < sizeof(batchSizes) / sizeof(batchSizes[0]); b++) {
+            size_t batch = batchSizes[b];
+            const char* window[256];
+
+            start = benchNow();
+            for (size_t i = 0; i < n; i += batch) {
+                size_t count = n - i < batch ? n - i : batch;
+
+                for (size_t j = 0; j < count; j++) window[j] = keys.keys[((i + j) * 7919) % n];
+
+                hashTableGetBatch(&table, window, count, values, status);
+                checksum += values[0];
+            }
+            printf("  batch %3zu %6.1f", batch, (benchNow() - start) * 1e9 / n);
+        }
+
+        printf(" ns/key  [%lld]\n", checksum);
+        hashTableClear(&table);
+    }
+
+    free(values);
+    free(status);
+    benchKeysFree(&keys);
+}
+
+static volatile uint64_t benchSink; ///< Приёмник результатов, чтобы компилятор не выкинул замеряемый код
+
+/// @brief Пропускная способность хеш-функций в ГБ/с для длин ключей от 4 до 256
+/// @details ./hash_table --bench hash [мегабайт на замер], по умолчанию 256.
+static void benchHash(int argc, char** argv) {
+    size_t total = (argc > 0 ? strtoull(argv[0], NULL, 10) : 256) << 20;
+    size_t lengths[] = {4, 8, 16, 24, 32, 64, 128, 256};
+    HashTable_HashFunction functions[] = {hashDjb2, hashWy, hashXxh3};
+    const char* names[] = {"djb2", "wyhash", "xxh3"};
+    size_t bufferSize = 1 << 16;
+    char* buffer = (char*)malloc(bufferSize + 256);
+
+    if (!buffer) return;
+
+    // Ключи берутся из небольшого буфера, чтобы измерять хеширование, а не память
+    for (size_t i = 0; i < bufferSize + 256; i++) buffer[i] = (char)('a' + (i * 7 + i / 13) % 26);
+
+    printf("%-8s", "length");
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) printf("%8zu", lengths[l]);
+    printf("  GB/s\n");
+
+    for (size_t f = 0; f < sizeof(functions) / sizeof(functions[0]); f++) {
+        printf("%-8s", names[f]);
+
+        for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+            size_t length = lengths[l];
+            size_t iterations = total / length;
+            uint64_t checksum = 0;
+
+            double start = benchNow();
+            for (size_t i = 0; i < iterations; i++) checksum += functions[f](buffer + i * 61 % bufferSize, length, 7);
+            double elapsed = benchNow() - start;
+
+            benchSink = checksum;
+            printf("%8.2f", (double)(iterations * length) / elapsed / 1e9);
+        }
+
+        printf("\n");
+    }
+
+    free(buffer);
+}
+
+/// @brief Полный обход таблицы: hashTableKeys против курсора
+/// @details ./hash_table --bench scan [N], по умолчанию N = 1M ключей.
+static void benchScan(int argc, char** argv) {
+    size_t n = argc > 0 ? strtoull(argv[0], NULL, 10) : 1000000;
+    const char* names[] = {"chained", "flat"};
+    BenchKeys keys;
+
+    if (!benchKeysInit(&keys, n, "key")) {
+        printf("недостаточно памяти\n");
+        return;
+    }
+
+    for (int backend = 0; backend < 2; backend++) {
+        HashTable table;
+        HashTableIter iter;
+        const char* key;
+        int* value;
+        uint64_t checksum = 0;
+
+        if (backend == 0) hashTableInit(&table, n);
+        else hashTableInitFlat(&table, n);
+
+        for (size_t i = 0; i < n; i++) hashTableInsertUnique(&table, keys.keys[i], (int)i);
+
+        double start = benchNow();
+        char** copies = hashTableKeys(&table);
+        for (size_t i = 0; copies && i < n; i++) {
+            checksum += (unsigned char)copies[i][0];
+            free(copies[i]);
+        }
+        free(copies);
+        double keysTime = benchNow() - start;
+
+        start = benchNow();
+        hashTableIterBegin(&table, &iter);
+        while (hashTableIterNext(&table, &iter, &key, &value)) checksum += (unsigned char)key[0] + *value;
+        double iterTime = benchNow() - start;
+
+        benchSink = checksum;
+        printf("%-8s hashTableKeys %6.1f ns/key  iterator %6.1f ns/key\n", names[backend], keysTime * 1e9 / n,
+               iterTime * 1e9 / n);
+        hashTableClear(&table);
+    }
+
+    benchKeysFree(&keys);
+}
+
+/// @brief Холодный старт: построение таблицы против открытия снимка
+/// @details ./hash_table --bench snapshot [N] [файл], по умолчанию N = 1M ключей
+///          и файл /tmp/hash_table_bench.snapshot (после замера удаляется).
+static void benchSnapshot(int argc, char** argv) {
+    size_t n = argc > 0 ? strtoull(argv[0], NULL, 10) : 1000000;
+    const char* path = argc > 1 ? argv[1] : "/tmp/hash_table_bench.snapshot";
+    BenchKeys keys;
+    HashTable table;
+    HashTable mapped;
+    long long checksum = 0;
+    int value;
+
+    if (!benchKeysInit(&keys, n, "key")) {
+        printf("недостаточно памяти\n");
+        return;
+    }
+
+    double start = benchNow();
+    hashTableInit(&table, 16);
+    for (size_t i = 0; i < n; i++) hashTableInsertUnique(&table, keys.keys[i], (int)i);
+    double buildTime = benchNow() - start;
+
+    start = benchNow();
+    HashTable_ErrorCode saved = hashTableSave(&table, path);
+    double saveTime = benchNow() - start;
+
+    start = benchNow();
+    HashTable_ErrorCode opened = saved == HASH_TABLE_SUCCESS ? hashTableOpenMapped(&mapped, path) : saved;
+    double openTime = benchNow() - start;
+
+    if (opened != HASH_TABLE_SUCCESS) {
+        printf("не удалось сохранить или открыть %s\n", path);
+        hashTableClear(&table);
+        benchKeysFree(&keys);
+        return;
+    }
+
+    printf("build %8.1f ms  save %8.1f ms  open %8.3f ms  file %.1f MB\n", buildTime * 1e3, saveTime * 1e3,
+           openTime * 1e3, (double)mapped.mappingSize / (1 << 20));
+
+    // Первый проход по снимку включает подгрузку страниц, второй - уже из кеша страниц
+    for (int pass = 0; pass < 2; pass++) {
+        start = benchNow();
+        for (size_t i = 0; i < n; i++)
+            if (hashTableGet(&mapped, keys.keys[(i * 7919) % n], &value) == HASH_TABLE_SUCCESS) checksum += value;
+        printf("mapped  get pass %d %6.1f ns/key\n", pass + 1, (benchNow() - start) * 1e9 / n);
+    }
+
+    start = benchNow();
+    for (size_t i = 0; i < n; i++)
+        if (hashTableGet(&table, keys.keys[(i * 7919) % n], &value) == HASH_TABLE_SUCCESS) checksum += value;
+    printf("chained get        %6.1f ns/key  [%lld]\n", (benchNow() - start) * 1e9 / n, checksum);
+
+    hashTableClear(&mapped);
+    hashTableClear(&table);
+    remove(path);
+    benchKeysFree(&keys);
+}
+
+#define BENCH_LAB_TABLE_SIZE 200    ///< TABLE_SIZE из labs/asd_lab_8_task.c
+
+/// @brief Узел таблицы из labs/asd_lab_8_task.c (ключ копируется в узел)
+typedef struct BenchLabNode {
+    char word[100];               ///< Ключ
+    int value;                    ///< Значение
+    struct BenchLabNode* next;    ///< Следующий узел цепочки
+} BenchLabNode;
+
+/// @brief Хеш-функция hash() из labs/asd_lab_8_task.c
+static unsigned int benchLabHash(const char* word) {
+    unsigned int hashValue = 0;
+
+    while (*word) hashValue = (hashValue << 5) + *word++;
+
+    return hashValue % BENCH_LAB_TABLE_SIZE;
+}
+
+/// @brief Время поиска (нс на ключ) в таблицах разных видов на одном наборе ключей
+static void benchPerfectSet(const char* title, const char* const* keys, size_t n, size_t lookups) {
+    int* values = (int*)malloc(n * sizeof(int));
+    const char** order = (const char**)malloc(lookups * sizeof(char*));
+    BenchLabNode** lab = (BenchLabNode**)calloc(BENCH_LAB_TABLE_SIZE, sizeof(BenchLabNode*));
+    BenchLabNode* labNodes = (BenchLabNode*)malloc(n * sizeof(BenchLabNode));
+    HashTable_ErrorCode* status = (HashTable_ErrorCode*)malloc(64 * sizeof(HashTable_ErrorCode));
+    int batchValues[64];
+    long long checksum = 0;
+    int value;
+
+    if (!values || !order || !lab || !labNodes || !status) {
+        printf("недостаточно памяти\n");
+        goto done;
+    }
+
+    for (size_t i = 0; i < n; i++) values[i] = (int)i;
+    for (size_t i = 0; i < lookups; i++) order[i] = keys[(i * 7919) % n];
+
+    HashTable perfect;
+    double start = benchNow();
+    if (hashTableBuildPerfect(&perfect, keys, values, n) != HASH_TABLE_SUCCESS) {
+        printf("не удалось построить идеальную функцию\n");
+        goto done;
+    }
+    double buildTime = benchNow() - start;
+
+    printf("%s: %zu keys, build %.1f ms, %.2f bits/key metadata\n", title, n, buildTime * 1e3,
+           (perfect.pilotCount * 8.0 + (perfect.positions - n) * 32.0 + perfect.largePilotCount * 64.0) / n);
+
+    start = benchNow();
+    for (size_t i = 0; i < lookups; i++)
+        if (hashTableGet(&perfect, order[i], &value) == HASH_TABLE_SUCCESS) checksum += value;
+    printf("  perfect get       %7.1f ns/key\n", (benchNow() - start) * 1e9 / lookups);
+
+    start = benchNow();
+    for (size_t i = 0; i < lookups; i += 64) {
+        hashTableGetBatch(&perfect, order + i, lookups - i < 64 ? lookups - i : 64, batchValues, status);
+        checksum += batchValues[0];
+    }
+    printf("  perfect batch 64  %7.1f ns/key\n", (benchNow() - start) * 1e9 / lookups);
+
+    for (int backend = 0; backend < 2; backend++) {
+        HashTable table;
+
+        if (backend == 0) hashTableInit(&table, n);
+        else hashTableInitFlat(&table, n);
+
+        for (size_t i = 0; i < n; i++) hashTableInsertUnique(&table, keys[i], (int)i);
+
+        start = benchNow();
+        for (size_t i = 0; i < lookups; i++)
+            if (hashTableGet(&table, order[i], &value) == HASH_TABLE_SUCCESS) checksum += value;
+        printf("  %-7s get       %7.1f ns/key\n", backend ? "flat" : "chained", (benchNow() - start) * 1e9 / lookups);
+
+        hashTableClear(&table);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        unsigned int index = benchLabHash(keys[i]);
+
+        strncpy(labNodes[i].word, keys[i], sizeof(labNodes[i].word) - 1);
+        labNodes[i].word[sizeof(labNodes[i].word) - 1] = '\0';
+        labNodes[i].value = (int)i;
+        labNodes[i].next = lab[index];
+        lab[index] = &labNodes[i];
+    }
+
+    // Цепочки лабораторной таблицы растут как n / 200, поэтому на больших наборах
+    // замеряется только часть поисков
+    size_t labLookups = n > 10000 ? lookups / 1000 : lookups;
+
+    start = benchNow();
+    for (size_t i = 0; i < labLookups; i++) {
+        BenchLabNode* node = lab[benchLabHash(order[i])];
+
+        while (node && strcmp(node->word, order[i]) != 0) node = node->next;
+        if (node) checksum += node->value;
+    }
+    printf("  lab 8 hash+chain  %7.1f ns/key  [%lld]\n", (benchNow() - start) * 1e9 / labLookups, checksum);
+
+    hashTableClear(&perfect);
+
+done:
+    free(values);
+    free(order);
+    free(lab);
+    free(labNodes);
+    free(status);
+}
+
+/// @brief Идеальное хеширование против hashTableGet и таблицы из лабораторной 8
+/// @details ./hash_table --bench perfect [N], по умолчанию N = 1M. Первый набор -
+///          словарь числительных, как в createNumberDict, второй - N ключей.
+static void benchPerfect(int argc, char** argv) {
+    size_t n = argc > 0 ? strtoull(argv[0], NULL, 10) : 1000000;
+    static const char* const numbers[] = {
+        "ноль", "один", "два", "три", "четыре", "пять", "шесть", "семь", "восемь", "девять", "десять",
+        "одиннадцать", "двенадцать", "тринадцать", "четырнадцать", "пятнадцать", "шестнадцать",
+        "семнадцать", "восемнадцать", "девятнадцать", "двадцать", "тридцать", "сорок", "пятьдесят",
+        "шестьдесят", "семьдесят", "восемьдесят", "девяносто", "сто", "двести", "триста", "четыреста",
+        "пятьсот", "шестьсот", "семьсот", "восемьсот", "девятьсот", "тысяча"};
+    BenchKeys keys;
+
+    benchPerfectSet("number words", numbers, sizeof(numbers) / sizeof(numbers[0]), 10000000);
+
+    if (!benchKeysInit(&keys, n, "key")) {
+        printf("недостаточно памяти\n");
+        return;
+    }
+
+    benchPerfectSet("random keys", (const char* const*)keys.keys, n, n);
+    benchKeysFree(&keys);
+}
+
+/// @brief Запускает бенчмарк по имени
+/// @param argc Количество параметров после "--bench"
+/// @param argv Имя бенчмарка и его параметры
+/// @return 0 в случае успеха, 1 если бенчмарк неизвестен
+static int hashTableBenchmarks(int argc, char** argv) {
+    if (argc >= 1 && strcmp(argv[0], "backends") == 0) {
+        benchBackends(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "growth") == 0) {
+        benchGrowth(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "concurrent") == 0) {
+        benchConcurrent(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "memory") == 0) {
+        benchMemory(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "batch") == 0) {
+        benchBatch(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "hash") == 0) {
+        benchHash(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "scan") == 0) {
+        benchScan(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "snapshot") == 0) {
+        benchSnapshot(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "perfect") == 0) {
+        benchPerfect(argc - 1, argv + 1);
+        return 0;
+    }
+
+    printf("Доступные бенчмарки: backends, growth, concurrent, memory, batch, hash, scan, snapshot, perfect\n");
+
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    hashTableTests();
+    hashTableFlatTests();
+    hashTableGrowthTests();
+    hashTableKeyStorageTests();
+    hashTableBatchTests();
+    hashTableHashFunctionTests();
+    hashTableIteratorTests();
+    hashTableSnapshotTests();
+    hashTablePerfectTests();
+    hashTableStatsTests();
+    hashTableShardedTests();
+
+    printf("All hash table tests passed!\n");
+
+    if (argc >= 2 && strcmp(argv[1], "--bench") == 0) return hashTableBenchmarks(argc - 2, argv + 2);
+
+    return 0;
+}
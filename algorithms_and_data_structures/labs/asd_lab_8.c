@@ -1,9 +1,22 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
 #include <assert.h>
 
-#define TABLE_SIZE 100  ///< Размер хеш-таблицы
-#define PRIME 7         ///< Простое число для вторичного хеширования
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HT_X86 1                ///< Доступны AVX2-путь и проверка процессора
+#endif
+
+#define TABLE_SIZE 100          ///< Размер хеш-таблицы по умолчанию
+#define MIN_TABLE_SIZE 8        ///< Наименьшая ёмкость таблицы
+#define DEFAULT_MAX_LOAD 0.75   ///< Загрузка (с надгробиями), при которой таблица перестраивается
+#define BUCKET_SLOTS 8          ///< Ключей в корзине: 8 * 4 байта - один регистр AVX2
+#define CUCKOO_WAYS 4           ///< Слотов в корзине кукушки: 4 * 8 байт - половина строки кеша
+#define CUCKOO_STASH_SIZE 8     ///< Размер запаса для элементов, которым не нашлось места
+#define CUCKOO_BFS_NODES 256    ///< Наибольшее число корзин в поиске цепочки переездов
 
 /**
  * @brief Структура элемента таблицы.
@@ -13,12 +26,48 @@ typedef struct {
     int value;    ///< Значение элемента.
 } HashItem;
 
+/**
+ * @brief Способ размещения ключей.
+ */
+typedef enum {
+    HT_MODE_DOUBLE_HASHING,  ///< Двойное хеширование по отдельным слотам (по умолчанию).
+    HT_MODE_BUCKETIZED,      ///< Корзины по 8 ключей, корзина сравнивается с ключом целиком.
+    HT_MODE_ROBIN_HOOD,      ///< Линейное пробирование Robin Hood, удаление сдвигом без надгробий.
+    HT_MODE_CUCKOO           ///< Кукушка: 2 корзины по 4 слота на ключ, поиск не дальше двух корзин.
+} HashTableMode;
+
 /**
  * @brief Структура хеш-таблицы.
+ * @details Пары ключ-значение лежат прямо в массиве слотов, поэтому шаг пробирования
+ * не требует перехода по указателю. Признаки занятого и удалённого слота хранятся
+ * в отдельных битовых масках: они в 64 раза меньше массива слотов и почти всегда
+ * находятся в кеше, так что пустые и удалённые слоты проверяются без чтения самих слотов.
+ * Размер - степень двойки; когда занятые слоты и надгробия превышают maxLoad,
+ * таблица перестраивается (при необходимости с удвоением размера).
+ * В режиме корзин вместо items используются отдельные массивы keys и values:
+ * 8 ключей корзины занимают 32 байта и сравниваются с искомым ключом за одну
+ * команду, а значения читаются только для совпавшего слота.
+ * В режиме Robin Hood для каждого слота хранится расстояние от начального слота
+ * его элемента; надгробий в этом режиме не бывает.
+ * В режиме кукушки ключ лежит в одной из двух своих корзин по 4 слота или в
+ * небольшом запасе, а пустые слоты заполнены ключом, который в них не ищут.
  */
 typedef struct {
-    HashItem** items;  ///< Массив указателей на элементы.
-    int size;          ///< Размер таблицы.
+    HashTableMode mode;  ///< Способ размещения ключей.
+    HashItem* items;     ///< Массив слотов (двойное хеширование, Robin Hood, кукушка).
+    int* keys;           ///< Ключи корзин, выровнены по 32 байта (режим корзин).
+    int* values;         ///< Значения корзин (режим корзин).
+    uint8_t* distances;  ///< Расстояние от начального слота + 1, 0 - пустой слот (Robin Hood).
+    uint64_t* occupied;  ///< Биты занятых слотов.
+    uint64_t* deleted;   ///< Биты слотов, из которых удалён элемент (надгробия).
+    int size;            ///< Размер таблицы (степень двойки).
+    int bits;            ///< log2(size).
+    int count;           ///< Количество элементов.
+    int tombstones;      ///< Количество надгробий.
+    double maxLoad;      ///< Наибольшая доля занятых слотов и надгробий.
+    HashItem stash[CUCKOO_STASH_SIZE];  ///< Запас (кукушка).
+    int stashCount;      ///< Количество элементов в запасе.
+    int fillers[2];      ///< Ключи-заполнители пустых слотов (кукушка).
 } HashTable;
 
 /**
@@ -32,247 +81,2019 @@ typedef enum {
     HT_KEY_EXISTS        ///< Ключ уже существует в таблице.
 } HashTableStatus;
 
+/**
+ * @brief Перемешивание ключа (финализатор splitmix64).
+ * @details Мультипликативный хеш переводит арифметическую прогрессию ключей в
+ * регулярную решётку слотов, и линейная по номеру пробы последовательность
+ * проходит вдоль неё по одним занятым слотам. После перемешивания каждый бит
+ * результата зависит от всех бит ключа, и такой структуры не остаётся.
+ * @param key Ключ.
+ * @return 64-битный хеш ключа.
+ */
+static inline uint64_t mixKey(int key) {
+    uint64_t hash = (uint64_t)(uint32_t)key + 0x9E3779B97F4A7C15ULL;
+
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+
+    return hash ^ (hash >> 31);
+}
+
 /**
  * @brief Функция первичного хеширования.
+ * @details Индекс - старшие bits бит хеша: размер таблицы - степень двойки, поэтому
+ * вместо деления по модулю достаточно сдвига.
+ * @param table Указатель на таблицу.
  * @param key Ключ.
  * @return Индекс в таблице.
  */
-int primaryHash(int key) { return key % TABLE_SIZE; }
+int primaryHash(const HashTable* table, int key) {
+    return (int)(mixKey(key) >> (64 - table->bits));
+}
 
 /**
  * @brief Функция вторичного хеширования.
+ * @details Шаг берётся из младшей половины хеша, независимой от начального слота,
+ * и делается нечётным: нечётный шаг взаимно прост с размером-степенью двойки,
+ * поэтому последовательность проб обходит все слоты таблицы.
+ * @param table Указатель на таблицу.
  * @param key Ключ.
  * @return Шаг для двойного хеширования.
  */
-int secondaryHash(int key) { return PRIME - (key % PRIME); }
+int secondaryHash(const HashTable* table, int key) {
+    return (int)(((uint32_t)mixKey(key) >> (32 - table->bits)) | 1);
+}
 
 /**
- * @brief Инициализация хеш-таблицы.
- * @param size Размер таблицы.
- * @return Указатель на созданную таблицу.
+ * @brief Проверка бита в битовой маске.
  */
-HashTable* createTable(int size) {
-    HashTable* table = (HashTable*)malloc(sizeof(HashTable));
+static inline int testBit(const uint64_t* bits, int index) { return (bits[index >> 6] >> (index & 63)) & 1; }
 
-    if (!table) return NULL;
+/**
+ * @brief Установка бита в битовой маске.
+ */
+static inline void setBit(uint64_t* bits, int index) { bits[index >> 6] |= 1ULL << (index & 63); }
 
-    table->size = size;
-    table->items = (HashItem**)calloc(size, sizeof(HashItem*));
+/**
+ * @brief Сброс бита в битовой маске.
+ */
+static inline void clearBit(uint64_t* bits, int index) { bits[index >> 6] &= ~(1ULL << (index & 63)); }
 
-    return table;
+/**
+ * @brief Индекс слота на i-м шаге пробирования.
+ * @param table Указатель на таблицу.
+ * @param key Ключ.
+ * @param i Номер шага.
+ * @return Индекс слота.
+ */
+static inline int probeIndex(const HashTable* table, int key, int i) {
+    return (int)(((uint32_t)primaryHash(table, key) + (uint32_t)i * (uint32_t)secondaryHash(table, key)) &
+                 (uint32_t)(table->size - 1));
 }
 
 /**
- * @brief Освобождение памяти, занятой хеш-таблицей.
- * @param table Указатель на хеш-таблицу.
+ * @brief Байт битовой маски: 8 бит слотов одной корзины.
+ * @param bits Битовая маска слотов.
+ * @param bucket Номер корзины.
+ * @return Бит i установлен для i-го слота корзины.
  */
-void freeTable(HashTable* table) {
-    if (!table) return;
+static inline int bucketByte(const uint64_t* bits, int bucket) {
+    return (int)((bits[bucket >> 3] >> ((bucket & 7) * 8)) & 0xFF);
+}
 
-    for (int i = 0; i < table->size; i++) 
-        if (table->items[i]) free(table->items[i]);
-    
-    free(table->items);
-    free(table);
+/**
+ * @brief Сравнение ключа с корзиной без SIMD.
+ * @return Маска слотов корзины, ключ которых равен key.
+ */
+static inline int bucketMatchScalar(const int* keys, int key) {
+    int match = 0;
+
+    for (int i = 0; i < BUCKET_SLOTS; i++) match |= (keys[i] == key) << i;
+
+    return match;
 }
 
+#ifdef HT_X86
 /**
- * @brief Вставка элемента в хеш-таблицу.
+ * @brief Сравнение ключа с корзиной одной командой AVX2 (сравнение и movemask).
+ * @return Маска слотов корзины, ключ которых равен key.
+ */
+__attribute__((target("avx2"))) static inline int bucketMatchAvx2(const int* keys, int key) {
+    __m256i bucket = _mm256_load_si256((const __m256i*)keys);
+    __m256i equal = _mm256_cmpeq_epi32(bucket, _mm256_set1_epi32(key));
+
+    return _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+}
+#endif
+
+/**
+ * @brief Поиск слота ключа в режиме корзин.
+ * @details Корзины обходятся с треугольными шагами 1, 2, 3, ...: при степени двойки
+ * такая последовательность проходит все корзины. Поиск заканчивается на корзине,
+ * в которой есть пустой слот: вставка перешла бы в следующую корзину только через
+ * заполненную. Поэтому удаление из корзины без пустых слотов оставляет надгробие.
+ * Функция встраивается в обе версии поиска, avx2 - константа.
  * @param table Указатель на таблицу.
- * @param key Ключ элемента.
- * @param value Значение элемента.
- * @return Код состояния операции.
+ * @param key Ключ.
+ * @param avx2 Сравнивать корзину командой AVX2.
+ * @return Индекс слота или -1.
  */
-HashTableStatus insertItem(HashTable* table, int key, int value) {
-    if (!table) return HT_MEMORY_ERROR;
+static inline __attribute__((always_inline)) int bucketFind(const HashTable* table, int key, int avx2) {
+    int buckets = table->size / BUCKET_SLOTS;
+    int bucket = primaryHash(table, key) / BUCKET_SLOTS;
 
-    int index = primaryHash(key);
-    int step = secondaryHash(key);
+    (void)avx2;
 
-    for (int i = 0; i < table->size; i++) {
-        int newIndex = (index + i * step) % table->size;
-        
-        if (!table->items[newIndex]) { // Пустая ячейка
-            table->items[newIndex] = (HashItem*)malloc(sizeof(HashItem));
+    // Значения лежат в другом массиве: их строка кеша загружается параллельно с ключами
+    __builtin_prefetch(table->values + bucket * BUCKET_SLOTS);
 
-            if (!table->items[newIndex]) return HT_MEMORY_ERROR;
+    for (int step = 1; step <= buckets; step++) {
+        const int* keys = table->keys + bucket * BUCKET_SLOTS;
+#ifdef HT_X86
+        int match = avx2 ? bucketMatchAvx2(keys, key) : bucketMatchScalar(keys, key);
+#else
+        int match = bucketMatchScalar(keys, key);
+#endif
+        int occupied = bucketByte(table->occupied, bucket);
 
-            table->items[newIndex]->key = key;
-            table->items[newIndex]->value = value;
+        match &= occupied;
+        if (match) return bucket * BUCKET_SLOTS + __builtin_ctz(match);
 
-            return HT_SUCCESS;
+        if (~(occupied | bucketByte(table->deleted, bucket)) & 0xFF) return -1;
 
-        } else if (table->items[newIndex]->key == key) 
-            return HT_KEY_EXISTS;
-        
+        bucket = (bucket + step) & (buckets - 1);
     }
 
-    return HT_TABLE_FULL;
+    return -1;
 }
 
 /**
- * @brief Поиск элемента в хеш-таблице.
+ * @brief Поиск в режиме корзин без SIMD (запасной путь для процессоров без AVX2).
+ */
+static int bucketFindScalar(const HashTable* table, int key) { return bucketFind(table, key, 0); }
+
+#ifdef HT_X86
+/**
+ * @brief Поиск в режиме корзин с AVX2; вызывается только если процессор его поддерживает.
+ * @details Верхние половины регистров ymm обнуляются явно: без -O2 gcc не вставляет
+ * vzeroupper сам, и SSE-код вызывающего (арифметика double в insertItem) после этого
+ * выполняется с задержками перехода, вставка замедляется в 10 раз.
+ */
+__attribute__((target("avx2"))) static int bucketFindAvx2(const HashTable* table, int key) {
+    int index = bucketFind(table, key, 1);
+
+    _mm256_zeroupper();
+
+    return index;
+}
+#endif
+
+/**
+ * @brief Использовать ли AVX2 в режиме корзин: -1 - ещё не проверено, 0 - нет, 1 - да.
+ */
+static int bucketAvx2 = -1;
+
+/**
+ * @brief Поиск слота ключа в режиме корзин с выбором реализации по процессору.
  * @param table Указатель на таблицу.
- * @param key Ключ элемента.
- * @param value Указатель для хранения найденного значения.
- * @return Код состояния операции.
+ * @param key Ключ.
+ * @return Индекс слота или -1.
  */
-HashTableStatus findItem(HashTable* table, int key, int* value) {
-    if (!table) return HT_MEMORY_ERROR;
+static int bucketLookup(const HashTable* table, int key) {
+#ifdef HT_X86
+    if (bucketAvx2 < 0) bucketAvx2 = __builtin_cpu_supports("avx2") != 0;
+    if (bucketAvx2) return bucketFindAvx2(table, key);
+#endif
 
-    int index = primaryHash(key);
-    int step = secondaryHash(key);
+    return bucketFindScalar(table, key);
+}
 
-    for (int i = 0; i < table->size; i++) {
-        int newIndex = (index + i * step) % table->size;
-        
-        if (table->items[newIndex] && table->items[newIndex]->key == key) {
-            *value = table->items[newIndex]->value;
+/**
+ * @brief Первый не занятый слот (пустой или надгробие) на пути ключа в режиме корзин.
+ * @param table Указатель на таблицу.
+ * @param key Ключ.
+ * @return Индекс слота или -1, если все слоты заняты.
+ */
+static int bucketFreeSlot(const HashTable* table, int key) {
+    int buckets = table->size / BUCKET_SLOTS;
+    int bucket = primaryHash(table, key) / BUCKET_SLOTS;
 
-            return HT_SUCCESS;
-        }
+    for (int step = 1; step <= buckets; step++) {
+        int vacant = ~bucketByte(table->occupied, bucket) & 0xFF;
+
+        if (vacant) return bucket * BUCKET_SLOTS + __builtin_ctz(vacant);
+
+        bucket = (bucket + step) & (buckets - 1);
     }
 
-    return HT_KEY_NOT_FOUND;
+    return -1;
 }
 
+static HashTableStatus rehashTable(HashTable* table, int size);
+
 /**
- * @brief Удаление элемента из хеш-таблицы.
+ * @brief Размещение элемента по правилу Robin Hood, начиная со слота index.
+ * @details Идём вперёд по слотам; элемент, который ушёл от своего начального слота
+ * дальше, чем текущий житель слота, занимает слот, а житель продолжает путь вместо
+ * него. Поэтому расстояния в цепочке растут не больше чем на 1 за слот, и поиск
+ * отсутствующего ключа останавливается, как только встречает "более богатый" элемент.
+ * Расстояние хранится в байте; если какому-то элементу цепочки не хватит 254 шагов,
+ * таблица удваивается до первой перестановки, и элемент размещается заново. Поэтому
+ * при ошибке перестроения таблица не меняется.
  * @param table Указатель на таблицу.
- * @param key Ключ элемента.
- * @return Код состояния операции.
+ * @param item Элемент (ключа в таблице нет).
+ * @param index Слот, с которого продолжается путь.
+ * @param distance Расстояние index от начального слота элемента + 1.
+ * @return Код состояния операции (при ошибке таблица не меняется).
  */
-HashTableStatus deleteItem(HashTable* table, int key) {
-    if (!table) return HT_MEMORY_ERROR;
+static HashTableStatus robinPlace(HashTable* table, HashItem item, int index, int distance) {
+    for (;;) {
+        // Пробный проход без записи: до пустого слота несомое расстояние не должно выйти за байт
+        int slot = index;
+        int carried = distance;
 
-    int index = primaryHash(key);
-    int step = secondaryHash(key);
+        while (carried <= UINT8_MAX && table->distances[slot] != 0) {
+            if (table->distances[slot] < carried) carried = table->distances[slot];
 
-    for (int i = 0; i < table->size; i++) {
-        int newIndex = (index + i * step) % table->size;
-        
-        if (table->items[newIndex] && table->items[newIndex]->key == key) {
-            free(table->items[newIndex]);
+            slot = (slot + 1) & (table->size - 1);
+            carried++;
+        }
+
+        if (carried <= UINT8_MAX) break;
+        if (table->size >= (1 << 30)) return HT_TABLE_FULL;
 
-            table->items[newIndex] = NULL;
+        HashTableStatus status = rehashTable(table, table->size * 2);
+
+        if (status != HT_SUCCESS) return status;
+
+        index = primaryHash(table, item.key);
+        distance = 1;
+    }
+
+    for (;;) {
+        int current = table->distances[index];
+
+        if (current == 0) {
+            table->items[index] = item;
+            table->distances[index] = (uint8_t)distance;
+            setBit(table->occupied, index);
 
             return HT_SUCCESS;
         }
-    }
 
-    return HT_KEY_NOT_FOUND;
+        if (current < distance) {
+            HashItem displaced = table->items[index];
+
+            table->items[index] = item;
+            table->distances[index] = (uint8_t)distance;
+            item = displaced;
+            distance = current;
+        }
+
+        index = (index + 1) & (table->size - 1);
+        distance++;
+    }
 }
 
 /**
- * @brief Вывод хеш-таблицы в консоль.
+ * @brief Поиск слота ключа в режиме Robin Hood.
+ * @details Поиск идёт, пока расстояние слота от его начала не меньше пройденного:
+ * житель, который ближе к своему началу, был бы вытеснен искомым ключом при вставке,
+ * значит, дальше ключа нет. Пустой слот (расстояние 0) обрывает поиск так же.
  * @param table Указатель на таблицу.
+ * @param key Ключ.
+ * @param stop Если не NULL, сюда записываются слот и расстояние, на которых поиск остановился.
+ * @return Индекс слота или -1.
  */
-void printTable(const HashTable* table) {
-    if (!table) {
-        printf("Хеш-таблица не инициализирована.\n");
-        return;
+static int robinFind(const HashTable* table, int key, int stop[2]) {
+    int index = primaryHash(table, key);
+    int distance = 1;
+
+    for (; distance <= table->distances[index]; distance++) {
+        if (table->items[index].key == key) return index;
+
+        index = (index + 1) & (table->size - 1);
     }
 
-    printf("\n------------------ Хеш-таблица ------------------\n");
-    printf("|  Индекс  |       Ключ       |     Значение    |\n");
-    printf("|----------|------------------|-----------------|\n");
+    if (stop) {
+        stop[0] = index;
+        stop[1] = distance;
+    }
 
-    for (int i = 0; i < table->size; i++) {
-        if (table->items[i] != NULL) {
-            printf("| %8d | %15d | %13d  |\n", i, table->items[i]->key, table->items[i]->value);
-        } else {
-            printf("| %8d |       ---       |      Пусто     |\n", i);
+    return -1;
+}
+
+/**
+ * @brief Номера двух корзин ключа в режиме кукушки.
+ * @details Первая корзина - старшие биты хеша (как у primaryHash), вторая - старшие
+ * биты его младшей половины; корзина - 4 соседних слота.
+ * @param table Указатель на таблицу.
+ * @param key Ключ.
+ * @param buckets Сюда записываются номера корзин.
+ */
+static inline void cuckooBuckets(const HashTable* table, int key, int buckets[2]) {
+    uint64_t hash = mixKey(key);
+
+    buckets[0] = (int)(hash >> (64 - table->bits + 2));
+    buckets[1] = (int)((uint32_t)hash >> (32 - table->bits + 2));
+}
+
+/**
+ * @brief Выбор ключей-заполнителей для пустых слотов в режиме кукушки.
+ * @details Поиск сравнивает ключ со всеми 4 слотами корзины, не читая битовую маску,
+ * поэтому в пустом слоте должен лежать ключ, который в этой корзине никогда не ищут.
+ * Берутся два ключа с непересекающимися парами корзин: в корзинах первого
+ * заполнителем служит второй, во всех остальных - первый.
+ * @param table Указатель на таблицу (размер уже задан).
+ */
+static void cuckooChooseFillers(HashTable* table) {
+    for (int first = 0;; first++) {
+        int a[2];
+
+        cuckooBuckets(table, first, a);
+
+        for (int second = first + 1; second < first + 1024; second++) {
+            int b[2];
+
+            cuckooBuckets(table, second, b);
+
+            if (a[0] != b[0] && a[0] != b[1] && a[1] != b[0] && a[1] != b[1]) {
+                table->fillers[0] = first;
+                table->fillers[1] = second;
+                return;
+            }
         }
     }
+}
 
-    printf("------------------------------------------------\n\n");
+/**
+ * @brief Ключ-заполнитель пустых слотов корзины.
+ */
+static inline int cuckooFiller(const HashTable* table, int bucket) {
+    int first[2];
+
+    cuckooBuckets(table, table->fillers[0], first);
+
+    return bucket == first[0] || bucket == first[1] ? table->fillers[1] : table->fillers[0];
 }
 
 /**
- * @brief Тест функции вставки.
+ * @brief Поиск элемента в режиме кукушки.
+ * @details Ключ может лежать только в одной из двух своих корзин или в запасе,
+ * поэтому поиск читает не больше двух строк кеша (корзина - 32 байта, массив выровнен
+ * по 64) и запас, только если он не пуст.
+ * @param table Указатель на таблицу.
+ * @param key Ключ.
+ * @return Указатель на слот или элемент запаса, либо NULL.
  */
-void testInsertItem() {
-    HashTable* table = createTable(TABLE_SIZE);
-    assert(table != NULL);
+static HashItem* cuckooFind(HashTable* table, int key) {
+    int buckets[2];
 
-    printf("Тест вставки:\n");
+    cuckooBuckets(table, key, buckets);
 
-    assert(insertItem(table, 1, 100) == HT_SUCCESS);
-    assert(insertItem(table, 2, 200) == HT_SUCCESS);
+    for (int b = 0; b < 2; b++) {
+        HashItem* bucket = table->items + buckets[b] * CUCKOO_WAYS;
 
-    assert(insertItem(table, 1, 300) == HT_KEY_EXISTS);
+        for (int i = 0; i < CUCKOO_WAYS; i++)
+            if (bucket[i].key == key) return &bucket[i];
+    }
 
-    for (int i = 0; i < TABLE_SIZE; i++) 
-        insertItem(table, i + 3, i * 10);
-    
-    assert(insertItem(table, 999, 500) == HT_TABLE_FULL);
+    for (int i = 0; i < table->stashCount; i++)
+        if (table->stash[i].key == key) return &table->stash[i];
 
-    printTable(table);
+    return NULL;
+}
 
-    freeTable(table);
+/**
+ * @brief Свободные слоты корзины в режиме кукушки.
+ * @return Маска из 4 бит.
+ */
+static inline int cuckooVacant(const HashTable* table, int bucket) {
+    return (int)(~(table->occupied[bucket >> 4] >> ((bucket & 15) * CUCKOO_WAYS)) & 0xF);
+}
 
-    printf("Тест вставки пройден.\n\n");
+/**
+ * @brief Вершина поиска в ширину: корзина и слот родителя, элемент которого в неё переезжает.
+ */
+typedef struct {
+    int bucket;  ///< Номер корзины.
+    int parent;  ///< Вершина-родитель (-1 у двух начальных корзин).
+    int slot;    ///< Слот родителя, элемент которого переезжает в эту корзину.
+} CuckooNode;
+
+/**
+ * @brief Есть ли корзина на пути от вершины к корню.
+ */
+static int cuckooOnPath(const CuckooNode* nodes, int node, int bucket) {
+    for (; node >= 0; node = nodes[node].parent)
+        if (nodes[node].bucket == bucket) return 1;
+
+    return 0;
 }
 
 /**
- * @brief Тест функции поиска.
+ * @brief Размещение элемента в режиме кукушки (ключа в таблице нет).
+ * @details Поиск в ширину от двух корзин ключа находит кратчайшую цепочку переездов
+ * до корзины со свободным слотом; корзины на пути различны, поэтому переезды
+ * выполняются с конца цепочки, и каждый освобождает слот для следующего. Если
+ * цепочки не нашлось, элемент попадает в запас, а при полном запасе таблица
+ * удваивается.
+ * @param table Указатель на таблицу.
+ * @param item Элемент.
+ * @return Код состояния операции.
  */
-void testFindItem() {
-    HashTable* table = createTable(TABLE_SIZE);
-    assert(table != NULL);
+static HashTableStatus cuckooPlace(HashTable* table, HashItem item) {
+    CuckooNode nodes[CUCKOO_BFS_NODES];
 
-    int value;
-    printf("Тест поиска:\n");
+    for (;;) {
+        int buckets[2];
+        int tail = 2;
+        int found = -1;
 
-    insertItem(table, 1, 100);
-    assert(findItem(table, 1, &value) == HT_SUCCESS);
-    assert(value == 100);
+        cuckooBuckets(table, item.key, buckets);
+        nodes[0] = (CuckooNode){buckets[0], -1, -1};
+        nodes[1] = (CuckooNode){buckets[1], -1, -1};
 
-    assert(findItem(table, 99, &value) == HT_KEY_NOT_FOUND);
+        for (int head = 0; head < tail; head++) {
+            int bucket = nodes[head].bucket;
 
-    insertItem(table, TABLE_SIZE + 1, 200);
-    assert(findItem(table, TABLE_SIZE + 1, &value) == HT_SUCCESS);
-    assert(value == 200);
+            if (cuckooVacant(table, bucket)) {
+                found = head;
+                break;
+            }
 
-    printTable(table);
+            for (int slot = 0; slot < CUCKOO_WAYS && tail < CUCKOO_BFS_NODES; slot++) {
+                int alternatives[2];
 
-    freeTable(table);
+                cuckooBuckets(table, table->items[bucket * CUCKOO_WAYS + slot].key, alternatives);
 
-    printf("Тест поиска пройден.\n\n");
+                int next = alternatives[0] == bucket ? alternatives[1] : alternatives[0];
+
+                if (!cuckooOnPath(nodes, head, next)) nodes[tail++] = (CuckooNode){next, head, slot};
+            }
+        }
+
+        if (found >= 0) {
+            // Переезды с конца цепочки: каждый освобождает слот родителя
+            for (int node = found; node >= 0; node = nodes[node].parent) {
+                int bucket = nodes[node].bucket;
+                int to = bucket * CUCKOO_WAYS + __builtin_ctz(cuckooVacant(table, bucket));
+                HashItem moved = item;
+
+                if (nodes[node].parent >= 0) {
+                    int parent = nodes[nodes[node].parent].bucket;
+                    int from = parent * CUCKOO_WAYS + nodes[node].slot;
+
+                    moved = table->items[from];
+                    table->items[from].key = cuckooFiller(table, parent);
+                    clearBit(table->occupied, from);
+                }
+
+                table->items[to] = moved;
+                setBit(table->occupied, to);
+            }
+
+            return HT_SUCCESS;
+        }
+
+        if (table->stashCount < CUCKOO_STASH_SIZE) {
+            table->stash[table->stashCount++] = item;
+            return HT_SUCCESS;
+        }
+
+        if (table->size >= (1 << 30)) return HT_TABLE_FULL;
+
+        HashTableStatus status = rehashTable(table, table->size * 2);
+
+        if (status != HT_SUCCESS) return status;
+    }
 }
 
 /**
- * @brief Тест функции удаления.
+ * @brief Сколько следующих выделений массивов завершится ошибкой (для тестов).
  */
-void testDeleteItem() {
-    HashTable* table = createTable(TABLE_SIZE);
-    assert(table != NULL);
+static int failAllocations = 0;
 
-    printf("Тест удаления:\n");
+/**
+ * @brief Выделение пустых массивов таблицы заданного размера.
+ * @param table Указатель на таблицу.
+ * @param size Размер (степень двойки).
+ * @return Код состояния операции (при ошибке таблица не меняется).
+ */
+static HashTableStatus allocateSlots(HashTable* table, int size) {
+    if (failAllocations > 0) {
+        failAllocations--;
+        return HT_MEMORY_ERROR;
+    }
 
-    insertItem(table, 1, 100);
-    assert(deleteItem(table, 1) == HT_SUCCESS);
+    int words = (size + 63) / 64;
+    int bucketized = table->mode == HT_MODE_BUCKETIZED;
+    HashItem* items = NULL;
+    // Корзины кукушки по 32 байта не пересекают границу строки кеша
+    if (table->mode == HT_MODE_CUCKOO) items = (HashItem*)aligned_alloc(64, (size_t)size * sizeof(HashItem));
+    else if (!bucketized) items = (HashItem*)malloc((size_t)size * sizeof(HashItem));
+    // size - степень двойки не меньше 8, поэтому размер кратен выравниванию
+    int* keys = bucketized ? (int*)aligned_alloc(32, (size_t)size * sizeof(int)) : NULL;
+    int* values = bucketized ? (int*)malloc((size_t)size * sizeof(int)) : NULL;
+    uint8_t* distances = table->mode == HT_MODE_ROBIN_HOOD ? (uint8_t*)calloc(size, 1) : NULL;
+    uint64_t* occupied = (uint64_t*)calloc(words, sizeof(uint64_t));
+    uint64_t* deleted = (uint64_t*)calloc(words, sizeof(uint64_t));
 
-    assert(deleteItem(table, 2) == HT_KEY_NOT_FOUND);
-    assert(deleteItem(table, 1) == HT_KEY_NOT_FOUND);
+    if ((bucketized ? !keys || !values : !items) || (table->mode == HT_MODE_ROBIN_HOOD && !distances) ||
+        !occupied || !deleted) {
+        free(items);
+        free(keys);
+        free(values);
+        free(distances);
+        free(occupied);
+        free(deleted);
+        return HT_MEMORY_ERROR;
+    }
 
-    printTable(table);
+    // Свободные слоты корзины тоже сравниваются с ключом; их результат отбрасывается маской
+    if (bucketized) memset(keys, 0, (size_t)size * sizeof(int));
 
-    freeTable(table);
+    table->items = items;
+    table->keys = keys;
+    table->values = values;
+    table->distances = distances;
+    table->occupied = occupied;
+    table->deleted = deleted;
+    table->size = size;
+    table->bits = 0;
+    while ((1 << table->bits) < size) table->bits++;
+    table->count = 0;
+    table->tombstones = 0;
+    table->stashCount = 0;
 
-    printf("Тест удаления пройден.\n\n");
+    if (table->mode == HT_MODE_CUCKOO) {
+        cuckooChooseFillers(table);
+
+        for (int bucket = 0; bucket < size / CUCKOO_WAYS; bucket++) {
+            int filler = cuckooFiller(table, bucket);
+
+            for (int i = 0; i < CUCKOO_WAYS; i++) items[bucket * CUCKOO_WAYS + i].key = filler;
+        }
+    }
+
+    return HT_SUCCESS;
 }
 
 /**
- * @brief Главная функция для выполнения тестов.
+ * @brief Освобождение массивов таблицы (сама структура не освобождается).
+ * @param table Указатель на таблицу.
  */
-int main() {
+static void freeSlots(const HashTable* table) {
+    free(table->items);
+    free(table->keys);
+    free(table->values);
+    free(table->distances);
+    free(table->occupied);
+    free(table->deleted);
+}
 
-    testInsertItem();
-    testFindItem();
-    testDeleteItem();
+/**
+ * @brief Перестроение таблицы: перенос элементов в новые массивы без надгробий.
+ * @details Размещение Robin Hood и кукушки может само перестроить таблицу ещё раз;
+ * если оно не удалось, освобождаются массивы, которые таблица держит в этот момент,
+ * и возвращаются прежние.
+ * @param table Указатель на таблицу.
+ * @param size Новый размер (степень двойки, не меньше количества элементов).
+ * @return Код состояния операции (при ошибке таблица не меняется).
+ */
+static HashTableStatus rehashTable(HashTable* table, int size) {
+    HashTable old = *table;
+    HashTableStatus status = HT_SUCCESS;
 
-    printf("Все тесты пройдены.\n");
+    if (allocateSlots(table, size) != HT_SUCCESS) return HT_MEMORY_ERROR;
+
+    for (int i = 0; i < old.size && status == HT_SUCCESS; i++) {
+        if (!testBit(old.occupied, i)) continue;
+
+        // Ключи различны, поэтому достаточно найти первый пустой слот
+        if (table->mode == HT_MODE_BUCKETIZED) {
+            int index = bucketFreeSlot(table, old.keys[i]);
+
+            table->keys[index] = old.keys[i];
+            table->values[index] = old.values[i];
+            setBit(table->occupied, index);
+            table->count++;
+            continue;
+        }
+
+        if (table->mode == HT_MODE_ROBIN_HOOD) {
+            status = robinPlace(table, old.items[i], primaryHash(table, old.items[i].key), 1);
+            table->count += status == HT_SUCCESS;
+            continue;
+        }
+
+        if (table->mode == HT_MODE_CUCKOO) {
+            status = cuckooPlace(table, old.items[i]);
+            table->count += status == HT_SUCCESS;
+            continue;
+        }
+
+        int index = primaryHash(table, old.items[i].key);
+        int step = secondaryHash(table, old.items[i].key);
+
+        while (testBit(table->occupied, index)) index = (index + step) & (table->size - 1);
+
+        table->items[index] = old.items[i];
+        setBit(table->occupied, index);
+        table->count++;
+    }
+
+    for (int i = 0; i < old.stashCount && status == HT_SUCCESS; i++) {
+        status = cuckooPlace(table, old.stash[i]);
+        table->count += status == HT_SUCCESS;
+    }
+
+    if (status != HT_SUCCESS) {
+        freeSlots(table);
+        *table = old;
+        return status;
+    }
+
+    freeSlots(&old);
+
+    return HT_SUCCESS;
+}
+
+/**
+ * @brief Инициализация хеш-таблицы с заданным способом размещения ключей.
+ * @param size Ожидаемое количество элементов; ёмкость округляется вверх до степени двойки,
+ * при заполнении таблица растёт сама.
+ * @param mode Способ размещения ключей.
+ * @return Указатель на созданную таблицу.
+ */
+HashTable* createTableWithMode(int size, HashTableMode mode) {
+    HashTable* table = (HashTable*)malloc(sizeof(HashTable));
+
+    if (!table) return NULL;
+
+    int capacity = MIN_TABLE_SIZE;
+
+    while (capacity < size && capacity < (1 << 30)) capacity *= 2;
+
+    table->mode = mode;
+    table->maxLoad = DEFAULT_MAX_LOAD;
+
+    if (allocateSlots(table, capacity) != HT_SUCCESS) {
+        free(table);
+        return NULL;
+    }
+
+    return table;
+}
+
+/**
+ * @brief Инициализация хеш-таблицы с двойным хешированием.
+ * @param size Ожидаемое количество элементов.
+ * @return Указатель на созданную таблицу.
+ */
+HashTable* createTable(int size) {
+    return createTableWithMode(size, HT_MODE_DOUBLE_HASHING);
+}
+
+/**
+ * @brief Изменение наибольшей загрузки таблицы.
+ * @details Большая загрузка экономит память ценой более длинных цепочек проб.
+ * @param table Указатель на таблицу.
+ * @param maxLoad Доля занятых слотов и надгробий, от 0.1 до 0.99.
+ */
+void setMaxLoad(HashTable* table, double maxLoad) {
+    if (maxLoad < 0.1) maxLoad = 0.1;
+    if (maxLoad > 0.99) maxLoad = 0.99;
+
+    table->maxLoad = maxLoad;
+}
+
+/**
+ * @brief Освобождение памяти, занятой хеш-таблицей.
+ * @param table Указатель на хеш-таблицу.
+ */
+void freeTable(HashTable* table) {
+    if (!table) return;
+
+    freeSlots(table);
+    free(table);
+}
+
+/**
+ * @brief Вставка элемента в хеш-таблицу.
+ * @param table Указатель на таблицу.
+ * @param key Ключ элемента.
+ * @param value Значение элемента.
+ * @return Код состояния операции (HT_TABLE_FULL - только если нужно больше 2^30 слотов).
+ */
+HashTableStatus insertItem(HashTable* table, int key, int value) {
+    if (!table) return HT_MEMORY_ERROR;
+
+    // Перестраиваем заранее: если надгробий много, хватает перестроения того же размера
+    if (table->count + table->tombstones + 1 > table->maxLoad * table->size) {
+        long long size = table->count + 1 > table->maxLoad * table->size / 2 ? 2LL * table->size : table->size;
+
+        if (size > (1 << 30)) return HT_TABLE_FULL;
+
+        HashTableStatus status = rehashTable(table, (int)size);
+
+        if (status != HT_SUCCESS) return status;
+    }
+
+    if (table->mode == HT_MODE_CUCKOO) {
+        if (cuckooFind(table, key)) return HT_KEY_EXISTS;
+
+        HashItem item = {key, value};
+        HashTableStatus status = cuckooPlace(table, item);
+
+        if (status == HT_SUCCESS) table->count++;
+
+        return status;
+    }
+
+    if (table->mode == HT_MODE_ROBIN_HOOD) {
+        int stop[2] = {0, 1};
+
+        if (robinFind(table, key, stop) >= 0) return HT_KEY_EXISTS;
+
+        // Вставка продолжается с того места, где остановился поиск
+        HashItem item = {key, value};
+        HashTableStatus status = robinPlace(table, item, stop[0], stop[1]);
+
+        if (status == HT_SUCCESS) table->count++;
+
+        return status;
+    }
+
+    if (table->mode == HT_MODE_BUCKETIZED) {
+        if (bucketLookup(table, key) >= 0) return HT_KEY_EXISTS;
+
+        // Первый свободный слот на пути лежит не дальше корзины, на которой остановился поиск
+        int index = bucketFreeSlot(table, key);
+
+        if (testBit(table->deleted, index)) table->tombstones--;
+
+        table->keys[index] = key;
+        table->values[index] = value;
+        setBit(table->occupied, index);
+        clearBit(table->deleted, index);
+        table->count++;
+
+        return HT_SUCCESS;
+    }
+
+    int target = -1;
+
+    for (int i = 0; i < table->size; i++) {
+        int index = probeIndex(table, key, i);
+
+        if (testBit(table->occupied, index)) {
+            if (table->items[index].key == key) return HT_KEY_EXISTS;
+        } else {
+            // Запоминаем первое надгробие, но ищем дальше: ключ может лежать за ним
+            if (target < 0) target = index;
+
+            if (!testBit(table->deleted, index)) break; // Пустой слот: дальше ключа нет
+        }
+    }
+
+    if (target < 0) return HT_TABLE_FULL; // Недостижимо при maxLoad < 1
+
+    if (testBit(table->deleted, target)) table->tombstones--;
+
+    table->items[target].key = key;
+    table->items[target].value = value;
+    setBit(table->occupied, target);
+    clearBit(table->deleted, target);
+    table->count++;
+
+    return HT_SUCCESS;
+}
+
+/**
+ * @brief Поиск элемента в хеш-таблице.
+ * @param table Указатель на таблицу.
+ * @param key Ключ элемента.
+ * @param value Указатель для хранения найденного значения.
+ * @return Код состояния операции.
+ */
+HashTableStatus findItem(HashTable* table, int key, int* value) {
+    if (!table) return HT_MEMORY_ERROR;
+
+    if (table->mode == HT_MODE_CUCKOO) {
+        const HashItem* item = cuckooFind(table, key);
+
+        if (!item) return HT_KEY_NOT_FOUND;
+
+        *value = item->value;
+
+        return HT_SUCCESS;
+    }
+
+    if (table->mode == HT_MODE_ROBIN_HOOD) {
+        int index = robinFind(table, key, NULL);
+
+        if (index < 0) return HT_KEY_NOT_FOUND;
+
+        *value = table->items[index].value;
+
+        return HT_SUCCESS;
+    }
+
+    if (table->mode == HT_MODE_BUCKETIZED) {
+        int index = bucketLookup(table, key);
+
+        if (index < 0) return HT_KEY_NOT_FOUND;
+
+        *value = table->values[index];
+
+        return HT_SUCCESS;
+    }
+
+    for (int i = 0; i < table->size; i++) {
+        int index = probeIndex(table, key, i);
+
+        if (testBit(table->occupied, index)) {
+            if (table->items[index].key == key) {
+                *value = table->items[index].value;
+
+                return HT_SUCCESS;
+            }
+        } else if (!testBit(table->deleted, index)) {
+            break; // Пустой слот обрывает цепочку, надгробие - нет
+        }
+    }
+
+    return HT_KEY_NOT_FOUND;
+}
+
+/**
+ * @brief Удаление элемента из хеш-таблицы.
+ * @details Слот помечается надгробием, а не становится пустым: иначе поиск ключей,
+ * которые при вставке прошли через этот слот, обрывался бы на нём.
+ * @param table Указатель на таблицу.
+ * @param key Ключ элемента.
+ * @return Код состояния операции.
+ */
+HashTableStatus deleteItem(HashTable* table, int key) {
+    if (!table) return HT_MEMORY_ERROR;
+
+    if (table->mode == HT_MODE_CUCKOO) {
+        HashItem* item = cuckooFind(table, key);
+
+        if (!item) return HT_KEY_NOT_FOUND;
+
+        table->count--;
+
+        if (item >= table->stash && item < table->stash + CUCKOO_STASH_SIZE) {
+            *item = table->stash[--table->stashCount];
+            return HT_SUCCESS;
+        }
+
+        int index = (int)(item - table->items);
+        int bucket = index / CUCKOO_WAYS;
+
+        item->key = cuckooFiller(table, bucket);
+        clearBit(table->occupied, index);
+
+        // Освободившийся слот может принять элемент из запаса
+        for (int i = 0; i < table->stashCount; i++) {
+            int buckets[2];
+
+            cuckooBuckets(table, table->stash[i].key, buckets);
+
+            if (buckets[0] == bucket || buckets[1] == bucket) {
+                *item = table->stash[i];
+                setBit(table->occupied, index);
+                table->stash[i] = table->stash[--table->stashCount];
+                break;
+            }
+        }
+
+        return HT_SUCCESS;
+    }
+
+    if (table->mode == HT_MODE_ROBIN_HOOD) {
+        int index = robinFind(table, key, NULL);
+
+        if (index < 0) return HT_KEY_NOT_FOUND;
+
+        // Сдвиг назад: элементы за удалённым, стоящие не в своём начальном слоте,
+        // перемещаются на шаг ближе к нему, и цепочка остаётся без дыр
+        int next = (index + 1) & (table->size - 1);
+
+        while (table->distances[next] > 1) {
+            table->items[index] = table->items[next];
+            table->distances[index] = table->distances[next] - 1;
+            index = next;
+            next = (next + 1) & (table->size - 1);
+        }
+
+        table->distances[index] = 0;
+        clearBit(table->occupied, index);
+        table->count--;
+
+        return HT_SUCCESS;
+    }
+
+    if (table->mode == HT_MODE_BUCKETIZED) {
+        int index = bucketLookup(table, key);
+
+        if (index < 0) return HT_KEY_NOT_FOUND;
+
+        int bucket = index / BUCKET_SLOTS;
+
+        // В корзине с пустым слотом поиск и так останавливается - надгробие не нужно
+        if ((~(bucketByte(table->occupied, bucket) | bucketByte(table->deleted, bucket)) & 0xFF) == 0) {
+            setBit(table->deleted, index);
+            table->tombstones++;
+        }
+
+        clearBit(table->occupied, index);
+        table->count--;
+
+        return HT_SUCCESS;
+    }
+
+    for (int i = 0; i < table->size; i++) {
+        int index = probeIndex(table, key, i);
+
+        if (testBit(table->occupied, index)) {
+            if (table->items[index].key == key) {
+                clearBit(table->occupied, index);
+                setBit(table->deleted, index);
+                table->count--;
+                table->tombstones++;
+
+                return HT_SUCCESS;
+            }
+        } else if (!testBit(table->deleted, index)) {
+            break;
+        }
+    }
+
+    return HT_KEY_NOT_FOUND;
+}
+
+/**
+ * @brief Количество проб, за которое находится ключ (или выясняется, что его нет).
+ * @param table Указатель на таблицу.
+ * @param key Ключ.
+ * @return Количество просмотренных слотов (в режимах корзин и кукушки - корзин, запас - ещё одна).
+ */
+int probeLength(const HashTable* table, int key) {
+    if (table->mode == HT_MODE_CUCKOO) {
+        int buckets[2];
+
+        cuckooBuckets(table, key, buckets);
+
+        for (int b = 0; b < 2; b++)
+            for (int i = 0; i < CUCKOO_WAYS; i++)
+                if (table->items[buckets[b] * CUCKOO_WAYS + i].key == key) return b + 1;
+
+        return table->stashCount > 0 ? 3 : 2;
+    }
+
+    if (table->mode == HT_MODE_ROBIN_HOOD) {
+        int index = primaryHash(table, key);
+        int distance = 1;
+
+        // Последний просмотренный слот - найденный ключ или слот, оборвавший поиск
+        while (distance <= table->distances[index] && table->items[index].key != key) {
+            index = (index + 1) & (table->size - 1);
+            distance++;
+        }
+
+        return distance;
+    }
+
+    if (table->mode == HT_MODE_BUCKETIZED) {
+        int buckets = table->size / BUCKET_SLOTS;
+        int bucket = primaryHash(table, key) / BUCKET_SLOTS;
+
+        for (int step = 1; step <= buckets; step++) {
+            int match = bucketMatchScalar(table->keys + bucket * BUCKET_SLOTS, key);
+            int occupied = bucketByte(table->occupied, bucket);
+
+            if ((match & occupied) || (~(occupied | bucketByte(table->deleted, bucket)) & 0xFF)) return step;
+
+            bucket = (bucket + step) & (buckets - 1);
+        }
+
+        return buckets;
+    }
+    for (int i = 0; i < table->size; i++) {
+        int index = probeIndex(table, key, i);
+
+        if (testBit(table->occupied, index) ? table->items[index].key == key : !testBit(table->deleted, index))
+            return i + 1;
+    }
+
+    return table->size;
+}
+
+/**
+ * @brief Вывод хеш-таблицы в консоль.
+ * @param table Указатель на таблицу.
+ */
+void printTable(const HashTable* table) {
+    if (!table) {
+        printf("Хеш-таблица не инициализирована.\n");
+        return;
+    }
+
+    printf("\n------------------ Хеш-таблица ------------------\n");
+    printf("|  Индекс  |       Ключ       |     Значение    |\n");
+    printf("|----------|------------------|-----------------|\n");
+
+    for (int i = 0; i < table->size; i++) {
+        if (testBit(table->occupied, i) && table->mode == HT_MODE_BUCKETIZED) {
+            printf("| %8d | %15d | %13d  |\n", i, table->keys[i], table->values[i]);
+        } else if (testBit(table->occupied, i)) {
+            printf("| %8d | %15d | %13d  |\n", i, table->items[i].key, table->items[i].value);
+        } else {
+            printf("| %8d |       ---       |      Пусто     |\n", i);
+        }
+    }
+
+    printf("------------------------------------------------\n\n");
+}
+
+/**
+ * @brief Тест функции вставки.
+ */
+void testInsertItem() {
+    HashTable* table = createTable(TABLE_SIZE);
+    assert(table != NULL);
+
+    printf("Тест вставки:\n");
+
+    assert(insertItem(table, 1, 100) == HT_SUCCESS);
+    assert(insertItem(table, 2, 200) == HT_SUCCESS);
+
+    assert(insertItem(table, 1, 300) == HT_KEY_EXISTS);
+
+    for (int i = 0; i < TABLE_SIZE; i++) 
+        insertItem(table, i + 3, i * 10);
+    
+    // Таблица растёт сама, поэтому вставка в "заполненную" таблицу проходит
+    assert(insertItem(table, 999, 500) == HT_SUCCESS);
+    assert(table->count == TABLE_SIZE + 3);
+    assert(table->count <= table->maxLoad * table->size);
+
+    printTable(table);
+
+    freeTable(table);
+
+    printf("Тест вставки пройден.\n\n");
+}
+
+/**
+ * @brief Тест функции поиска.
+ */
+void testFindItem() {
+    HashTable* table = createTable(TABLE_SIZE);
+    assert(table != NULL);
+
+    int value;
+    printf("Тест поиска:\n");
+
+    insertItem(table, 1, 100);
+    assert(findItem(table, 1, &value) == HT_SUCCESS);
+    assert(value == 100);
+
+    assert(findItem(table, 99, &value) == HT_KEY_NOT_FOUND);
+
+    insertItem(table, TABLE_SIZE + 1, 200);
+    assert(findItem(table, TABLE_SIZE + 1, &value) == HT_SUCCESS);
+    assert(value == 200);
+
+    printTable(table);
+
+    freeTable(table);
+
+    printf("Тест поиска пройден.\n\n");
+}
+
+/**
+ * @brief Тест функции удаления.
+ */
+void testDeleteItem() {
+    HashTable* table = createTable(TABLE_SIZE);
+    assert(table != NULL);
+
+    printf("Тест удаления:\n");
+
+    insertItem(table, 1, 100);
+    assert(deleteItem(table, 1) == HT_SUCCESS);
+
+    assert(deleteItem(table, 2) == HT_KEY_NOT_FOUND);
+    assert(deleteItem(table, 1) == HT_KEY_NOT_FOUND);
+
+    printTable(table);
+
+    freeTable(table);
+
+    printf("Тест удаления пройден.\n\n");
+}
+
+/**
+ * @brief Тест: удаление не обрывает цепочки проб других ключей.
+ */
+void testDeleteKeepsProbeChain() {
+    HashTable* table = createTable(TABLE_SIZE);
+    assert(table != NULL);
+
+    int value;
+    printf("Тест удаления внутри цепочки проб:\n");
+
+    // Подбираем четыре ключа с одним начальным слотом
+    int keys[4] = {1};
+    int home = primaryHash(table, 1);
+
+    for (int found = 1, key = 2; found < 4; key++)
+        if (primaryHash(table, key) == home) keys[found++] = key;
+
+    assert(insertItem(table, keys[0], 10) == HT_SUCCESS);
+    assert(insertItem(table, keys[1], 20) == HT_SUCCESS);
+    assert(insertItem(table, keys[2], 30) == HT_SUCCESS);
+
+    assert(deleteItem(table, keys[0]) == HT_SUCCESS);
+    assert(findItem(table, keys[1], &value) == HT_SUCCESS && value == 20);
+    assert(findItem(table, keys[2], &value) == HT_SUCCESS && value == 30);
+
+    // Ключ за надгробием не должен вставиться второй раз
+    assert(insertItem(table, keys[2], 40) == HT_KEY_EXISTS);
+
+    // Надгробие переиспользуется
+    assert(insertItem(table, keys[3], 50) == HT_SUCCESS);
+    assert(testBit(table->occupied, home) && table->items[home].key == keys[3]);
+    assert(table->count == 3 && table->tombstones == 0);
+
+    // Отрицательные ключи
+    assert(insertItem(table, -5, 60) == HT_SUCCESS);
+    assert(findItem(table, -5, &value) == HT_SUCCESS && value == 60);
+    assert(deleteItem(table, -5) == HT_SUCCESS);
+    assert(findItem(table, -5, &value) == HT_KEY_NOT_FOUND);
+
+    freeTable(table);
+
+    printf("Тест удаления внутри цепочки проб пройден.\n\n");
+}
+
+/**
+ * @brief Тест роста таблицы и перестроения после удалений.
+ */
+void testGrowth() {
+    HashTable* table = createTable(TABLE_SIZE);
+    assert(table != NULL);
+
+    int value;
+    printf("Тест роста таблицы:\n");
+
+    // Ключи с общим остатком по модулю размера не должны скапливаться
+    for (int i = 0; i < 100000; i++) assert(insertItem(table, i * 1024, i) == HT_SUCCESS);
+    for (int i = 0; i < 100000; i++) assert(findItem(table, i * 1024, &value) == HT_SUCCESS && value == i);
+
+    assert(table->size == 1 << 18);
+    assert(table->count <= table->maxLoad * table->size);
+
+    int longest = 0;
+    for (int i = 0; i < 100000; i++) {
+        int length = probeLength(table, i * 1024);
+        if (length > longest) longest = length;
+    }
+    assert(longest < 64);
+
+    // Удаления и вставки по кругу: надгробия не копятся, размер не растёт
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < 100000; i++) assert(deleteItem(table, i * 1024 + round) == HT_SUCCESS);
+        for (int i = 0; i < 100000; i++) assert(insertItem(table, i * 1024 + round + 1, i) == HT_SUCCESS);
+    }
+    assert(table->size == 1 << 18);
+    assert(table->count + table->tombstones <= table->maxLoad * table->size);
+    assert(findItem(table, 1024 + 10, &value) == HT_SUCCESS && value == 1);
+
+    freeTable(table);
+
+    printf("Тест роста таблицы пройден.\n\n");
+}
+
+/**
+ * @brief Тест режима корзин: обе реализации сравнения дают одинаковый результат.
+ */
+void testBucketized() {
+    int saved = bucketAvx2;
+    int value;
+
+    printf("Тест режима корзин:\n");
+
+    for (int avx2 = 0; avx2 < 2; avx2++) {
+#ifdef HT_X86
+        if (avx2 && !__builtin_cpu_supports("avx2")) continue;
+#else
+        if (avx2) continue;
+#endif
+        bucketAvx2 = avx2;
+
+        HashTable* table = createTableWithMode(TABLE_SIZE, HT_MODE_BUCKETIZED);
+        assert(table != NULL);
+
+        // Свободные слоты заполнены нулями, но ключ 0 в них не находится
+        assert(findItem(table, 0, &value) == HT_KEY_NOT_FOUND);
+        assert(insertItem(table, 0, 7) == HT_SUCCESS);
+        assert(insertItem(table, 0, 8) == HT_KEY_EXISTS);
+        assert(findItem(table, 0, &value) == HT_SUCCESS && value == 7);
+        assert(deleteItem(table, 0) == HT_SUCCESS);
+        assert(findItem(table, 0, &value) == HT_KEY_NOT_FOUND);
+
+        for (int i = 0; i < 100000; i++) assert(insertItem(table, (i - 50000) * 1024, i) == HT_SUCCESS);
+        for (int i = 0; i < 100000; i++) {
+            assert(findItem(table, (i - 50000) * 1024, &value) == HT_SUCCESS && value == i);
+            assert(findItem(table, (i - 50000) * 1024 + 1, &value) == HT_KEY_NOT_FOUND);
+        }
+        assert(table->count == 100000 && table->count <= table->maxLoad * table->size);
+
+        int longest = 0;
+        for (int i = 0; i < 100000; i++) {
+            int length = probeLength(table, (i - 50000) * 1024);
+            if (length > longest) longest = length;
+        }
+        assert(longest < 8);
+
+        // Удаление половины ключей не обрывает путь к оставшимся
+        for (int i = 0; i < 100000; i += 2) assert(deleteItem(table, (i - 50000) * 1024) == HT_SUCCESS);
+        for (int i = 0; i < 100000; i++) {
+            HashTableStatus expected = i % 2 ? HT_SUCCESS : HT_KEY_NOT_FOUND;
+            assert(findItem(table, (i - 50000) * 1024, &value) == expected);
+        }
+        assert(deleteItem(table, -50000 * 1024) == HT_KEY_NOT_FOUND);
+
+        // Удаления и вставки по кругу: надгробия вычищаются перестроением, размер не растёт
+        int size = table->size;
+        for (int round = 0; round < 20; round++) {
+            int offset = round + 1;
+
+            for (int i = 0; i < 100000; i += 2) assert(insertItem(table, (i - 50000) * 1024 + offset, i) == HT_SUCCESS);
+            for (int i = 0; i < 100000; i += 2) assert(deleteItem(table, (i - 50000) * 1024 + offset) == HT_SUCCESS);
+        }
+        assert(table->size == size && table->count == 50000);
+        assert(table->count + table->tombstones <= table->maxLoad * table->size);
+        assert(findItem(table, -49999 * 1024, &value) == HT_SUCCESS && value == 1);
+
+        freeTable(table);
+    }
+
+    bucketAvx2 = saved;
+
+    printf("Тест режима корзин пройден.\n\n");
+}
+
+/**
+ * @brief Проверка инвариантов режима Robin Hood: расстояния верны, надгробий нет.
+ */
+static int robinValid(const HashTable* table) {
+    int count = 0;
+
+    for (int i = 0; i < table->size; i++) {
+        int distance = table->distances[i];
+
+        if (testBit(table->deleted, i) || (distance > 0) != testBit(table->occupied, i)) return 0;
+        if (distance == 0) continue;
+        if (((i - primaryHash(table, table->items[i].key)) & (table->size - 1)) != distance - 1) return 0;
+
+        count++;
+    }
+
+    return count == table->count && table->tombstones == 0;
+}
+
+/**
+ * @brief Тест режима Robin Hood: вставка с перестановками и удаление сдвигом.
+ */
+void testRobinHood() {
+    HashTable* table = createTableWithMode(TABLE_SIZE, HT_MODE_ROBIN_HOOD);
+    assert(table != NULL);
+
+    int value;
+    printf("Тест режима Robin Hood:\n");
+
+    setMaxLoad(table, 0.95);
+
+    assert(insertItem(table, 5, 50) == HT_SUCCESS);
+    assert(insertItem(table, 5, 60) == HT_KEY_EXISTS);
+    assert(deleteItem(table, 5) == HT_SUCCESS);
+    assert(deleteItem(table, 5) == HT_KEY_NOT_FOUND);
+
+    for (int i = 0; i < 100000; i++) assert(insertItem(table, (i - 50000) * 1024, i) == HT_SUCCESS);
+    for (int i = 0; i < 100000; i++) {
+        assert(findItem(table, (i - 50000) * 1024, &value) == HT_SUCCESS && value == i);
+        assert(findItem(table, (i - 50000) * 1024 + 1, &value) == HT_KEY_NOT_FOUND);
+    }
+    assert(table->size == 1 << 17);
+    assert(robinValid(table));
+
+    // После удаления половины ключей цепочки сдвинуты, надгробий нет
+    for (int i = 0; i < 100000; i += 2) assert(deleteItem(table, (i - 50000) * 1024) == HT_SUCCESS);
+    for (int i = 0; i < 100000; i++) {
+        HashTableStatus expected = i % 2 ? HT_SUCCESS : HT_KEY_NOT_FOUND;
+        assert(findItem(table, (i - 50000) * 1024, &value) == expected);
+    }
+    assert(robinValid(table));
+
+    for (int round = 0; round < 10; round++) {
+        int offset = round + 1;
+
+        for (int i = 0; i < 100000; i += 2) assert(insertItem(table, (i - 50000) * 1024 + offset, i) == HT_SUCCESS);
+        for (int i = 0; i < 100000; i += 2) assert(deleteItem(table, (i - 50000) * 1024 + offset) == HT_SUCCESS);
+    }
+    assert(table->size == 1 << 17 && table->count == 50000);
+    assert(robinValid(table));
+
+    freeTable(table);
+
+    // 300 ключей с одним начальным слотом не помещаются в байт расстояния - таблица растёт
+    table = createTableWithMode(1024, HT_MODE_ROBIN_HOOD);
+    assert(table != NULL);
+    setMaxLoad(table, 0.99);
+
+    int keys[300] = {0};
+    int home = primaryHash(table, 0);
+
+    for (int found = 1, key = 1; found < 300; key++)
+        if (primaryHash(table, key) == home) keys[found++] = key;
+
+    for (int i = 0; i < 300; i++) assert(insertItem(table, keys[i], i) == HT_SUCCESS);
+    for (int i = 0; i < 300; i++) assert(findItem(table, keys[i], &value) == HT_SUCCESS && value == i);
+    assert(table->size > 1024 && table->count == 300);
+    assert(robinValid(table));
+
+    freeTable(table);
+
+    // Ключ с соседним началом вытесняет цепочку длиной 255; при нехватке памяти таблица не меняется
+    table = createTableWithMode(1024, HT_MODE_ROBIN_HOOD);
+    assert(table != NULL);
+    setMaxLoad(table, 0.99);
+
+    int previous = (home - 1) & (table->size - 1);
+    int before = -1;
+
+    for (int key = 1; before < 0; key++)
+        if (primaryHash(table, key) == previous) before = key;
+
+    for (int i = 0; i < 255; i++) assert(insertItem(table, keys[i], i) == HT_SUCCESS);
+    assert(insertItem(table, before, -1) == HT_SUCCESS);
+
+    int newcomer = before + 1;
+
+    while (primaryHash(table, newcomer) != previous) newcomer++;
+
+    failAllocations = 1;
+    assert(insertItem(table, newcomer, -2) == HT_MEMORY_ERROR);
+    assert(failAllocations == 0);
+    assert(table->size == 1024 && table->count == 256);
+    for (int i = 0; i < 255; i++) assert(findItem(table, keys[i], &value) == HT_SUCCESS && value == i);
+    assert(findItem(table, before, &value) == HT_SUCCESS && value == -1);
+    assert(findItem(table, newcomer, &value) == HT_KEY_NOT_FOUND);
+    assert(robinValid(table));
+
+    // Когда память есть, тот же ключ вставляется через удвоение таблицы
+    assert(insertItem(table, newcomer, -2) == HT_SUCCESS);
+    assert(table->size > 1024 && table->count == 257);
+    assert(findItem(table, newcomer, &value) == HT_SUCCESS && value == -2);
+    assert(robinValid(table));
+
+    freeTable(table);
+
+    printf("Тест режима Robin Hood пройден.\n\n");
+}
+
+/**
+ * @brief Проверка инвариантов режима кукушки: ключи в своих корзинах, в пустых слотах - заполнители.
+ */
+static int cuckooValid(const HashTable* table) {
+    int count = table->stashCount;
+
+    for (int i = 0; i < table->size; i++) {
+        int bucket = i / CUCKOO_WAYS;
+        int buckets[2];
+
+        if (!testBit(table->occupied, i)) {
+            if (table->items[i].key != cuckooFiller(table, bucket)) return 0;
+            continue;
+        }
+
+        cuckooBuckets(table, table->items[i].key, buckets);
+        if (buckets[0] != bucket && buckets[1] != bucket) return 0;
+
+        count++;
+    }
+
+    return count == table->count;
+}
+
+/**
+ * @brief Тест режима кукушки: переезды, запас и перестроение при его переполнении.
+ */
+void testCuckoo() {
+    HashTable* table = createTableWithMode(TABLE_SIZE, HT_MODE_CUCKOO);
+    assert(table != NULL);
+
+    int value;
+    printf("Тест режима кукушки:\n");
+
+    setMaxLoad(table, 0.95);
+
+    // Ключи-заполнители пустых слотов находятся, только если их вставили
+    int filler = table->fillers[0];
+    assert(findItem(table, filler, &value) == HT_KEY_NOT_FOUND);
+    assert(findItem(table, table->fillers[1], &value) == HT_KEY_NOT_FOUND);
+    assert(insertItem(table, filler, 1) == HT_SUCCESS);
+    assert(insertItem(table, filler, 2) == HT_KEY_EXISTS);
+    assert(findItem(table, filler, &value) == HT_SUCCESS && value == 1);
+    assert(deleteItem(table, filler) == HT_SUCCESS);
+    assert(findItem(table, filler, &value) == HT_KEY_NOT_FOUND);
+
+    for (int i = 0; i < 100000; i++) assert(insertItem(table, (i - 50000) * 1024, i) == HT_SUCCESS);
+    for (int i = 0; i < 100000; i++) {
+        assert(findItem(table, (i - 50000) * 1024, &value) == HT_SUCCESS && value == i);
+        assert(findItem(table, (i - 50000) * 1024 + 1, &value) == HT_KEY_NOT_FOUND);
+        assert(probeLength(table, (i - 50000) * 1024) <= 3);
+    }
+    assert(table->size == 1 << 17);
+    assert(cuckooValid(table));
+
+    for (int i = 0; i < 100000; i += 2) assert(deleteItem(table, (i - 50000) * 1024) == HT_SUCCESS);
+    for (int i = 0; i < 100000; i++) {
+        HashTableStatus expected = i % 2 ? HT_SUCCESS : HT_KEY_NOT_FOUND;
+        assert(findItem(table, (i - 50000) * 1024, &value) == expected);
+    }
+
+    for (int round = 0; round < 10; round++) {
+        int offset = round + 1;
+
+        for (int i = 0; i < 100000; i += 2) assert(insertItem(table, (i - 50000) * 1024 + offset, i) == HT_SUCCESS);
+        for (int i = 0; i < 100000; i += 2) assert(deleteItem(table, (i - 50000) * 1024 + offset) == HT_SUCCESS);
+    }
+    assert(table->size == 1 << 17 && table->count == 50000);
+    assert(cuckooValid(table));
+
+    freeTable(table);
+
+    // 17 ключей, у которых обе корзины - 0 или 1: 8 занимают корзины, 8 - запас,
+    // семнадцатый вызывает перестроение с удвоением
+    table = createTableWithMode(64, HT_MODE_CUCKOO);
+    assert(table != NULL);
+    setMaxLoad(table, 0.99);
+
+    int keys[17];
+
+    for (int found = 0, key = 0; found < 17; key++) {
+        int buckets[2];
+
+        cuckooBuckets(table, key, buckets);
+        if (buckets[0] < 2 && buckets[1] < 2) keys[found++] = key;
+    }
+
+    for (int i = 0; i < 16; i++) assert(insertItem(table, keys[i], i) == HT_SUCCESS);
+    assert(table->size == 64 && table->stashCount == 8);
+    assert(cuckooValid(table));
+
+    // Удаление из корзины возвращает в неё элемент из запаса
+    assert(deleteItem(table, keys[0]) == HT_SUCCESS);
+    assert(table->stashCount == 7 && cuckooValid(table));
+    assert(insertItem(table, keys[0], 0) == HT_SUCCESS && table->stashCount == 8);
+
+    assert(insertItem(table, keys[16], 16) == HT_SUCCESS);
+    assert(table->size == 128 && table->count == 17);
+    for (int i = 0; i < 17; i++) assert(findItem(table, keys[i], &value) == HT_SUCCESS && value == i);
+    assert(cuckooValid(table));
+
+    freeTable(table);
+
+    printf("Тест режима кукушки пройден.\n\n");
+}
+
+/**
+ * @brief Текущее время в секундах для бенчмарков.
+ */
+static double benchNow() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Генератор псевдослучайных чисел xorshift64 для бенчмарков.
+ */
+static uint64_t benchRandom(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+
+    return *state;
+}
+
+/**
+ * @brief Прежняя разметка таблицы для сравнения: массив указателей на отдельные элементы.
+ */
+typedef struct {
+    HashItem** items;  ///< Массив указателей на элементы.
+    HashTable shape;   ///< Размер для probeIndex.
+} BenchPointerTable;
+
+/**
+ * @brief Вставка в прежнюю разметку (как insertItem до перехода на слоты).
+ */
+static void benchPointerInsert(BenchPointerTable* table, int key, int value) {
+    for (int i = 0; i < table->shape.size; i++) {
+        int index = probeIndex(&table->shape, key, i);
+
+        if (!table->items[index]) {
+            table->items[index] = (HashItem*)malloc(sizeof(HashItem));
+            table->items[index]->key = key;
+            table->items[index]->value = value;
+            return;
+        }
+
+        if (table->items[index]->key == key) return;
+    }
+}
+
+/**
+ * @brief Поиск в прежней разметке; цепочка обрывается на пустом слоте, как и в новой.
+ */
+static int benchPointerFind(const BenchPointerTable* table, int key, int* value) {
+    for (int i = 0; i < table->shape.size; i++) {
+        int index = probeIndex(&table->shape, key, i);
+
+        if (!table->items[index]) return 0;
+
+        if (table->items[index]->key == key) {
+            *value = table->items[index]->value;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Слоты подряд против массива указателей при загрузке 0.5, 0.75 и 0.9.
+ * @details ./asd_lab_8 --bench load [размер], по умолчанию 4M слотов (размер округляется
+ * до степени двойки). Присутствующие ключи чётные, отсутствующие - нечётные.
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void benchLoad(int argc, char** argv) {
+    HashTable* shape = createTable(argc > 0 ? atoi(argv[0]) : 4000000);
+    double loads[] = {0.5, 0.75, 0.9};
+
+    if (!shape) return;
+
+    int size = shape->size;
+    int* keys = (int*)malloc(size * sizeof(int));
+    uint64_t state = 88172645463325252ULL;
+    long long checksum = 0;
+    int value;
+
+    if (!keys) {
+        freeTable(shape);
+        return;
+    }
+
+    for (int i = 0; i < size; i++) keys[i] = (int)(benchRandom(&state) & 0x7FFFFFFE);
+
+    printf("size %d, ns/op\n", size);
+
+    for (int l = 0; l < 3; l++) {
+        int n = (int)(size * loads[l]);
+
+        for (int layout = 0; layout < 2; layout++) {
+            HashTable* table = layout ? createTable(size) : NULL;
+            BenchPointerTable pointers = {layout ? NULL : (HashItem**)calloc(size, sizeof(HashItem*)), *shape};
+
+            // Загрузка 0.9 выше порога по умолчанию; без этого таблица выросла бы вдвое
+            if (layout) setMaxLoad(table, 0.95);
+
+            double start = benchNow();
+            for (int i = 0; i < n; i++) {
+                if (layout) insertItem(table, keys[i], i);
+                else benchPointerInsert(&pointers, keys[i], i);
+            }
+            double insertTime = benchNow() - start;
+
+            start = benchNow();
+            for (int i = 0; i < n; i++) {
+                int key = keys[(int)(((long long)i * 7919) % n)];
+
+                if (layout ? findItem(table, key, &value) == HT_SUCCESS : benchPointerFind(&pointers, key, &value))
+                    checksum += value;
+            }
+            double hitTime = benchNow() - start;
+
+            start = benchNow();
+            for (int i = 0; i < n; i++) {
+                int key = keys[i] | 1;
+
+                if (layout ? findItem(table, key, &value) == HT_SUCCESS : benchPointerFind(&pointers, key, &value))
+                    checksum += value;
+            }
+            double missTime = benchNow() - start;
+
+            printf("load %.2f  %-8s insert %6.1f  find(hit) %6.1f  find(miss) %6.1f\n", loads[l],
+                   layout ? "inline" : "pointers", insertTime * 1e9 / n, hitTime * 1e9 / n, missTime * 1e9 / n);
+
+            if (layout) {
+                freeTable(table);
+            } else {
+                for (int i = 0; i < size; i++) free(pointers.items[i]);
+                free(pointers.items);
+            }
+        }
+    }
+
+    printf("[%lld]\n", checksum);
+    free(keys);
+    freeTable(shape);
+}
+
+/**
+ * @brief Рост таблицы от пустой до 10M ключей: время операций и длина цепочек проб.
+ * @details ./asd_lab_8 --bench scale [наибольшее количество], например 100000000.
+ * Ключи не хранятся, а повторно порождаются тем же генератором, поэтому память
+ * занимает только сама таблица.
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void benchScale(int argc, char** argv) {
+    long long limit = argc > 0 ? atoll(argv[0]) : 10000000;
+    long long checksum = 0;
+    int value;
+
+    printf("%10s %10s %6s %8s %8s %8s %6s %5s\n", "keys", "size", "load", "insert", "hit", "miss", "probe",
+           "max");
+
+    for (long long n = 1000; n <= limit && n <= (1 << 30); n *= 10) {
+        HashTable* table = createTable(0);
+        uint64_t state = 88172645463325252ULL;
+
+        if (!table) return;
+
+        double start = benchNow();
+        for (long long i = 0; i < n; i++) insertItem(table, (int)(benchRandom(&state) & 0x7FFFFFFE), (int)i);
+        double insertTime = benchNow() - start;
+
+        state = 88172645463325252ULL;
+        start = benchNow();
+        for (long long i = 0; i < n; i++)
+            if (findItem(table, (int)(benchRandom(&state) & 0x7FFFFFFE), &value) == HT_SUCCESS) checksum += value;
+        double hitTime = benchNow() - start;
+
+        state = 88172645463325252ULL;
+        start = benchNow();
+        for (long long i = 0; i < n; i++) {
+            int key = (int)((benchRandom(&state) | 1) & 0x7FFFFFFF);
+
+            if (findItem(table, key, &value) == HT_SUCCESS) checksum += value;
+        }
+        double missTime = benchNow() - start;
+
+        long long totalProbes = 0;
+        int longest = 0;
+
+        state = 88172645463325252ULL;
+        for (long long i = 0; i < n; i++) {
+            int length = probeLength(table, (int)(benchRandom(&state) & 0x7FFFFFFE));
+
+            totalProbes += length;
+            if (length > longest) longest = length;
+        }
+
+        printf("%10lld %10d %6.3f %8.1f %8.1f %8.1f %6.2f %5d\n", n, table->size, (double)table->count / table->size,
+               insertTime * 1e9 / n, hitTime * 1e9 / n, missTime * 1e9 / n, (double)totalProbes / n, longest);
+
+        freeTable(table);
+    }
+
+    printf("[%lld]\n", checksum);
+}
+
+/**
+ * @brief Режим корзин (AVX2 и запасной путь) против двойного хеширования.
+ * @details ./asd_lab_8 --bench simd [размер], по умолчанию 4M слотов, загрузка 0.5, 0.75 и 0.9.
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void benchSimd(int argc, char** argv) {
+    const char* names[] = {"double", "scalar", "avx2"};
+    double loads[] = {0.5, 0.75, 0.9};
+    HashTable* shape = createTable(argc > 0 ? atoi(argv[0]) : 4000000);
+    int saved = bucketAvx2;
+    long long checksum = 0;
+    int value;
+
+    if (!shape) return;
+
+    int size = shape->size;
+    int* keys = (int*)malloc(size * sizeof(int));
+    uint64_t state = 88172645463325252ULL;
+
+    freeTable(shape);
+
+    if (!keys) return;
+
+    for (int i = 0; i < size; i++) keys[i] = (int)(benchRandom(&state) & 0x7FFFFFFE);
+
+    printf("size %d, ns/op\n", size);
+
+    for (int l = 0; l < 3; l++) {
+        int n = (int)(size * loads[l]);
+
+        for (int variant = 0; variant < 3; variant++) {
+#ifdef HT_X86
+            if (variant == 2 && !__builtin_cpu_supports("avx2")) continue;
+#else
+            if (variant == 2) continue;
+#endif
+            bucketAvx2 = variant == 2;
+
+            HashTable* table = createTableWithMode(size, variant ? HT_MODE_BUCKETIZED : HT_MODE_DOUBLE_HASHING);
+
+            if (!table) break;
+
+            setMaxLoad(table, 0.95);
+
+            double start = benchNow();
+            for (int i = 0; i < n; i++) insertItem(table, keys[i], i);
+            double insertTime = benchNow() - start;
+
+            start = benchNow();
+            for (int i = 0; i < n; i++)
+                if (findItem(table, keys[(int)(((long long)i * 7919) % n)], &value) == HT_SUCCESS) checksum += value;
+            double hitTime = benchNow() - start;
+
+            start = benchNow();
+            for (int i = 0; i < n; i++)
+                if (findItem(table, keys[i] | 1, &value) == HT_SUCCESS) checksum += value;
+            double missTime = benchNow() - start;
+
+            printf("load %.2f  %-7s insert %6.1f  find(hit) %6.1f  find(miss) %6.1f\n", loads[l], names[variant],
+                   insertTime * 1e9 / n, hitTime * 1e9 / n, missTime * 1e9 / n);
+
+            freeTable(table);
+        }
+    }
+
+    bucketAvx2 = saved;
+    printf("[%lld]\n", checksum);
+    free(keys);
+}
+
+/**
+ * @brief Robin Hood против двойного хеширования при загрузке до 0.95.
+ * @details ./asd_lab_8 --bench robin [размер], по умолчанию 4M слотов. Для каждой загрузки
+ * печатает время операций, среднюю и наибольшую длину проб для найденных ключей,
+ * среднюю длину проб для отсутствующих и время промаха после n удалений и вставок
+ * (у двойного хеширования к этому моменту накапливаются надгробия).
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void benchRobin(int argc, char** argv) {
+    const char* names[] = {"double", "robin"};
+    double loads[] = {0.5, 0.75, 0.9, 0.95};
+    HashTable* shape = createTable(argc > 0 ? atoi(argv[0]) : 4000000);
+    long long checksum = 0;
+    int value;
+
+    if (!shape) return;
+
+    int size = shape->size;
+    int* keys = (int*)malloc(2 * (size_t)size * sizeof(int));
+
+    freeTable(shape);
+
+    if (!keys) return;
+
+    // Различные чётные ключи: умножение на нечётное число - перестановка по модулю 2^30
+    for (int i = 0; i < 2 * size; i++) keys[i] = (int)(((uint32_t)i * 2654435761u & 0x3FFFFFFF) << 1);
+
+    printf("size %d, ns/op; probe: mean/max for hits, mean for misses\n", size);
+
+    for (int l = 0; l < 4; l++) {
+        int n = (int)(size * loads[l]);
+
+        for (int variant = 0; variant < 2; variant++) {
+            HashTable* table = createTableWithMode(size, variant ? HT_MODE_ROBIN_HOOD : HT_MODE_DOUBLE_HASHING);
+
+            if (!table) break;
+
+            setMaxLoad(table, 0.99);
+
+            double start = benchNow();
+            for (int i = 0; i < n; i++) insertItem(table, keys[i], i);
+            double insertTime = benchNow() - start;
+
+            start = benchNow();
+            for (int i = 0; i < n; i++)
+                if (findItem(table, keys[(int)(((long long)i * 7919) % n)], &value) == HT_SUCCESS) checksum += value;
+            double hitTime = benchNow() - start;
+
+            start = benchNow();
+            for (int i = 0; i < n; i++)
+                if (findItem(table, keys[i] | 1, &value) == HT_SUCCESS) checksum += value;
+            double missTime = benchNow() - start;
+
+            long long hitProbes = 0, missProbes = 0;
+            int longest = 0;
+
+            for (int i = 0; i < n; i++) {
+                int length = probeLength(table, keys[i]);
+
+                hitProbes += length;
+                if (length > longest) longest = length;
+                missProbes += probeLength(table, keys[i] | 1);
+            }
+
+            // Удаления и вставки по кругу: ключи [0, n) сменяются ключами [n, 2n) по одному
+            for (int i = 0; i < n; i++) {
+                deleteItem(table, keys[i]);
+                insertItem(table, keys[n + i], i);
+            }
+
+            start = benchNow();
+            for (int i = 0; i < n; i++)
+                if (findItem(table, keys[i] | 1, &value) == HT_SUCCESS) checksum += value;
+            double churnTime = benchNow() - start;
+
+            printf("load %.2f  %-6s insert %6.1f  hit %6.1f  miss %6.1f  probe %5.2f/%3d  %5.2f  "
+                   "miss after churn %6.1f\n",
+                   loads[l], names[variant], insertTime * 1e9 / n, hitTime * 1e9 / n, missTime * 1e9 / n,
+                   (double)hitProbes / n, longest, (double)missProbes / n, churnTime * 1e9 / n);
+
+            freeTable(table);
+        }
+    }
+
+    printf("[%lld]\n", checksum);
+    free(keys);
+}
+
+/**
+ * @brief Сравнение чисел long long для qsort.
+ */
+static int compareLongLong(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Текущее время в наносекундах для замеров отдельных операций.
+ */
+static long long benchNanos() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * @brief Хвосты задержки поиска во всех режимах при загрузке 0.9.
+ * @details ./asd_lab_8 --bench latency [размер], по умолчанию 4M слотов. Каждый поиск
+ * замеряется отдельно (из замера вычтена медиана пустого замера), печатаются p50, p99,
+ * p99.9, p99.99 и максимум в наносекундах для найденных и отсутствующих ключей.
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void benchLatency(int argc, char** argv) {
+    const char* names[] = {"double", "bucket", "robin", "cuckoo"};
+    HashTableMode modes[] = {HT_MODE_DOUBLE_HASHING, HT_MODE_BUCKETIZED, HT_MODE_ROBIN_HOOD, HT_MODE_CUCKOO};
+    double percentiles[] = {0.5, 0.99, 0.999, 0.9999};
+    HashTable* shape = createTable(argc > 0 ? atoi(argv[0]) : 4000000);
+    long long checksum = 0;
+    int value;
+
+    if (!shape) return;
+
+    int size = shape->size;
+    int n = (int)(size * 0.9);
+    int* keys = (int*)malloc(size * sizeof(int));
+    long long* samples = (long long*)malloc(n * sizeof(long long));
+
+    freeTable(shape);
+
+    if (!keys || !samples) {
+        free(keys);
+        free(samples);
+        return;
+    }
+
+    for (int i = 0; i < size; i++) keys[i] = (int)(((uint32_t)i * 2654435761u & 0x3FFFFFFF) << 1);
+
+    // Цена самого замера
+    for (int i = 0; i < n; i++) {
+        long long start = benchNanos();
+        samples[i] = benchNanos() - start;
+    }
+    qsort(samples, n, sizeof(long long), compareLongLong);
+    long long overhead = samples[n / 2];
+
+    printf("size %d, load 0.90, ns (timer overhead %lld ns subtracted)\n", size, overhead);
+    printf("%-7s %-5s %7s %7s %7s %7s %7s\n", "mode", "op", "p50", "p99", "p99.9", "p99.99", "max");
+
+    for (int mode = 0; mode < 4; mode++) {
+        HashTable* table = createTableWithMode(size, modes[mode]);
+
+        if (!table) break;
+
+        setMaxLoad(table, 0.95);
+
+        for (int i = 0; i < n; i++) insertItem(table, keys[i], i);
+
+        for (int miss = 0; miss < 2; miss++) {
+            for (int i = 0; i < n; i++) {
+                int key = miss ? keys[i] | 1 : keys[(int)(((long long)i * 7919) % n)];
+                long long start = benchNanos();
+
+                if (findItem(table, key, &value) == HT_SUCCESS) checksum += value;
+
+                samples[i] = benchNanos() - start - overhead;
+            }
+
+            qsort(samples, n, sizeof(long long), compareLongLong);
+
+            printf("%-7s %-5s", names[mode], miss ? "miss" : "hit");
+            for (int p = 0; p < 4; p++) printf(" %7lld", samples[(int)(percentiles[p] * (n - 1))]);
+            printf(" %7lld\n", samples[n - 1]);
+        }
+
+        freeTable(table);
+    }
+
+    printf("[%lld]\n", checksum);
+    free(keys);
+    free(samples);
+}
+
+/**
+ * @brief Запуск бенчмарка по имени.
+ * @param argc Количество параметров после "--bench".
+ * @param argv Имя бенчмарка и его параметры.
+ * @return 0 в случае успеха, 1 если бенчмарк неизвестен.
+ */
+static int runBenchmarks(int argc, char** argv) {
+    if (argc >= 1 && strcmp(argv[0], "load") == 0) {
+        benchLoad(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "scale") == 0) {
+        benchScale(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "simd") == 0) {
+        benchSimd(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "robin") == 0) {
+        benchRobin(argc - 1, argv + 1);
+        return 0;
+    }
+
+    if (argc >= 1 && strcmp(argv[0], "latency") == 0) {
+        benchLatency(argc - 1, argv + 1);
+        return 0;
+    }
+
+    printf("Доступные бенчмарки: load, scale, simd, robin, latency\n");
+
+    return 1;
+}
+
+/**
+ * @brief Главная функция для выполнения тестов.
+ * @details С параметрами "--bench <имя>" после тестов запускает бенчмарк.
+ */
+int main(int argc, char** argv) {
+
+    testInsertItem();
+    testFindItem();
+    testDeleteItem();
+    testDeleteKeepsProbeChain();
+    testGrowth();
+    testBucketized();
+    testRobinHood();
+    testCuckoo();
+
+    printf("Все тесты пройдены.\n");
+
+    if (argc >= 2 && strcmp(argv[1], "--bench") == 0) return runBenchmarks(argc - 2, argv + 2);
     
     return 0;
 }
@@ -1,18 +1,35 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
 #include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #define MAX_LENGTH 100
-#define TABLE_SIZE 200
+#define TABLE_SIZE 256                ///< Начальное число корзин (степень двойки)
+#define NO_NODE UINT32_MAX            ///< Пустая корзина или конец цепочки
+#define STREAM_BLOCK_SIZE (1 << 20)   ///< Размер блока чтения и буфера записи в потоковом режиме
+#define PARALLEL_CHUNK_SIZE (4 << 20) ///< Размер куска входа в параллельном режиме (до конца строки)
 
 /**
  * @struct Node
  * Структура для хранения пар (ключ-значение) в хэш-таблице.
+ * Слово лежит в общем пуле строк, цепочки связаны индексами в массиве узлов.
  */
 typedef struct Node {
-    char word[MAX_LENGTH];
+    uint32_t hash;   ///< Полный хэш слова: быстрый отказ до сравнения строк и перестройка без пересчёта
+    uint32_t offset; ///< Смещение слова (с завершающим нулём) в пуле
+    uint32_t next;   ///< Индекс следующего узла цепочки или NO_NODE
     int value;
-    struct Node *next;
 } Node;
 
 /**
@@ -20,7 +37,15 @@ typedef struct Node {
  * Структура для хэш-таблицы.
  */
 typedef struct HashTable {
-    Node **table;
+    uint32_t *table;      ///< Индекс первого узла цепочки для каждой корзины
+    size_t bucketCount;   ///< Число корзин, степень двойки
+    int bucketShift;      ///< Индекс корзины - старшие биты хэша: hash >> bucketShift
+    Node *nodes;          ///< Узлы в порядке вставки
+    size_t count;
+    size_t nodeCapacity;
+    char *pool;           ///< Слова подряд, каждое завершается нулём
+    size_t poolLength;
+    size_t poolCapacity;
 } HashTable;
 
 /**
@@ -28,44 +53,193 @@ typedef struct HashTable {
  * @return Указатель на созданную хэш-таблицу.
  */
 HashTable *createHashTable() {
-    HashTable *hashTable = malloc(sizeof(HashTable));
-    hashTable->table = malloc(sizeof(Node *) * TABLE_SIZE);
+    HashTable *hashTable = calloc(1, sizeof(HashTable));
+    hashTable->bucketCount = TABLE_SIZE;
+    hashTable->bucketShift = 32 - __builtin_ctz(TABLE_SIZE);
+    hashTable->table = malloc(sizeof(uint32_t) * TABLE_SIZE);
 
     for (int i = 0; i < TABLE_SIZE; i++) 
-        hashTable->table[i] = NULL;
+        hashTable->table[i] = NO_NODE;
     
 
     return hashTable;
 }
 
+/**
+ * @brief Хэш-функция для слова, заданного указателем и длиной (FNV-1a с перемешиванием).
+ * @param word Начало слова (не обязательно завершается нулём).
+ * @param length Длина слова.
+ * @return Полный 32-битный хэш; индекс корзины - его старшие биты.
+ */
+unsigned int hashN(const char *word, size_t length) {
+    uint32_t hashValue = 2166136261u;
+
+    for (size_t i = 0; i < length; i++)
+        hashValue = (hashValue ^ (unsigned char)word[i]) * 16777619u;
+
+    hashValue ^= hashValue >> 15;
+    hashValue *= 0x2c1b3c6du;
+    hashValue ^= hashValue >> 12;
+
+    return hashValue;
+}
+
 /**
  * @brief Хэш-функция.
  * @param word Строка, для которой нужно вычислить хэш.
- * @return Индекс в хэш-таблице.
+ * @return Полный 32-битный хэш.
  */
 unsigned int hash(const char *word) {
-    unsigned int hashValue = 0;
+    return hashN(word, strlen(word));
+}
 
-    while (*word) 
-        hashValue = (hashValue << 5) + *word++;
-    
+/**
+ * @brief Удваивает число корзин и перецепляет узлы по сохранённым хэшам.
+ * @details Узлы перебираются в порядке вставки, поэтому в каждой цепочке
+ * по-прежнему первым стоит последний вставленный.
+ * @param hashTable Указатель на хэш-таблицу.
+ * @param bucketCount Новое число корзин (степень двойки).
+ * @return 0 в случае успеха, -1 в случае ошибки выделения памяти.
+ */
+static int hashTableResize(HashTable *hashTable, size_t bucketCount) {
+    uint32_t *table = malloc(sizeof(uint32_t) * bucketCount);
+    int bucketShift = 32 - __builtin_ctzll(bucketCount);
+
+    if (!table) return -1;
+
+    for (size_t i = 0; i < bucketCount; i++) table[i] = NO_NODE;
+
+    for (size_t i = 0; i < hashTable->count; i++) {
+        Node *node = &hashTable->nodes[i];
+        size_t index = (uint64_t)node->hash >> bucketShift;
+
+        node->next = table[index];
+        table[index] = (uint32_t)i;
+    }
+
+    free(hashTable->table);
+    hashTable->table = table;
+    hashTable->bucketCount = bucketCount;
+    hashTable->bucketShift = bucketShift;
+
+    return 0;
+}
+
+/**
+ * @brief Выделяет массив узлов и пул под новые слова, не трогая корзины.
+ * @param hashTable Указатель на хэш-таблицу.
+ * @param entries Количество добавляемых слов.
+ * @param poolBytes Суммарная длина добавляемых слов вместе с завершающими нулями.
+ * @return 0 в случае успеха, -1 если не хватило памяти или пул превысил бы 4 ГБ.
+ */
+static int hashTableReserveStorage(HashTable *hashTable, size_t entries, size_t poolBytes) {
+    size_t count = hashTable->count + entries;
+    size_t poolLength = hashTable->poolLength + poolBytes;
+
+    if (count > NO_NODE || poolLength > UINT32_MAX) return -1;
+
+    if (count > hashTable->nodeCapacity) {
+        Node *nodes = realloc(hashTable->nodes, sizeof(Node) * count);
+
+        if (!nodes) return -1;
+
+        hashTable->nodes = nodes;
+        hashTable->nodeCapacity = count;
+    }
+
+    if (poolLength > hashTable->poolCapacity) {
+        char *pool = realloc(hashTable->pool, poolLength);
+
+        if (!pool) return -1;
+
+        hashTable->pool = pool;
+        hashTable->poolCapacity = poolLength;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Увеличивает число корзин до того, которое было бы после вставки по одному слову.
+ * @param hashTable Указатель на хэш-таблицу.
+ * @param count Итоговое количество слов.
+ * @return 0 в случае успеха, -1 в случае ошибки выделения памяти.
+ */
+static int hashTableReserveBuckets(HashTable *hashTable, size_t count) {
+    size_t bucketCount = hashTable->bucketCount;
+
+    while (bucketCount < count) bucketCount *= 2;
+
+    return bucketCount == hashTable->bucketCount ? 0 : hashTableResize(hashTable, bucketCount);
+}
+
+/**
+ * @brief Заранее выделяет память под новые слова, чтобы вставка не перераспределяла её.
+ * @param hashTable Указатель на хэш-таблицу.
+ * @param entries Количество добавляемых слов.
+ * @param poolBytes Суммарная длина добавляемых слов вместе с завершающими нулями.
+ * @return 0 в случае успеха, -1 если не хватило памяти или пул превысил бы 4 ГБ.
+ */
+int hashTableReserve(HashTable *hashTable, size_t entries, size_t poolBytes) {
+    if (hashTableReserveStorage(hashTable, entries, poolBytes) < 0) return -1;
 
-    return hashValue % TABLE_SIZE;
+    return hashTableReserveBuckets(hashTable, hashTable->count + entries);
 }
 
 /**
  * @brief Добавляет пару (ключ-значение) в хэш-таблицу.
+ * @details Слово копируется в пул; корзин становится вдвое больше, когда узлов больше, чем корзин.
  * @param hashTable Указатель на хэш-таблицу.
  * @param word Ключ, который нужно добавить.
  * @param value Значение, соответствующее ключу.
+ * @return 0 в случае успеха, -1 если не хватило памяти или пул превысил 4 ГБ.
  */
-void hashTableInsert(HashTable *hashTable, const char *word, int value) {
-    unsigned int index = hash(word);
-    Node *newNode = malloc(sizeof(Node));
-    strcpy(newNode->word, word);
+int hashTableInsert(HashTable *hashTable, const char *word, int value) {
+    size_t length = strlen(word) + 1;
+
+    if (hashTable->poolLength + length > UINT32_MAX || hashTable->count >= NO_NODE) return -1;
+
+    if (hashTable->poolLength + length > hashTable->poolCapacity) {
+        size_t capacity = hashTable->poolCapacity ? hashTable->poolCapacity * 2 : 4096;
+
+        while (capacity < hashTable->poolLength + length) capacity *= 2;
+
+        if (capacity > (size_t)UINT32_MAX + 1) capacity = (size_t)UINT32_MAX + 1;
+
+        char *pool = realloc(hashTable->pool, capacity);
+
+        if (!pool) return -1;
+
+        hashTable->pool = pool;
+        hashTable->poolCapacity = capacity;
+    }
+
+    if (hashTable->count == hashTable->nodeCapacity) {
+        size_t capacity = hashTable->nodeCapacity ? hashTable->nodeCapacity * 2 : 64;
+        Node *nodes = realloc(hashTable->nodes, sizeof(Node) * capacity);
+
+        if (!nodes) return -1;
+
+        hashTable->nodes = nodes;
+        hashTable->nodeCapacity = capacity;
+    }
+
+    if (hashTable->count >= hashTable->bucketCount && hashTableResize(hashTable, hashTable->bucketCount * 2) < 0)
+        return -1;
+
+    uint32_t hashValue = hash(word);
+    size_t index = (uint64_t)hashValue >> hashTable->bucketShift;
+    Node *newNode = &hashTable->nodes[hashTable->count];
+
+    memcpy(hashTable->pool + hashTable->poolLength, word, length);
+    newNode->hash = hashValue;
+    newNode->offset = (uint32_t)hashTable->poolLength;
     newNode->value = value;
     newNode->next = hashTable->table[index];
-    hashTable->table[index] = newNode;
+    hashTable->table[index] = (uint32_t)hashTable->count++;
+    hashTable->poolLength += length;
+
+    return 0;
 }
 
 /**
@@ -75,35 +249,51 @@ void hashTableInsert(HashTable *hashTable, const char *word, int value) {
  * @return Значение, соответствующее ключу, или -1, если не найдено.
  */
 int hashTableSearch(HashTable *hashTable, const char *word) {
-    unsigned int index = hash(word);
-    Node *node = hashTable->table[index];
+    uint32_t hashValue = hash(word);
+    uint32_t index = hashTable->table[(uint64_t)hashValue >> hashTable->bucketShift];
     
-    while (node) {
-        if (strcmp(node->word, word) == 0) {
+    while (index != NO_NODE) {
+        const Node *node = &hashTable->nodes[index];
+
+        if (node->hash == hashValue && strcmp(hashTable->pool + node->offset, word) == 0) {
             return node->value;
         }
-        node = node->next;
+        index = node->next;
     }
 
     return -1;
 }
 
 /**
- * @brief Освобождает память, занятую хэш-таблицей.
+ * @brief Поиск значения по слову, заданному указателем и длиной, без копирования.
  * @param hashTable Указатель на хэш-таблицу.
+ * @param word Начало слова (например, внутри отображённого файла).
+ * @param length Длина слова.
+ * @return Значение, соответствующее ключу, или -1, если не найдено.
  */
-void freeHashTable(HashTable *hashTable) {
-    for (int i = 0; i < TABLE_SIZE; i++) {
-        Node *node = hashTable->table[i];
+int hashTableSearchN(HashTable *hashTable, const char *word, size_t length) {
+    uint32_t hashValue = hashN(word, length);
 
-        while (node) {
-            Node *temp = node;
-            node = node->next;
-            free(temp);
-        }
+    for (uint32_t index = hashTable->table[(uint64_t)hashValue >> hashTable->bucketShift]; index != NO_NODE;) {
+        const Node *node = &hashTable->nodes[index];
+        const char *key = hashTable->pool + node->offset;
+
+        if (node->hash == hashValue && memcmp(key, word, length) == 0 && key[length] == '\0') return node->value;
+
+        index = node->next;
     }
 
+    return -1;
+}
+
+/**
+ * @brief Освобождает память, занятую хэш-таблицей.
+ * @param hashTable Указатель на хэш-таблицу.
+ */
+void freeHashTable(HashTable *hashTable) {
     free(hashTable->table);
+    free(hashTable->nodes);
+    free(hashTable->pool);
     free(hashTable);
 }
 
@@ -124,7 +314,7 @@ int createNumberDict(const char *filename, HashTable *hashTable) {
     char word[MAX_LENGTH];
     int value;
 
-    while (fscanf(file, "%s %d", word, &value) == 2) 
+    while (fscanf(file, "%99s %d", word, &value) == 2) 
         hashTableInsert(hashTable, word, value);
     
     fclose(file);
@@ -180,14 +370,1760 @@ void processText(HashTable *hashTable, const char *inputFilename, const char *ou
 }
 
 /**
- * @brief Основная функция программы.
- * @return Код завершения.
+ * @struct OutputBuffer
+ * Буфер записи: данные уходят в файл вызовом write большими блоками.
+ * При fd < 0 буфер не сбрасывается, а растёт (результат куска в параллельном режиме).
  */
-int main() {
-    HashTable *hashTable = createHashTable();
+typedef struct OutputBuffer {
+    char *data;
+    size_t length;
+    size_t capacity;
+    int fd;
+    int failed;
+} OutputBuffer;
+
+/**
+ * @brief Сбрасывает накопленные данные в файл.
+ * @param out Указатель на буфер записи.
+ */
+static void outputFlush(OutputBuffer *out) {
+    size_t written = 0;
+
+    while (written < out->length && !out->failed) {
+        ssize_t result = write(out->fd, out->data + written, out->length - written);
+
+        if (result < 0) out->failed = 1;
+        else written += (size_t)result;
+    }
+
+    out->length = 0;
+}
+
+/**
+ * @brief Дописывает байты в буфер записи.
+ * @details Участки длиннее буфера пишутся в файл напрямую, без копирования.
+ * @param out Указатель на буфер записи.
+ * @param bytes Данные.
+ * @param length Количество байт.
+ */
+static void outputWrite(OutputBuffer *out, const char *bytes, size_t length) {
+    if (length == 0) return;
+
+    if (out->length + length > out->capacity && out->fd < 0) {
+        size_t capacity = out->capacity ? out->capacity * 2 : STREAM_BLOCK_SIZE;
+
+        while (capacity < out->length + length) capacity *= 2;
+
+        char *data = realloc(out->data, capacity);
+
+        if (!data) {
+            out->failed = 1;
+            return;
+        }
+
+        out->data = data;
+        out->capacity = capacity;
+    }
+
+    if (out->length + length > out->capacity) {
+        outputFlush(out);
+
+        if (length >= out->capacity) {
+            OutputBuffer direct = {(char *)bytes, length, length, out->fd, out->failed};
+
+            outputFlush(&direct);
+            out->failed = direct.failed;
+            return;
+        }
+    }
+
+    memcpy(out->data + out->length, bytes, length);
+    out->length += length;
+}
+
+/**
+ * @brief Дописывает в буфер записи десятичное число.
+ * @param out Указатель на буфер записи.
+ * @param number Число.
+ */
+static void outputNumber(OutputBuffer *out, long long number) {
+    char digits[24];
+    int position = sizeof(digits);
+    unsigned long long magnitude = number < 0 ? 0ULL - (unsigned long long)number : (unsigned long long)number;
+
+    do {
+        digits[--position] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+
+    if (number < 0) digits[--position] = '-';
+
+    outputWrite(out, digits + position, sizeof(digits) - position);
+}
+
+/**
+ * @brief Проверяет, является ли символ разделителем слов (пробел, табуляция, перевод строки и т.п.).
+ */
+static inline int isDelimiter(char c) {
+    return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+/**
+ * @brief Ищет первый разделитель слов.
+ * @details С SSE2 проверяет по 16 байт за раз: сравнение с пробелом и с диапазоном
+ * '\t'..'\r', затем movemask. Байты за end не читаются.
+ * @param p Начало поиска.
+ * @param end Конец данных.
+ * @return Указатель на разделитель или end.
+ */
+static const char *findDelimiter(const char *p, const char *end) {
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i low = _mm_set1_epi8('\t' - 1);
+    const __m128i high = _mm_set1_epi8('\r' + 1);
+
+    for (; end - p >= 16; p += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)p);
+        __m128i control = _mm_and_si128(_mm_cmpgt_epi8(bytes, low), _mm_cmplt_epi8(bytes, high));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(bytes, space), control));
+
+        if (mask) return p + __builtin_ctz(mask);
+    }
+#endif
+
+    while (p < end && !isDelimiter(*p)) p++;
+
+    return p;
+}
+
+/**
+ * @brief Заменяет словесные числа в блоке целых строк.
+ * @details Слово - непрерывная последовательность символов без разделителей. Подряд
+ * идущие слова-числа одной строки заменяются их суммой, разделители между ними
+ * выбрасываются; всё остальное, включая разделители, копируется как есть. Неизменённые
+ * участки пишутся целиком, без разбора на отдельные слова.
+ * @param hashTable Указатель на хэш-таблицу.
+ * @param data Начало блока.
+ * @param length Длина блока (блок заканчивается концом строки или файла).
+ * @param out Указатель на буфер записи.
+ */
+static void rewriteBlock(HashTable *hashTable, const char *data, size_t length, OutputBuffer *out) {
+    const char *end = data + length;
+    const char *copied = data;
+    const char *runEnd = data;
+    const char *p = data;
+    long long sum = 0;
+    int hasNumber = 0;
+
+    while (p < end) {
+        const char *wordEnd = findDelimiter(p, end);
+
+        if (wordEnd > p) {
+            int value = hashTableSearchN(hashTable, p, wordEnd - p);
+
+            if (value != -1) {
+                if (!hasNumber) {
+                    outputWrite(out, copied, p - copied);
+                    sum = 0;
+                    hasNumber = 1;
+                }
+
+                sum += value;
+                runEnd = wordEnd;
+            } else if (hasNumber) {
+                outputNumber(out, sum);
+                copied = runEnd;
+                hasNumber = 0;
+            }
+        }
+
+        int newline = 0;
+
+        for (p = wordEnd; p < end && isDelimiter(*p); p++) newline |= *p == '\n';
+
+        // Числа не переходят через конец строки
+        if (hasNumber && newline) {
+            outputNumber(out, sum);
+            copied = runEnd;
+            hasNumber = 0;
+        }
+    }
+
+    if (hasNumber) {
+        outputNumber(out, sum);
+        copied = runEnd;
+    }
+
+    outputWrite(out, copied, end - copied);
+}
+
+/**
+ * @brief Обработчик блока целых строк: пишет в out результат обработки data.
+ */
+typedef void (*BlockRewriter)(void *context, const char *data, size_t length, OutputBuffer *out);
+
+/**
+ * @brief rewriteBlock в виде BlockRewriter; context - хэш-таблица.
+ */
+static void rewriteWords(void *context, const char *data, size_t length, OutputBuffer *out) {
+    rewriteBlock(context, data, length, out);
+}
+
+/**
+ * @brief Потоковая обработка файла блоками целых строк.
+ * @details Входной файл отображается в память (если это невозможно, например для канала,
+ * читается блоками по STREAM_BLOCK_SIZE с переносом неполной строки), результат пишется
+ * через большой буфер.
+ * @param rewrite Обработчик блока.
+ * @param context Параметр обработчика (словарь).
+ * @param inputFilename Имя входного файла.
+ * @param outputFilename Имя выходного файла.
+ * @return 0 в случае успеха, -1 в случае ошибки.
+ */
+static int streamFile(BlockRewriter rewrite, void *context, const char *inputFilename, const char *outputFilename) {
+    int input = open(inputFilename, O_RDONLY);
+    int output = open(outputFilename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    OutputBuffer out = {malloc(STREAM_BLOCK_SIZE), 0, STREAM_BLOCK_SIZE, output, 0};
+    struct stat info;
+
+    if (input < 0 || output < 0 || !out.data || fstat(input, &info) != 0) {
+        perror("Ошибка при открытии файла");
+        if (input >= 0) close(input);
+        if (output >= 0) close(output);
+        free(out.data);
+        return -1;
+    }
+
+    void *mapping = info.st_size > 0 ? mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, input, 0) : MAP_FAILED;
+
+    if (mapping != MAP_FAILED) {
+        madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+        rewrite(context, mapping, info.st_size, &out);
+        munmap(mapping, info.st_size);
+    } else {
+        size_t capacity = STREAM_BLOCK_SIZE, filled = 0;
+        char *block = malloc(capacity);
+        ssize_t result = 0;
+
+        while (block && (result = read(input, block + filled, capacity - filled)) > 0) {
+            filled += (size_t)result;
+
+            // Обрабатываем целые строки, хвост переносим в начало блока
+            size_t complete = filled;
+            while (complete > 0 && block[complete - 1] != '\n') complete--;
+
+            if (complete == 0 && filled == capacity) {
+                char *grown = realloc(block, capacity * 2);
+
+                if (!grown) break;
+
+                block = grown;
+                capacity *= 2;
+                continue;
+            }
+
+            rewrite(context, block, complete, &out);
+            memmove(block, block + complete, filled - complete);
+            filled -= complete;
+        }
+
+        if (!block || result < 0) out.failed = 1;
+        else rewrite(context, block, filled, &out);
+
+        free(block);
+    }
+
+    outputFlush(&out);
+    free(out.data);
+    close(input);
+
+    if (close(output) != 0 || out.failed) {
+        perror("Ошибка при записи файла");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Потоковая обработка текста: без ограничения длины строки и без копирования слов.
+ * @details Файл обрабатывается streamFile, слова ищутся в таблице по указателю и длине.
+ * Разделители слов - пробельные символы, а не только пробел, как в processText.
+ * @param hashTable Указатель на хэш-таблицу.
+ * @param inputFilename Имя входного файла.
+ * @param outputFilename Имя выходного файла.
+ * @return 0 в случае успеха, -1 в случае ошибки.
+ */
+int processTextStream(HashTable *hashTable, const char *inputFilename, const char *outputFilename) {
+    return streamFile(rewriteWords, hashTable, inputFilename, outputFilename);
+}
+
+/**
+ * @struct ParallelJob
+ * Общее состояние параллельной обработки: нарезка входа на куски и кольцо готовых результатов.
+ */
+typedef struct ParallelJob {
+    BlockRewriter rewrite;
+    void *context;
+    const char *data;
+    size_t length;
+    size_t next;            ///< Смещение начала следующего куска.
+    long long taken;        ///< Сколько кусков выдано потокам.
+    long long written;      ///< Сколько кусков записано в файл.
+    int inFlight;           ///< Размер кольца: кусков, обрабатываемых или ждущих записи.
+    OutputBuffer *slots;    ///< Результат куска i лежит в slots[i % inFlight].
+    int *ready;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} ParallelJob;
+
+/**
+ * @brief Рабочий поток: берёт следующий кусок, если для него есть место в кольце, и обрабатывает его.
+ * @param argument Указатель на ParallelJob.
+ * @return NULL.
+ */
+static void *parallelWorker(void *argument) {
+    ParallelJob *job = argument;
+
+    pthread_mutex_lock(&job->lock);
+
+    for (;;) {
+        while (job->next < job->length && job->taken >= job->written + job->inFlight)
+            pthread_cond_wait(&job->changed, &job->lock);
+
+        if (job->next >= job->length) break;
+
+        // Кусок заканчивается концом строки: слова-числа не переходят через строки,
+        // поэтому результат склейки кусков совпадает с обработкой файла целиком
+        size_t start = job->next;
+        size_t end = job->length;
+
+        if (job->length - start > PARALLEL_CHUNK_SIZE) {
+            const char *newline = memchr(job->data + start + PARALLEL_CHUNK_SIZE, '\n',
+                                         job->length - start - PARALLEL_CHUNK_SIZE);
+
+            if (newline) end = newline - job->data + 1;
+        }
+
+        long long index = job->taken++;
+        OutputBuffer *out = &job->slots[index % job->inFlight];
+
+        job->next = end;
+        pthread_mutex_unlock(&job->lock);
+
+        job->rewrite(job->context, job->data + start, end - start, out);
+
+        pthread_mutex_lock(&job->lock);
+        job->ready[index % job->inFlight] = 1;
+        pthread_cond_broadcast(&job->changed);
+    }
+
+    pthread_mutex_unlock(&job->lock);
+
+    return NULL;
+}
+
+/**
+ * @brief Параллельная обработка файла кусками целых строк с сохранением их порядка.
+ * @details Отображённый в память вход режется на куски по PARALLEL_CHUNK_SIZE байт до
+ * конца строки, куски обрабатываются пулом потоков, а результаты пишутся в файл строго
+ * по порядку из кольца на inFlight кусков. Память под результаты ограничена inFlight
+ * кусками. Если вход нельзя отобразить в память, работает streamFile.
+ * @param rewrite Обработчик блока (вызывается из нескольких потоков одновременно).
+ * @param context Параметр обработчика, только для чтения.
+ * @param inputFilename Имя входного файла.
+ * @param outputFilename Имя выходного файла.
+ * @param threads Количество потоков (0 - по числу процессоров).
+ * @param inFlight Наибольшее число кусков в обработке и в ожидании записи (0 - вдвое больше потоков).
+ * @return 0 в случае успеха, -1 в случае ошибки.
+ */
+static int parallelFile(BlockRewriter rewrite, void *context, const char *inputFilename, const char *outputFilename,
+                        int threads, int inFlight) {
+    int input = open(inputFilename, O_RDONLY);
+    struct stat info;
+
+    if (input < 0 || fstat(input, &info) != 0) {
+        perror("Ошибка при открытии файла");
+        if (input >= 0) close(input);
+        return -1;
+    }
+
+    void *mapping = info.st_size > 0 ? mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, input, 0) : MAP_FAILED;
+
+    close(input);
+
+    if (mapping == MAP_FAILED) return streamFile(rewrite, context, inputFilename, outputFilename);
+
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 0) threads = 1;
+    if (inFlight <= 0) inFlight = 2 * threads;
+    if (inFlight < threads) inFlight = threads;
+
+    int output = open(outputFilename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ParallelJob job = {rewrite, context, mapping, (size_t)info.st_size, 0, 0, 0, inFlight,
+                       calloc(inFlight, sizeof(OutputBuffer)), calloc(inFlight, sizeof(int)),
+                       PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+    pthread_t *workers = calloc(threads, sizeof(pthread_t));
+    int started = 0;
+    int failed = output < 0 || !job.slots || !job.ready || !workers;
+
+    if (!failed) {
+        for (int i = 0; i < inFlight; i++) job.slots[i].fd = -1;
+
+        madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+
+        while (started < threads && pthread_create(&workers[started], NULL, parallelWorker, &job) == 0) started++;
+
+        failed = started == 0;
+    }
+
+    // Запись по порядку: ждём очередной кусок, пишем его и освобождаем место в кольце
+    pthread_mutex_lock(&job.lock);
+
+    while (!failed) {
+        OutputBuffer *slot = &job.slots[job.written % inFlight];
+
+        while (!job.ready[job.written % inFlight] && !(job.next >= job.length && job.written == job.taken))
+            pthread_cond_wait(&job.changed, &job.lock);
+
+        if (job.written == job.taken && job.next >= job.length) break;
+
+        pthread_mutex_unlock(&job.lock);
+
+        OutputBuffer direct = {slot->data, slot->length, slot->capacity, output, slot->failed};
+
+        outputFlush(&direct);
+        failed = direct.failed;
+
+        pthread_mutex_lock(&job.lock);
+        job.ready[job.written % inFlight] = 0;
+        slot->length = 0;
+        job.written++;
+        pthread_cond_broadcast(&job.changed);
+    }
+
+    // При ошибке записи останавливаем раздачу кусков
+    job.next = job.length;
+    pthread_cond_broadcast(&job.changed);
+    pthread_mutex_unlock(&job.lock);
+
+    for (int i = 0; i < started; i++) pthread_join(workers[i], NULL);
+
+    for (int i = 0; job.slots && i < inFlight; i++) free(job.slots[i].data);
+    free(job.slots);
+    free(job.ready);
+    free(workers);
+    munmap(mapping, info.st_size);
+    pthread_mutex_destroy(&job.lock);
+    pthread_cond_destroy(&job.changed);
+
+    if (output < 0 || close(output) != 0 || failed) {
+        perror("Ошибка при записи файла");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Параллельная обработка текста с сохранением порядка строк.
+ * @details Куски файла обрабатываются пулом потоков с общей (только для чтения) таблицей,
+ * вывод побайтно совпадает с processTextStream. Подробнее - parallelFile.
+ * @param hashTable Указатель на хэш-таблицу.
+ * @param inputFilename Имя входного файла.
+ * @param outputFilename Имя выходного файла.
+ * @param threads Количество потоков (0 - по числу процессоров).
+ * @param inFlight Наибольшее число кусков в обработке и в ожидании записи (0 - вдвое больше потоков).
+ * @return 0 в случае успеха, -1 в случае ошибки.
+ */
+int processTextParallel(HashTable *hashTable, const char *inputFilename, const char *outputFilename, int threads,
+                        int inFlight) {
+    return parallelFile(rewriteWords, hashTable, inputFilename, outputFilename, threads, inFlight);
+}
+
+#define DICT_PARTITIONS_PER_THREAD 4 ///< Частей по префиксу хэша на поток при параллельной сборке словаря
+
+/**
+ * @struct DictBuild
+ * Общее состояние параллельной загрузки словаря.
+ */
+typedef struct DictBuild {
+    HashTable *hashTable;
+    struct DictChunk *chunks;
+    int chunkCount;
+    int partitions;     ///< Число частей, степень двойки не больше TABLE_SIZE
+    int partitionShift; ///< Часть - старшие биты хэша: hash >> partitionShift
+} DictBuild;
+
+/**
+ * @struct DictChunk
+ * Кусок файла словаря из целых строк и его доля работы.
+ */
+typedef struct DictChunk {
+    DictBuild *build;
+    int id;
+    const char *data;
+    size_t length;
+    size_t pairs;           ///< Половина слов куска - больше пар в нём не бывает
+    size_t count;           ///< Количество слов в куске
+    size_t poolBytes;       ///< Длина слов куска вместе с завершающими нулями
+    size_t nodeBase;        ///< Индекс первого узла куска
+    size_t poolBase;        ///< Смещение первого слова куска в пуле
+    size_t poolShift;       ///< На сколько сдвинулись слова куска при уплотнении пула
+    uint32_t *order;        ///< Номера узлов куска (от nodeBase), сгруппированные по частям
+    size_t *partitionStart; ///< Начало каждой части в order, partitions + 1 элементов
+} DictChunk;
+
+/**
+ * @brief Разбирает следующую пару "слово число" словаря.
+ * @details Слово ищется findDelimiter, число разбирается вручную. Если после слова нет
+ * числа, остаток строки пропускается.
+ * @param p Указатель на текущую позицию, сдвигается за разобранную пару.
+ * @param end Конец данных.
+ * @param word Начало слова.
+ * @param length Длина слова.
+ * @param value Число.
+ * @return 1, если пара найдена, 0 в конце данных.
+ */
+static int dictNextEntry(const char **p, const char *end, const char **word, size_t *length, int *value) {
+    const char *c = *p;
+
+    for (;;) {
+        while (c < end && isDelimiter(*c)) c++;
+
+        if (c == end) break;
+
+        *word = c;
+        c = findDelimiter(c, end);
+        *length = c - *word;
+
+        while (c < end && isDelimiter(*c) && *c != '\n') c++;
+
+        int negative = c < end && *c == '-';
+
+        if (c < end && (*c == '-' || *c == '+')) c++;
+
+        const char *digits = c;
+        unsigned int number = 0;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if (end - c >= 8) {
+            // SWAR: до 8 цифр за раз без ветвления на каждой цифре
+            uint64_t bytes, high = 0xF0F0F0F0F0F0F0F0ULL;
+
+            memcpy(&bytes, c, 8);
+
+            uint64_t tags = (bytes & high) | (((bytes + 0x0606060606060606ULL) & high) >> 4);
+            uint64_t other = tags ^ 0x3333333333333333ULL;
+            int count = other ? __builtin_ctzll(other) / 8 : 8;
+
+            if (count > 0) {
+                uint64_t packed = (bytes - 0x3030303030303030ULL) << (8 * (8 - count));
+
+                packed = (packed * 2561) >> 8 & 0x00FF00FF00FF00FFULL;
+                packed = (packed * 6553601) >> 16 & 0x0000FFFF0000FFFFULL;
+                number = (unsigned int)((packed * 42949672960001ULL) >> 32);
+                c += count;
+            }
+        }
+#endif
+
+        for (; c < end && (unsigned char)(*c - '0') < 10; c++) number = number * 10 + (unsigned int)(*c - '0');
+
+        if (c > digits) {
+            *value = (int)(negative ? 0u - number : number);
+            *p = c;
+            return 1;
+        }
+
+        c = memchr(c, '\n', end - c);
+
+        if (!c) break;
+    }
+
+    *p = end;
+
+    return 0;
+}
+
+/**
+ * @brief Первый проход по куску: верхняя граница числа пар.
+ * @details Пары, как и в createNumberDict, могут идти и по несколько в строке, поэтому
+ * считаются слова: каждая пара занимает два слова куска.
+ * @param argument Указатель на DictChunk.
+ * @return NULL.
+ */
+static void *dictTokens(void *argument) {
+    DictChunk *chunk = argument;
+    const char *p = chunk->data, *end = p + chunk->length;
+    size_t tokens = 0;
+
+    for (;;) {
+        while (p < end && isDelimiter(*p)) p++;
+
+        if (p == end) break;
+
+        tokens++;
+        p = findDelimiter(p, end);
+    }
+
+    chunk->pairs = tokens / 2;
+
+    return NULL;
+}
+
+/**
+ * @brief Второй проход по куску: слова в пул, узлы в массив, начиная с мест, зарезервированных
+ * по верхней границе (не больше pairs узлов; слово с нулём не длиннее пары, из которой оно взято).
+ * Затем номера узлов раскладываются по частям (подсчёт и раскладка), сохраняя порядок внутри части.
+ * @param argument Указатель на DictChunk.
+ * @return NULL.
+ */
+static void *dictFill(void *argument) {
+    DictChunk *chunk = argument;
+    HashTable *hashTable = chunk->build->hashTable;
+    const char *p = chunk->data, *end = p + chunk->length, *word;
+    size_t length, offset = chunk->poolBase;
+    Node *node = &hashTable->nodes[chunk->nodeBase], *limit = node + chunk->pairs;
+    int value;
+
+    while (node < limit && dictNextEntry(&p, end, &word, &length, &value)) {
+        memcpy(hashTable->pool + offset, word, length);
+        hashTable->pool[offset + length] = '\0';
+        node->hash = hashN(word, length);
+        node->offset = (uint32_t)offset;
+        node->value = value;
+        node++;
+        offset += length + 1;
+    }
+
+    chunk->count = node - &hashTable->nodes[chunk->nodeBase];
+    chunk->poolBytes = offset - chunk->poolBase;
+
+    const Node *nodes = &hashTable->nodes[chunk->nodeBase];
+    size_t *start = chunk->partitionStart;
+    int partitions = chunk->build->partitions, shift = chunk->build->partitionShift;
+
+    for (size_t i = 0; i < chunk->count; i++) start[(nodes[i].hash >> shift) + 1]++;
+
+    for (int i = 0; i < partitions; i++) start[i + 1] += start[i];
+
+    // Раскладка сдвигает start[i] к концу части i, то есть к началу части i + 1
+    for (size_t i = 0; i < chunk->count; i++) chunk->order[start[nodes[i].hash >> shift]++] = (uint32_t)i;
+
+    memmove(start + 1, start, sizeof(size_t) * partitions);
+    start[0] = 0;
+
+    return NULL;
+}
+
+/**
+ * @brief Третий проход: сцепляет узлы своих частей и поправляет их смещения в пуле.
+ * @details Поток берёт части id, id + chunkCount, ... и для каждой проходит только её узлы,
+ * кусок за куском, - в порядке вставки, как createNumberDict. Части не делят корзин и узлов,
+ * поэтому потоки пишут в таблицу без блокировок.
+ * @param argument Указатель на DictChunk.
+ * @return NULL.
+ */
+static void *dictLink(void *argument) {
+    DictChunk *chunk = argument;
+    DictBuild *build = chunk->build;
+    HashTable *hashTable = build->hashTable;
+
+    for (int partition = chunk->id; partition < build->partitions; partition += build->chunkCount) {
+        for (int i = 0; i < build->chunkCount; i++) {
+            const DictChunk *source = &build->chunks[i];
+
+            for (size_t j = source->partitionStart[partition]; j < source->partitionStart[partition + 1]; j++) {
+                size_t index = source->nodeBase + source->order[j];
+                Node *node = &hashTable->nodes[index];
+                size_t bucket = (uint64_t)node->hash >> hashTable->bucketShift;
+
+                node->offset -= (uint32_t)source->poolShift;
+                node->next = hashTable->table[bucket];
+                hashTable->table[bucket] = (uint32_t)index;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Выполняет проход по всем кускам: куски 1..n-1 в своих потоках, кусок 0 - в вызывающем.
+ * @details Если поток не создаётся, кусок обрабатывается в вызывающем потоке.
+ */
+static void dictRun(DictBuild *build, void *(*pass)(void *)) {
+    pthread_t *workers = calloc(build->chunkCount, sizeof(pthread_t));
+    int *started = calloc(build->chunkCount, sizeof(int));
+
+    for (int i = 1; i < build->chunkCount && workers && started; i++)
+        started[i] = pthread_create(&workers[i], NULL, pass, &build->chunks[i]) == 0;
+
+    pass(&build->chunks[0]);
+
+    for (int i = 1; i < build->chunkCount; i++) {
+        if (started && started[i]) pthread_join(workers[i], NULL);
+        else pass(&build->chunks[i]);
+    }
+
+    free(workers);
+    free(started);
+}
+
+/**
+ * @brief Загружает словарь целиком: отображает файл в память и собирает таблицу в несколько потоков.
+ * @details Файл делится на куски по строкам. По числу слов и размеру кусков память
+ * выделяется сразу (hashTableReserve), и каждый поток разбирает свой кусок прямо в массив
+ * узлов и пул - файл читается один раз. Затем пул уплотняется, а цепочки сцепляются:
+ * ключи разбиты на части по старшим битам хэша, а это и старшие биты индекса корзины,
+ * так что у каждой части свой непрерывный участок корзин. Пар в строке может быть
+ * несколько; если число стоит в той же строке, что и слово, результат совпадает с
+ * createNumberDict вплоть до расположения узлов. Остаток строки после слова без числа
+ * пропускается. Если файл нельзя отобразить в память, работает createNumberDict.
+ * @param filename Имя файла со словарем.
+ * @param hashTable Указатель на хэш-таблицу.
+ * @param threads Количество потоков (0 - по числу процессоров).
+ * @return 0 в случае успеха, -1 в случае ошибки.
+ */
+int createNumberDictBulk(const char *filename, HashTable *hashTable, int threads) {
+    int input = open(filename, O_RDONLY);
+    struct stat info;
+
+    if (input < 0 || fstat(input, &info) != 0) {
+        perror("Ошибка при открытии файла");
+        if (input >= 0) close(input);
+        return -1;
+    }
+
+    void *mapping = info.st_size > 0 ? mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, input, 0) : MAP_FAILED;
+
+    close(input);
+
+    if (info.st_size == 0) return 0;
+    if (mapping == MAP_FAILED) return createNumberDict(filename, hashTable);
+
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 0) threads = 1;
+    if (threads > TABLE_SIZE) threads = TABLE_SIZE;
+
+    const char *data = mapping;
+    size_t size = (size_t)info.st_size;
+    DictBuild build = {hashTable, calloc(threads, sizeof(DictChunk)), threads, 1, 32};
+    uint32_t *order = NULL;
+    size_t *partitionStarts = NULL;
+    int result = -1;
+
+    while (build.partitions < threads * DICT_PARTITIONS_PER_THREAD && build.partitions < TABLE_SIZE) {
+        build.partitions *= 2;
+        build.partitionShift--;
+    }
+
+    if (!build.chunks) goto done;
+
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    // Куски примерно равной длины, каждый заканчивается концом строки
+    for (int i = 0; i < threads; i++) {
+        DictChunk *chunk = &build.chunks[i];
+        size_t begin = i ? (size_t)(build.chunks[i - 1].data - data) + build.chunks[i - 1].length : 0;
+        size_t target = size / threads * (i + 1), finish = size;
+
+        if (i + 1 < threads && target <= begin) {
+            finish = begin;
+        } else if (i + 1 < threads) {
+            const char *newline = memchr(data + target, '\n', size - target);
+
+            if (newline) finish = (size_t)(newline - data) + 1;
+        }
+
+        chunk->build = &build;
+        chunk->id = i;
+        chunk->data = data + begin;
+        chunk->length = finish - begin;
+    }
+
+    dictRun(&build, dictTokens);
+
+    // Места кусков по верхним границам: узлов не больше пар слов, байт пула не больше байт файла
+    size_t pairs = 0;
+
+    for (int i = 0; i < threads; i++) {
+        build.chunks[i].nodeBase = hashTable->count + pairs;
+        build.chunks[i].poolBase = hashTable->poolLength + (size_t)(build.chunks[i].data - data);
+        pairs += build.chunks[i].pairs;
+    }
+
+    if (hashTableReserveStorage(hashTable, pairs, size) < 0) goto done;
+
+    // Номера узлов по частям: у каждого куска свой участок order, как и у его узлов
+    order = malloc(sizeof(uint32_t) * (pairs ? pairs : 1));
+    partitionStarts = calloc((size_t)threads * (build.partitions + 1), sizeof(size_t));
+
+    if (!order || !partitionStarts) goto done;
+
+    for (int i = 0; i < threads; i++) {
+        build.chunks[i].order = order + (build.chunks[i].nodeBase - hashTable->count);
+        build.chunks[i].partitionStart = partitionStarts + (size_t)i * (build.partitions + 1);
+    }
+
+    dictRun(&build, dictFill);
+
+    // Уплотнение: куски сдвигаются к началу по порядку, смещения слов поправит dictLink
+    size_t entries = 0, poolBytes = 0;
+
+    for (int i = 0; i < threads; i++) {
+        DictChunk *chunk = &build.chunks[i];
+        size_t nodeBase = hashTable->count + entries, poolBase = hashTable->poolLength + poolBytes;
+
+        if (nodeBase != chunk->nodeBase)
+            memmove(hashTable->nodes + nodeBase, hashTable->nodes + chunk->nodeBase, sizeof(Node) * chunk->count);
+
+        if (poolBase != chunk->poolBase)
+            memmove(hashTable->pool + poolBase, hashTable->pool + chunk->poolBase, chunk->poolBytes);
+
+        chunk->nodeBase = nodeBase;
+        chunk->poolShift = chunk->poolBase - poolBase;
+        entries += chunk->count;
+        poolBytes += chunk->poolBytes;
+    }
+
+    if (hashTableReserveBuckets(hashTable, hashTable->count + entries) < 0) goto done;
+
+    dictRun(&build, dictLink);
+
+    hashTable->count += entries;
+    hashTable->poolLength += poolBytes;
+    result = 0;
+
+done:
+    if (result < 0) perror("Ошибка при загрузке словаря");
+
+    free(build.chunks);
+    free(order);
+    free(partitionStarts);
+    munmap(mapping, size);
+
+    return result;
+}
+
+/**
+ * @struct NumberMatcher
+ * Автомат Ахо-Корасик, скомпилированный из словаря в детерминированный автомат.
+ * Таблица переходов сжата по алфавиту: байты, не встречающиеся в словах словаря,
+ * образуют один класс, поэтому строка состояния занимает classes элементов, а не 256.
+ * Элемент таблицы - смещение строки следующего состояния, умноженное на 2; младший
+ * бит показывает, что в этом состоянии заканчивается слово словаря.
+ */
+typedef struct NumberMatcher {
+    unsigned char byteClass[256];
+    int classes;
+    int states;
+    int *next;          ///< Переходы: states * classes элементов.
+    int *pattern;       ///< Слово, которое заканчивается в состоянии, или -1.
+    int *outputLink;    ///< Ближайшее по суффиксным ссылкам состояние со словом, или -1.
+    int *depth;         ///< Длина строки, ведущей в состояние из корня.
+    int *lengths;       ///< Длины слов.
+    int *values;        ///< Значения слов.
+    int patternCount;
+    int maxLength;      ///< Длина самого длинного слова.
+} NumberMatcher;
+
+/**
+ * @brief Освобождает автомат.
+ * @param matcher Указатель на автомат.
+ */
+void freeNumberMatcher(NumberMatcher *matcher) {
+    if (!matcher) return;
+
+    free(matcher->next);
+    free(matcher->pattern);
+    free(matcher->outputLink);
+    free(matcher->depth);
+    free(matcher->lengths);
+    free(matcher->values);
+    free(matcher);
+}
+
+/**
+ * @brief Компилирует словарь в автомат Ахо-Корасик.
+ * @details Слова могут содержать пробелы ("twenty one"), тогда составное числительное
+ * находится целиком. createNumberDict и createNumberDictBulk делят файл по пробельным
+ * символам, поэтому такие слова добавляются только через hashTableInsert. Для
+ * повторяющихся слов берётся значение, которое вернул бы hashTableSearch.
+ * @param hashTable Указатель на хэш-таблицу со словарём.
+ * @return Указатель на автомат или NULL при ошибке выделения памяти или если таблица
+ * переходов (суммарная длина слов * число классов * 2) не помещается в int.
+ */
+NumberMatcher *createNumberMatcher(HashTable *hashTable) {
+    NumberMatcher *matcher = calloc(1, sizeof(NumberMatcher));
+    size_t totalLength = 0;
+
+    if (!matcher) return NULL;
+
+    // Классы байтов и размеры: состояний не больше, чем байт во всех словах, плюс корень
+    for (size_t i = 0; i < hashTable->count; i++) {
+        const char *word = hashTable->pool + hashTable->nodes[i].offset;
+
+        for (const unsigned char *c = (const unsigned char *)word; *c; c++)
+            if (!matcher->byteClass[*c]) matcher->byteClass[*c] = (unsigned char)++matcher->classes;
+
+        size_t length = strlen(word);
+
+        totalLength += length;
+        if (length > (size_t)matcher->maxLength) matcher->maxLength = (int)length;
+    }
+
+    matcher->classes++;
+
+    // Элемент таблицы переходов - смещение строки * 2 в int, и состояний не больше totalLength + 1
+    if (hashTable->count >= INT_MAX || totalLength + 1 > (size_t)INT_MAX / 2 / matcher->classes) {
+        free(matcher);
+        return NULL;
+    }
+
+    size_t capacity = totalLength + 1;
+
+    matcher->patternCount = (int)hashTable->count;
+    matcher->next = calloc(capacity * matcher->classes, sizeof(int));
+    matcher->pattern = malloc(capacity * sizeof(int));
+    matcher->outputLink = malloc(capacity * sizeof(int));
+    matcher->depth = malloc(capacity * sizeof(int));
+    matcher->lengths = malloc((hashTable->count + 1) * sizeof(int));
+    matcher->values = malloc((hashTable->count + 1) * sizeof(int));
+
+    int *fail = calloc(capacity, sizeof(int));
+    int *queue = malloc(capacity * sizeof(int));
+
+    if (!matcher->next || !matcher->pattern || !matcher->outputLink || !matcher->depth || !matcher->lengths ||
+        !matcher->values || !fail || !queue) {
+        free(fail);
+        free(queue);
+        freeNumberMatcher(matcher);
+        return NULL;
+    }
+
+    // Бор: переход 0 означает "нет перехода" (в корень ведут только недостроенные переходы)
+    int classes = matcher->classes;
+    int patterns = 0;
+
+    matcher->states = 1;
+    matcher->pattern[0] = -1;
+    matcher->depth[0] = 0;
+
+    // От последнего вставленного к первому: для повторов остаётся то, что находит hashTableSearch
+    for (size_t i = hashTable->count; i-- > 0;) {
+        const Node *node = &hashTable->nodes[i];
+        const char *word = hashTable->pool + node->offset;
+        int state = 0;
+
+        if (!word[0]) continue;
+
+        for (const unsigned char *c = (const unsigned char *)word; *c; c++) {
+            int *edge = &matcher->next[state * classes + matcher->byteClass[*c]];
+
+            if (!*edge) {
+                *edge = matcher->states;
+                matcher->depth[matcher->states] = matcher->depth[state] + 1;
+                matcher->pattern[matcher->states++] = -1;
+            }
+
+            state = *edge;
+        }
+
+        if (matcher->pattern[state] < 0) {
+            matcher->lengths[patterns] = (int)strlen(word);
+            matcher->values[patterns] = node->value;
+            matcher->pattern[state] = patterns++;
+        }
+    }
+
+    // Суффиксные ссылки обходом в ширину; недостающие переходы берутся у состояния по ссылке
+    int head = 0, tail = 0;
+
+    matcher->outputLink[0] = -1;
+
+    for (int c = 0; c < classes; c++) {
+        int child = matcher->next[c];
+
+        if (child) {
+            fail[child] = 0;
+            queue[tail++] = child;
+        }
+    }
+
+    while (head < tail) {
+        int state = queue[head++];
+        int link = fail[state];
+
+        matcher->outputLink[state] = matcher->pattern[link] >= 0 ? link : matcher->outputLink[link];
+
+        for (int c = 0; c < classes; c++) {
+            int *edge = &matcher->next[state * classes + c];
+
+            if (*edge) {
+                fail[*edge] = matcher->next[link * classes + c];
+                queue[tail++] = *edge;
+            } else {
+                *edge = matcher->next[link * classes + c];
+            }
+        }
+    }
+
+    // Переходы в готовом виде: смещение строки * 2 и признак слова в младшем бите
+    for (int i = 0; i < matcher->states * classes; i++) {
+        int target = matcher->next[i];
+        int output = matcher->pattern[target] >= 0 || matcher->outputLink[target] >= 0;
+
+        matcher->next[i] = (target * classes) << 1 | output;
+    }
+
+    free(fail);
+    free(queue);
+
+    return matcher;
+}
+
+/**
+ * @brief Проверяет, является ли байт частью слова (буква, цифра, '_' или байт UTF-8).
+ */
+static inline int isWordChar(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c >= 0x80;
+}
+
+/**
+ * @struct MatchRun
+ * Состояние замены при сканировании автоматом: серия чисел, ещё не записанная в вывод.
+ */
+typedef struct MatchRun {
+    const char *copied;   ///< Начало ещё не записанного текста.
+    const char *runEnd;   ///< Конец последнего числа серии.
+    long long sum;
+    int hasNumber;
+} MatchRun;
+
+/**
+ * @brief Добавляет найденное слово-число к серии или начинает новую.
+ * @details Числа, между которыми только пробельные символы без перевода строки,
+ * складываются; всё остальное (в том числе знаки препинания) серию прерывает.
+ */
+static void matchCommit(MatchRun *run, const char *start, const char *end, int value, OutputBuffer *out) {
+    if (run->hasNumber) {
+        const char *gap = run->runEnd;
+
+        while (gap < start && isDelimiter(*gap) && *gap != '\n') gap++;
+
+        if (gap == start) {
+            run->sum += value;
+            run->runEnd = end;
+            return;
+        }
+
+        outputNumber(out, run->sum);
+        run->copied = run->runEnd;
+    }
+
+    outputWrite(out, run->copied, start - run->copied);
+    run->sum = value;
+    run->runEnd = end;
+    run->hasNumber = 1;
+}
+
+/**
+ * @struct PendingMatch
+ * Выбранное совпадение, которое ещё может вытеснить совпадение, начинающееся раньше.
+ */
+typedef struct PendingMatch {
+    size_t start;
+    size_t end;
+    int value;
+} PendingMatch;
+
+/**
+ * @brief Заменяет словесные числа в блоке целых строк одним проходом автомата.
+ * @details Слово словаря засчитывается, если до и после него нет символа слова
+ * ("five," находится, "fiver" - нет). Из пересекающихся совпадений берётся самое
+ * левое, из начинающихся в одном месте - самое длинное. Выбранные совпадения ждут в
+ * очереди, пока строка, которую ещё может продолжить автомат (depth текущего состояния),
+ * не начнётся правее их начала: до этого их может вытеснить более длинное слово,
+ * начинающееся раньше ("one two three" поверх "one" и "two").
+ * @param context Указатель на NumberMatcher.
+ * @param data Начало блока.
+ * @param length Длина блока.
+ * @param out Указатель на буфер записи.
+ */
+static void rewriteMatches(void *context, const char *data, size_t length, OutputBuffer *out) {
+    const NumberMatcher *matcher = context;
+    const unsigned char *text = (const unsigned char *)data;
+    const int *next = matcher->next;
+    MatchRun run = {data, data, 0, 0};
+    // Ожидающие совпадения не пересекаются и лежат в последних maxLength байтах
+    PendingMatch *pending = malloc(sizeof(PendingMatch) * (matcher->maxLength + 1));
+    size_t count = 0, committedEnd = 0;
+    int entry = 0;
+
+    if (!pending) {
+        outputWrite(out, data, length);
+        return;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        entry = next[(entry >> 1) + matcher->byteClass[text[i]]];
+
+        if (!(entry & 1)) continue;
+
+        // Конец слова: после него не символ слова
+        if (i + 1 < length && isWordChar(text[i + 1])) continue;
+
+        int state = (entry >> 1) / matcher->classes;
+        int found = matcher->pattern[state] >= 0 ? state : matcher->outputLink[state];
+        size_t earliest = i + 1 - matcher->depth[state], ready = 0;
+
+        // Совпадения, которые уже нечем вытеснить
+        for (; ready < count && pending[ready].start < earliest; ready++) {
+            matchCommit(&run, data + pending[ready].start, data + pending[ready].end, pending[ready].value, out);
+            committedEnd = pending[ready].end;
+        }
+
+        if (ready > 0) {
+            count -= ready;
+            memmove(pending, pending + ready, sizeof(PendingMatch) * count);
+        }
+
+        // Самое длинное слово, перед которым не символ слова
+        for (; found >= 0; found = matcher->outputLink[found]) {
+            int patternIndex = matcher->pattern[found];
+            size_t start = i + 1 - matcher->lengths[patternIndex];
+            size_t overlap = count;
+
+            if (start > 0 && isWordChar(text[start - 1])) continue;
+
+            // Пересекающиеся ожидающие совпадения - хвост очереди
+            while (overlap > 0 && pending[overlap - 1].end > start) overlap--;
+
+            // Пересечение с совпадением, начинающимся раньше: пробуем более короткие слова
+            if (start < committedEnd || (overlap < count && pending[overlap].start < start)) continue;
+
+            count = overlap;
+            pending[count].start = start;
+            pending[count].end = i + 1;
+            pending[count].value = matcher->values[patternIndex];
+            count++;
+            break;
+        }
+    }
+
+    for (size_t j = 0; j < count; j++)
+        matchCommit(&run, data + pending[j].start, data + pending[j].end, pending[j].value, out);
+
+    free(pending);
+
+    if (run.hasNumber) {
+        outputNumber(out, run.sum);
+        run.copied = run.runEnd;
+    }
+
+    outputWrite(out, run.copied, data + length - run.copied);
+}
+
+/**
+ * @brief Обработка текста автоматом Ахо-Корасик за один проход.
+ * @details В отличие от processTextStream находит слова-числа с прилипшими знаками
+ * препинания и составные числительные из словаря; остальные слова ничего не стоят -
+ * на каждый байт приходится один переход по таблице.
+ * @param matcher Указатель на автомат (createNumberMatcher).
+ * @param inputFilename Имя входного файла.
+ * @param outputFilename Имя выходного файла.
+ * @param threads 1 - потоковая обработка, иначе параллельная (0 - по числу процессоров).
+ * @return 0 в случае успеха, -1 в случае ошибки.
+ */
+int processTextMatcher(NumberMatcher *matcher, const char *inputFilename, const char *outputFilename, int threads) {
+    if (threads == 1) return streamFile(rewriteMatches, matcher, inputFilename, outputFilename);
+
+    return parallelFile(rewriteMatches, matcher, inputFilename, outputFilename, threads, 0);
+}
+
+/**
+ * @brief Текущее время в секундах для бенчмарков.
+ */
+static double benchNow() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Генератор псевдослучайных чисел xorshift64 для бенчмарков.
+ */
+static unsigned long long benchRandom(unsigned long long *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+
+    return *state;
+}
+
+/**
+ * @brief Заполняет таблицу словами-числами для бенчмарков (как numbers.txt).
+ */
+static void benchDict(HashTable *hashTable) {
+    static const char *words[] = {"zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine",
+                                  "ten", "eleven", "twelve", "thirteen", "fourteen", "fifteen", "sixteen",
+                                  "seventeen", "eighteen", "nineteen", "twenty", "thirty", "forty", "fifty",
+                                  "sixty", "seventy", "eighty", "ninety", "hundred", "thousand"};
+    static const int values[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+                                 20, 30, 40, 50, 60, 70, 80, 90, 100, 1000};
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) hashTableInsert(hashTable, words[i], values[i]);
+}
+
+/**
+ * @brief Записывает строку в файл целиком.
+ * @return 0 в случае успеха, -1 в случае ошибки.
+ */
+static int benchWriteFile(const char *filename, const char *text, size_t length) {
+    FILE *file = fopen(filename, "wb");
+
+    if (!file) return -1;
+
+    size_t written = fwrite(text, 1, length, file);
+
+    return fclose(file) == 0 && written == length ? 0 : -1;
+}
+
+/**
+ * @brief Читает файл целиком в память.
+ * @param length Сюда записывается длина.
+ * @return Содержимое файла (нужно освободить) или NULL.
+ */
+static char *benchReadFile(const char *filename, size_t *length) {
+    FILE *file = fopen(filename, "rb");
+    char *text = NULL;
+
+    if (!file) return NULL;
+
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+
+        text = size >= 0 ? malloc((size_t)size + 1) : NULL;
+
+        if (text) {
+            rewind(file);
+            *length = fread(text, 1, (size_t)size, file);
+            text[*length] = '\0';
+        }
+    }
+
+    fclose(file);
+
+    return text;
+}
+
+/**
+ * @brief Записывает во файл случайный текст из обычных слов и слов-чисел.
+ * @details Примерно каждая 64-я строка длиннее 1024 байт.
+ * @param filename Имя файла.
+ * @param target Желаемый размер в байтах.
+ * @return Размер записанного текста или 0 в случае ошибки.
+ */
+static size_t benchCorpus(const char *filename, size_t target) {
+    static const char *fillers[] = {"the", "apples", "and", "of", "were", "counted", "five,", "in", "a", "box"};
+    static const char *numbers[] = {"one", "two", "three", "twenty", "hundred", "seven", "thousand", "ninety"};
+    FILE *input = fopen(filename, "wb");
+    unsigned long long state = 88172645463325252ULL;
+    size_t size = 0;
+
+    while (input && size < target) {
+        int words = 3 + (int)(benchRandom(&state) % 20);
+
+        if (benchRandom(&state) % 64 == 0) words = 400;
+
+        for (int i = 0; i < words; i++) {
+            unsigned long long r = benchRandom(&state);
+            const char *word = r % 3 == 0 ? numbers[(r >> 8) % 8] : fillers[(r >> 8) % 10];
+
+            size += fprintf(input, i ? " %s" : "%s", word);
+        }
+
+        fputc('\n', input);
+        size++;
+    }
+
+    return input && fclose(input) == 0 ? size : 0;
+}
+
+/**
+ * @brief Сравнивает содержимое двух файлов.
+ * @return 1, если файлы побайтно совпадают.
+ */
+static int benchSameFiles(const char *first, const char *second) {
+    FILE *a = fopen(first, "rb");
+    FILE *b = fopen(second, "rb");
+    char *blockA = malloc(STREAM_BLOCK_SIZE);
+    char *blockB = malloc(STREAM_BLOCK_SIZE);
+    int same = a && b && blockA && blockB;
+
+    while (same) {
+        size_t readA = fread(blockA, 1, STREAM_BLOCK_SIZE, a);
+        size_t readB = fread(blockB, 1, STREAM_BLOCK_SIZE, b);
+
+        same = readA == readB && memcmp(blockA, blockB, readA) == 0;
+
+        if (readA < STREAM_BLOCK_SIZE) break;
+    }
+
+    if (a) fclose(a);
+    if (b) fclose(b);
+    free(blockA);
+    free(blockB);
+
+    return same;
+}
+
+/**
+ * @brief Потоковый режим против processText: проверка результата и скорость в МБ/с.
+ * @details ./asd_lab_8_task --bench stream [МБ], по умолчанию 64 МБ случайного текста во
+ * временном каталоге; часть строк длиннее 1024 байт.
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void benchStream(int argc, char *argv[]) {
+    size_t target = (size_t)(argc > 0 ? atoi(argv[0]) : 64) << 20;
+    char inputName[] = "/tmp/asd_lab_8_task_inXXXXXX";
+    char outputName[] = "/tmp/asd_lab_8_task_outXXXXXX";
+    HashTable *hashTable = createHashTable();
+    int inputFd = mkstemp(inputName);
+    int outputFd = mkstemp(outputName);
+
+    benchDict(hashTable);
+
+    if (inputFd < 0 || outputFd < 0) {
+        perror("Ошибка при создании временного файла");
+        freeHashTable(hashTable);
+        return;
+    }
+
+    close(inputFd);
+    close(outputFd);
+
+    // Проверка на маленьком примере: суммы, пунктуация, пробельные символы, конец строки
+    const char *sample = "one two apples\nthree\n\tfour  five, six\r\nseven";
+    const char *expected = "3 apples\n3\n\t4  five, 6\r\n7";
+    size_t length = 0;
+    char *result = NULL;
+
+    if (benchWriteFile(inputName, sample, strlen(sample)) == 0 &&
+        processTextStream(hashTable, inputName, outputName) == 0)
+        result = benchReadFile(outputName, &length);
+
+    printf("check: %s\n", result && strcmp(result, expected) == 0 ? "ok" : "FAILED");
+    free(result);
+
+    // Случайный текст
+    size_t size = benchCorpus(inputName, target);
+
+    if (size == 0) {
+        perror("Ошибка при записи временного файла");
+    } else {
+        double start = benchNow();
+        processText(hashTable, inputName, outputName);
+        double lineTime = benchNow() - start;
+
+        start = benchNow();
+        processTextStream(hashTable, inputName, outputName);
+        double streamTime = benchNow() - start;
+
+        printf("input %.1f MB\n", size / 1048576.0);
+        printf("processText        %8.1f MB/s\n", size / 1048576.0 / lineTime);
+        printf("processTextStream  %8.1f MB/s\n", size / 1048576.0 / streamTime);
+    }
+
+    remove(inputName);
+    remove(outputName);
+    freeHashTable(hashTable);
+}
+
+/**
+ * @brief Параллельный режим: совпадение с потоковым и скорость при разном числе потоков.
+ * @details ./asd_lab_8_task --bench parallel [МБ], по умолчанию 128 МБ; потоки 1, 2, 4, ...
+ * до удвоенного числа процессоров, плюс прогон с кольцом минимального размера.
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void benchParallel(int argc, char *argv[]) {
+    size_t target = (size_t)(argc > 0 ? atoi(argv[0]) : 128) << 20;
+    char inputName[] = "/tmp/asd_lab_8_task_inXXXXXX";
+    char referenceName[] = "/tmp/asd_lab_8_task_refXXXXXX";
+    char outputName[] = "/tmp/asd_lab_8_task_outXXXXXX";
+    int descriptors[] = {mkstemp(inputName), mkstemp(referenceName), mkstemp(outputName)};
+    HashTable *hashTable = createHashTable();
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t size = 0;
+
+    benchDict(hashTable);
+
+    for (int i = 0; i < 3; i++)
+        if (descriptors[i] >= 0) close(descriptors[i]);
+
+    if (descriptors[0] >= 0 && descriptors[1] >= 0 && descriptors[2] >= 0) size = benchCorpus(inputName, target);
+
+    if (size == 0) {
+        perror("Ошибка при записи временного файла");
+    } else {
+        double start = benchNow();
+        processTextStream(hashTable, inputName, referenceName);
+        double streamTime = benchNow() - start;
+
+        printf("input %.1f MB, %ld processors\n", size / 1048576.0, processors);
+        printf("stream                  %8.1f MB/s\n", size / 1048576.0 / streamTime);
+
+        for (int threads = 1; threads <= 2 * processors || threads == 1; threads *= 2) {
+            for (int ring = 0; ring < 2; ring++) {
+                // Кольцо минимального размера: каждый поток ждёт, пока запишут предыдущий кусок
+                int inFlight = ring ? threads : 0;
+
+                start = benchNow();
+                processTextParallel(hashTable, inputName, outputName, threads, inFlight);
+                double time = benchNow() - start;
+
+                printf("parallel %2d threads %-3s %8.1f MB/s  %s\n", threads, ring ? "min" : "",
+                       size / 1048576.0 / time, benchSameFiles(referenceName, outputName) ? "identical" : "DIFFERENT");
+            }
+        }
+    }
+
+    remove(inputName);
+    remove(referenceName);
+    remove(outputName);
+    freeHashTable(hashTable);
+}
+
+/**
+ * @brief Автомат Ахо-Корасик против потокового режима с хэш-таблицей.
+ * @details ./asd_lab_8_task --bench matcher [МБ], по умолчанию 64 МБ.
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void benchMatcher(int argc, char *argv[]) {
+    size_t target = (size_t)(argc > 0 ? atoi(argv[0]) : 64) << 20;
+    char inputName[] = "/tmp/asd_lab_8_task_inXXXXXX";
+    char outputName[] = "/tmp/asd_lab_8_task_outXXXXXX";
+    int descriptors[] = {mkstemp(inputName), mkstemp(outputName)};
+    HashTable *hashTable = createHashTable();
+    NumberMatcher *matcher = NULL;
+    size_t size = 0;
+
+    benchDict(hashTable);
+
+    for (int i = 0; i < 2; i++)
+        if (descriptors[i] >= 0) close(descriptors[i]);
+
+    if (descriptors[0] < 0 || descriptors[1] < 0) {
+        perror("Ошибка при создании временного файла");
+        freeHashTable(hashTable);
+        return;
+    }
+
+    // Проверка: пунктуация, границы слов, составное числительное и самое левое из пересекающихся,
+    // в том числе начинающееся раньше уже найденных ("one two three" поверх "one" и "two")
+    // и пересекающееся с уже записанным ("seven eight" после "six seven")
+    hashTableInsert(hashTable, "one hundred", 100);
+    hashTableInsert(hashTable, "one two three", 123);
+    hashTableInsert(hashTable, "six seven", 67);
+    hashTableInsert(hashTable, "seven eight", 78);
+    matcher = createNumberMatcher(hashTable);
+
+    const char *sample = "one two apples\nfour  five, six\r\nxone onex (one)\none hundred thousand; five one hundred\n"
+                         "x one two three y\none two x\nsix seven eight";
+    const char *expected = "3 apples\n9, 6\r\nxone onex (1)\n1100; 105\nx 123 y\n3 x\n75";
+    size_t length = 0;
+    char *result = NULL;
+
+    if (matcher && benchWriteFile(inputName, sample, strlen(sample)) == 0 &&
+        processTextMatcher(matcher, inputName, outputName, 1) == 0)
+        result = benchReadFile(outputName, &length);
+
+    printf("check: %s\n", result && strcmp(result, expected) == 0 ? "ok" : "FAILED");
+    free(result);
+    freeNumberMatcher(matcher);
+    freeHashTable(hashTable);
+
+    // Скорость на словаре без составных слов, как у потокового режима
+    hashTable = createHashTable();
+    benchDict(hashTable);
+    matcher = createNumberMatcher(hashTable);
+    size = matcher ? benchCorpus(inputName, target) : 0;
+
+    if (size == 0) {
+        perror("Ошибка при записи временного файла");
+    } else {
+        double start = benchNow();
+        processTextStream(hashTable, inputName, outputName);
+        double streamTime = benchNow() - start;
+
+        start = benchNow();
+        processTextMatcher(matcher, inputName, outputName, 1);
+        double matcherTime = benchNow() - start;
+
+        printf("input %.1f MB, automaton %d states x %d byte classes\n", size / 1048576.0, matcher->states,
+               matcher->classes);
+        printf("processTextStream   %8.1f MB/s\n", size / 1048576.0 / streamTime);
+        printf("processTextMatcher  %8.1f MB/s\n", size / 1048576.0 / matcherTime);
+    }
+
+    remove(inputName);
+    remove(outputName);
+    freeNumberMatcher(matcher);
+    freeHashTable(hashTable);
+}
+
+/**
+ * @brief Память и скорость поиска хэш-таблицы на большом словаре.
+ * @details ./asd_lab_8_task --bench pool [слов], по умолчанию 5000000 случайных слов длиной 3-12.
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void benchPool(int argc, char *argv[]) {
+    size_t count = argc > 0 ? (size_t)atol(argv[0]) : 5000000;
+    char *words = malloc(count * 13);
+    size_t *offsets = malloc(count * sizeof(size_t));
+    HashTable *hashTable = createHashTable();
+    unsigned long long state = 88172645463325252ULL;
+    size_t length = 0;
+    int valid = 1;
+
+    if (!words || !offsets) {
+        perror("Ошибка выделения памяти");
+        free(words);
+        free(offsets);
+        freeHashTable(hashTable);
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        int wordLength = 3 + (int)(benchRandom(&state) % 10);
+
+        offsets[i] = length;
+
+        for (int j = 0; j < wordLength; j++) words[length++] = (char)('a' + benchRandom(&state) % 26);
+
+        words[length++] = '\0';
+    }
+
+    double start = benchNow();
+
+    for (size_t i = 0; i < count && valid; i++) valid = hashTableInsert(hashTable, words + offsets[i], (int)i) == 0;
+
+    double insertTime = benchNow() - start;
+
+    // Поиск в случайном порядке: попадания, затем промахи (первая буква заменена на заглавную)
+    size_t *order = offsets;
+
+    for (size_t i = count; i > 1; i--) {
+        size_t j = benchRandom(&state) % i;
+        size_t temp = order[i - 1];
+
+        order[i - 1] = order[j];
+        order[j] = temp;
+    }
+
+    long long sink = 0;
+
+    start = benchNow();
+
+    for (size_t i = 0; i < count; i++) {
+        int value = hashTableSearch(hashTable, words + order[i]);
+
+        // Слово могло повториться: тогда найдено значение последней вставки того же слова
+        if (value < 0 || strcmp(hashTable->pool + hashTable->nodes[value].offset, words + order[i]) != 0) valid = 0;
+
+        sink += value;
+    }
+
+    double hitTime = benchNow() - start;
+
+    for (size_t i = 0; i < count; i++) words[order[i]] -= 'a' - 'A';
+
+    start = benchNow();
+
+    for (size_t i = 0; i < count; i++) sink += hashTableSearch(hashTable, words + order[i]);
+
+    double missTime = benchNow() - start;
+
+    size_t used = hashTable->bucketCount * sizeof(uint32_t) + hashTable->count * sizeof(Node) + hashTable->poolLength;
+    size_t reserved =
+        hashTable->bucketCount * sizeof(uint32_t) + hashTable->nodeCapacity * sizeof(Node) + hashTable->poolCapacity;
+
+    printf("check: %s\n", valid && sink != -1 ? "ok" : "FAILED");
+    printf("%zu words, %zu buckets, pool %.1f MB\n", hashTable->count, hashTable->bucketCount,
+           hashTable->poolLength / 1048576.0);
+    printf("bytes/entry    %6.1f used, %6.1f allocated (node %zu bytes)\n", (double)used / count,
+           (double)reserved / count, sizeof(Node));
+    printf("insert         %6.1f ns\n", insertTime * 1e9 / count);
+    printf("search hit     %6.1f ns\n", hitTime * 1e9 / count);
+    printf("search miss    %6.1f ns\n", missTime * 1e9 / count);
+
+    free(words);
+    free(offsets);
+    freeHashTable(hashTable);
+}
+
+/**
+ * @brief Сравнивает две таблицы вплоть до расположения узлов, корзин и пула.
+ * @return 1, если таблицы совпадают.
+ */
+static int benchSameTables(const HashTable *first, const HashTable *second) {
+    return first->count == second->count && first->bucketCount == second->bucketCount &&
+           first->poolLength == second->poolLength &&
+           memcmp(first->table, second->table, sizeof(uint32_t) * first->bucketCount) == 0 &&
+           (!first->count || memcmp(first->nodes, second->nodes, sizeof(Node) * first->count) == 0) &&
+           (!first->poolLength || memcmp(first->pool, second->pool, first->poolLength) == 0);
+}
+
+/**
+ * @brief Загрузка словаря: createNumberDict против createNumberDictBulk при разном числе потоков.
+ * @details ./asd_lab_8_task --bench load [строк], по умолчанию 10000000 строк "слово число".
+ * @param argc Количество параметров.
+ * @param argv Параметры.
+ */
+static void benchLoad(int argc, char *argv[]) {
+    size_t lines = argc > 0 ? (size_t)atol(argv[0]) : 10000000;
+    char dictName[] = "/tmp/asd_lab_8_task_dictXXXXXX";
+    int descriptor = mkstemp(dictName);
+    FILE *file = descriptor >= 0 ? fdopen(descriptor, "w") : NULL;
+    unsigned long long state = 88172645463325252ULL;
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (!file) {
+        perror("Ошибка при создании временного файла");
+        if (descriptor >= 0) close(descriptor);
+        return;
+    }
+
+    for (size_t i = 0; i < lines; i++) {
+        char word[16];
+        int length = 3 + (int)(benchRandom(&state) % 10);
+
+        for (int j = 0; j < length; j++) word[j] = (char)('a' + benchRandom(&state) % 26);
+
+        word[length] = '\0';
+        fprintf(file, "%s %d\n", word, (int)(benchRandom(&state) % 2000001) - 1000000);
+    }
+
+    if (fclose(file) != 0) {
+        perror("Ошибка при записи временного файла");
+        remove(dictName);
+        return;
+    }
+
+    // Проверка: пробелы, знаки, строка без числа, несколько пар в строке, нет перевода строки в конце
+    const char *sample = "one 1\n\n  two\t-2\r\nbroken line\nthree +3\na 10 b 20 c 30 d 40 e 50\nfour 4";
+    char sampleName[] = "/tmp/asd_lab_8_task_sampleXXXXXX";
+    int sampleFd = mkstemp(sampleName);
+    int sampleOk = sampleFd >= 0 && benchWriteFile(sampleName, sample, strlen(sample)) == 0;
+
+    for (int threads = 1; threads <= 3; threads += 2) {
+        HashTable *sampleTable = createHashTable();
+
+        sampleOk &= createNumberDictBulk(sampleName, sampleTable, threads) == 0 && sampleTable->count == 9 &&
+                    hashTableSearch(sampleTable, "one") == 1 && hashTableSearch(sampleTable, "two") == -2 &&
+                    hashTableSearch(sampleTable, "three") == 3 && hashTableSearch(sampleTable, "four") == 4 &&
+                    hashTableSearch(sampleTable, "a") == 10 && hashTableSearch(sampleTable, "e") == 50;
+        freeHashTable(sampleTable);
+    }
+
+    if (sampleFd >= 0) close(sampleFd);
+
+    remove(sampleName);
+
+    HashTable *reference = createHashTable();
+    double start = benchNow();
+
+    createNumberDict(dictName, reference);
+
+    double referenceTime = benchNow() - start;
+    int same = 1;
+
+    printf("%zu lines, %zu entries\n", lines, reference->count);
+    printf("createNumberDict            %8.1f ms\n", referenceTime * 1e3);
+
+    for (long threads = 1; threads <= 2 * (processors > 0 ? processors : 1); threads *= 2) {
+        HashTable *hashTable = createHashTable();
+
+        start = benchNow();
+        createNumberDictBulk(dictName, hashTable, (int)threads);
+
+        double bulkTime = benchNow() - start;
+        int identical = benchSameTables(reference, hashTable);
+
+        same &= identical;
+        printf("createNumberDictBulk %2ld thr %8.1f ms  %s\n", threads, bulkTime * 1e3,
+               identical ? "identical" : "DIFFERENT");
+        freeHashTable(hashTable);
+    }
+
+    printf("check: %s\n", sampleOk && same ? "ok" : "FAILED");
+
+    remove(dictName);
+    freeHashTable(reference);
+}
+
+/**
+ * @brief Основная функция программы.
+ * @details Параметры: "--stream" - потоковая обработка вместо processText,
+ * "--parallel [потоки]" - параллельная обработка, "--matcher [потоки]" - автомат Ахо-Корасик
+ * (по умолчанию в один поток), "--bench stream|parallel|matcher [МБ]",
+ * "--bench pool [слов]" и "--bench load [строк]" - бенчмарки.
+ * @return Код завершения.
+ */
+int main(int argc, char *argv[]) {
+    if (argc >= 3 && strcmp(argv[1], "--bench") == 0 && strcmp(argv[2], "stream") == 0) {
+        benchStream(argc - 3, argv + 3);
+        return 0;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "--bench") == 0 && strcmp(argv[2], "parallel") == 0) {
+        benchParallel(argc - 3, argv + 3);
+        return 0;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "--bench") == 0 && strcmp(argv[2], "matcher") == 0) {
+        benchMatcher(argc - 3, argv + 3);
+        return 0;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "--bench") == 0 && strcmp(argv[2], "pool") == 0) {
+        benchPool(argc - 3, argv + 3);
+        return 0;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "--bench") == 0 && strcmp(argv[2], "load") == 0) {
+        benchLoad(argc - 3, argv + 3);
+        return 0;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench") == 0) {
+        printf("Доступные бенчмарки: stream, parallel, matcher, pool, load\n");
+        return 1;
+    }
+
+    int stream = argc >= 2 && strcmp(argv[1], "--stream") == 0;
+    int parallel = argc >= 2 && strcmp(argv[1], "--parallel") == 0;
+    int automaton = argc >= 2 && strcmp(argv[1], "--matcher") == 0;
+    HashTable *hashTable = createHashTable();
+
+    createNumberDictBulk("numbers.txt", hashTable, 0);
+
+    if (automaton) {
+        NumberMatcher *matcher = createNumberMatcher(hashTable);
 
-    createNumberDict("numbers.txt", hashTable);
-    processText(hashTable, "input.txt", "output.txt");
+        if (matcher) processTextMatcher(matcher, "input.txt", "output.txt", argc >= 3 ? atoi(argv[2]) : 1);
+        freeNumberMatcher(matcher);
+    } else if (parallel) processTextParallel(hashTable, "input.txt", "output.txt", argc >= 3 ? atoi(argv[2]) : 0, 0);
+    else if (stream) processTextStream(hashTable, "input.txt", "output.txt");
+    else processText(hashTable, "input.txt", "output.txt");
 
     printf("Обработка завершена. Результат записан в output.txt.\n");
 